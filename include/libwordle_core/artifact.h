@@ -0,0 +1,159 @@
+#pragma once
+#include <cstdint>
+
+namespace wordle {
+
+// On-disk layout of solver_data.bin, shared by the builder's writer and the
+// runtime solver. Little-endian, packed for direct mmap.
+//
+// Version 1: 5-letter words only; header ends after root_index.
+// Version 2: adds word_length and num_patterns (children per node, 3^L).
+// Version 3: adds optional embedded word tables (kArtifactHasWords). When
+// present, three sections start at words_offset, each num_words * L bytes
+// with no separators: guess letters (ASCII), guesses packed (0-25) and
+// solutions packed (0-25). The solver then needs no text lists.
+//
+// Optional candidate ranges (kArtifactHasRanges, version 3 only): right
+// after the children, ArtifactRange[num_nodes] then uint32_t
+// order[num_solutions], the solution indices in the tree's depth-first leaf
+// order (a node's own solution, then its children by pattern). The solutions
+// still possible at node n are order[begin, end) of ranges[n].
+//
+// build_info (version 3, 0 if not recorded): the heuristic the tree was
+// built with plus one in the low byte, and for min_expected the low 24 bits
+// of its cost table's hash above it. Incremental rebuilds refuse a base whose
+// value differs from their own.
+constexpr uint32_t kArtifactMagic = 0x5752444C; // "WRDL"
+constexpr uint32_t kArtifactVersion = 3;
+
+constexpr uint32_t kArtifactHasWords = 0x1;
+constexpr uint32_t kArtifactHasRanges = 0x2;
+
+struct ArtifactHeaderV1 {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t checksum;
+  uint32_t num_nodes;
+  uint32_t root_index;
+};
+
+struct ArtifactHeaderV2 {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t checksum;
+  uint32_t num_nodes;
+  uint32_t root_index;
+  uint32_t word_length;
+  uint32_t num_patterns;
+};
+
+struct ArtifactHeader {
+  uint32_t magic = kArtifactMagic;
+  uint32_t version = kArtifactVersion;
+  uint64_t checksum = 0;
+  uint32_t num_nodes = 0;
+  uint32_t root_index = 0;
+  uint32_t word_length = 5;
+  uint32_t num_patterns = 243;
+  uint32_t flags = 0;
+  uint32_t num_guesses = 0;
+  uint32_t num_solutions = 0; // Set with either flag
+  uint32_t build_info = 0; // Heuristic and cost table, see above
+  uint64_t words_offset = 0; // 0 unless kArtifactHasWords
+};
+
+struct ArtifactNode {
+  uint16_t guess_index; // Index into guesses.txt
+  uint16_t flags;       // 0x1: IsLeaf, 0x2: IsSolution
+};
+
+struct ArtifactRange {
+  uint32_t begin; // Into the order array
+  uint32_t end;
+};
+
+// Marks an impossible pattern in the children array.
+constexpr uint32_t kNoChild = 0xFFFFFFFF;
+
+// Tree bundle: several single-board trees for the same lists (different
+// openers and heuristics) sharing one node pool. Identical subtrees, above
+// all the leaves, are stored once however many trees reach them.
+//
+// Layout: BundleHeader, BundleTree[num_trees], ArtifactNode[num_nodes],
+// uint32_t children[num_nodes * num_patterns], then the optional word
+// tables exactly as in a version 3 artifact. Each tree is its root index
+// into the pool; lookups are the same as in a single artifact.
+constexpr uint32_t kBundleMagic = 0x42445257; // "WRDB"
+constexpr uint32_t kBundleVersion = 1;
+
+struct BundleHeader {
+  uint32_t magic = kBundleMagic;
+  uint32_t version = kBundleVersion;
+  uint64_t checksum = 0; // Word lists shared by every tree
+  uint32_t num_trees = 0;
+  uint32_t num_nodes = 0; // Shared pool
+  uint32_t word_length = 5;
+  uint32_t num_patterns = 243;
+  uint32_t flags = 0; // kArtifactHasWords
+  uint32_t num_guesses = 0;
+  uint32_t num_solutions = 0;
+  uint32_t reserved = 0;
+  uint64_t words_offset = 0; // 0 unless kArtifactHasWords
+};
+
+// Table of contents entry. Strings are NUL-padded.
+struct BundleTree {
+  char name[32];      // "<opener>/<heuristic>", how solvers select it
+  char opener[16];    // Root guess
+  char heuristic[16]; // Any builder heuristic name, e.g. "expected_size"
+  uint32_t root_index = 0;
+  uint32_t reserved = 0;
+  uint64_t checksum = 0; // Word lists this tree was built from
+};
+
+// Multi-board artifact (Dordle, Quordle, ...): one guess is played on every
+// board and the feedback is a tuple of patterns.
+//
+// Layout: MultiArtifactHeader, ArtifactNode[num_nodes], then an open-addressed
+// hash table of MultiArtifactEdge[edge_capacity] keyed on (parent, feedback).
+//
+// Boards are kept in a canonical order (sorted candidate sets) so that
+// permuted board states share one subtree. An edge's feedback is encoded in
+// the parent's canonical order, and `perm` maps each parent position to its
+// position in the child (2 bits per board). Runtimes track the canonical
+// position of every real board while walking the tree.
+constexpr uint32_t kMultiArtifactMagic = 0x4D445257; // "WRDM"
+constexpr uint32_t kMultiArtifactVersion = 1;
+constexpr int kMaxBoards = 4;
+
+struct MultiArtifactHeader {
+  uint32_t magic = kMultiArtifactMagic;
+  uint32_t version = kMultiArtifactVersion;
+  uint64_t checksum = 0;
+  uint32_t num_nodes = 0;
+  uint32_t root_index = 0;
+  uint32_t word_length = 5;
+  uint32_t num_patterns = 243;
+  uint32_t num_boards = 2;
+  uint32_t max_guesses = 7;
+  uint32_t num_edges = 0;
+  uint32_t edge_capacity = 0; // Power of two
+};
+
+struct MultiArtifactEdge {
+  uint64_t feedback; // Sum of pattern[i] * num_patterns^i, canonical order
+  uint32_t parent;   // kNoChild marks an empty slot
+  uint32_t child;
+  uint8_t perm; // Child position of parent position i: (perm >> 2i) & 3
+  uint8_t reserved[7];
+};
+
+// Home slot of an edge; collisions probe linearly.
+inline uint64_t multi_edge_slot(uint32_t parent, uint64_t feedback,
+                                uint64_t capacity) {
+  uint64_t h = (feedback ^ (static_cast<uint64_t>(parent) << 32)) *
+               0x9E3779B97F4A7C15ULL;
+  return (h ^ (h >> 29)) & (capacity - 1);
+}
+
+} // namespace wordle
@@ -0,0 +1,58 @@
+#pragma once
+#include "libwordle_core/pattern.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace wordle {
+
+// Bit-sliced letter index over a solution list: one bitset per
+// (position, letter) and one per (letter, minimum count). The solutions
+// consistent with a (guess, pattern) pair are then a few ANDs over bitset
+// words, with no pattern table at all: memory is 52 * L bits per solution
+// rather than one pattern per (guess, solution).
+//
+// Bitsets use the SolverState layout (bit s % 64 of word s / 64), so they
+// can be applied to a state's words directly.
+template <int L> class BasicLetterIndex {
+public:
+  using Pattern = typename WordTraits<L>::Pattern;
+
+  void build(const BasicPackedWord<L> *solutions, size_t num_solutions);
+
+  size_t num_solutions() const { return num_solutions_; }
+  // uint64_t words per bitset
+  size_t num_words() const { return num_words_; }
+
+  // ANDs into `bits` (num_words() words) the solutions for which `guess`
+  // scores `pattern`. Exact for every pattern calc_pattern can produce;
+  // patterns it cannot (a duplicate letter marked yellow after a black copy)
+  // match the canonical ordering.
+  void filter(const BasicPackedWord<L> &guess, Pattern pattern,
+              uint64_t *bits) const;
+
+private:
+  // Offsets of the bitset for `letter` at position i, and for solutions
+  // with at least `count` (1..L) copies of `letter`.
+  size_t position(int i, int letter) const {
+    return (static_cast<size_t>(i) * 26 + letter) * num_words_;
+  }
+  size_t at_least(int letter, int count) const {
+    return (static_cast<size_t>(26 * L) + letter * L + count - 1) *
+           num_words_;
+  }
+
+  std::vector<uint64_t> bits_;
+  size_t num_solutions_ = 0;
+  size_t num_words_ = 0;
+};
+
+using LetterIndex = BasicLetterIndex<5>;
+
+extern template class BasicLetterIndex<4>;
+extern template class BasicLetterIndex<5>;
+extern template class BasicLetterIndex<6>;
+extern template class BasicLetterIndex<7>;
+extern template class BasicLetterIndex<8>;
+
+} // namespace wordle
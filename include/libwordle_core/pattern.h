@@ -2,21 +2,90 @@
 #include <cstdint>
 #include <string>
 #include <string_view>
+#include <type_traits>
 
 namespace wordle {
 
-// Computes the pattern (0-242) for a guess against a secret solution.
+constexpr int pow3(int n) { return n == 0 ? 1 : 3 * pow3(n - 1); }
+
+// Compile-time properties of a word length L. Supported: 4 to 8 letters.
+// The pattern ID type is the narrowest that holds 3^L values, so the classic
+// 5-letter game keeps one-byte patterns.
+template <int L> struct WordTraits {
+  static_assert(L >= 4 && L <= 8, "word length must be 4-8 letters");
+  static constexpr int kLength = L;
+  static constexpr int kNumPatterns = pow3(L);
+  static constexpr int kSolvedPattern = kNumPatterns - 1; // All green
+  using Pattern =
+      std::conditional_t<(kNumPatterns <= 256), uint8_t, uint16_t>;
+};
+
+// Runtime view of the same values, for code that only learns L from a file.
+constexpr int num_patterns(int length) { return pow3(length); }
+constexpr int solved_pattern(int length) { return pow3(length) - 1; }
+
+// Computes the pattern (0 to 3^L - 1) for a guess against a secret solution
+// of the same length L (up to 8).
 // Encoding: 0=Black, 1=Yellow, 2=Green.
-// Result = sum(color[i] * 3^i) for i in [0..4]
-uint8_t calc_pattern(std::string_view guess, std::string_view secret);
+// Result = sum(color[i] * 3^i) for i in [0..L-1]
+uint16_t calc_pattern(std::string_view guess, std::string_view secret);
 
-struct PackedWord {
-  uint8_t chars[5];
+template <int L> struct BasicPackedWord {
+  uint8_t chars[L];
 };
 
-PackedWord pack_word(std::string_view s);
+using PackedWord = BasicPackedWord<5>;
+
+template <int L = 5> BasicPackedWord<L> pack_word(std::string_view s) {
+  BasicPackedWord<L> p;
+  for (int i = 0; i < L; ++i)
+    p.chars[i] = s[i] - 'a';
+  return p;
+}
 
 // Optimized calculation using pre-packed words (0-25 integers)
-uint8_t calc_pattern(const PackedWord &guess, const PackedWord &secret);
+template <int L>
+typename WordTraits<L>::Pattern calc_pattern(const BasicPackedWord<L> &guess,
+                                             const BasicPackedWord<L> &secret) {
+  uint8_t secret_counts[26] = {0};
+  uint8_t guess_colors[L] = {0}; // 0=Black, 1=Yellow, 2=Green
+  bool secret_matched[L] = {false};
+
+  // 1. Green pass
+  for (int i = 0; i < L; ++i) {
+    if (guess.chars[i] == secret.chars[i]) {
+      guess_colors[i] = 2;
+      secret_matched[i] = true;
+    }
+  }
+
+  // Build histogram for secret (only for non-matched positions)
+  for (int i = 0; i < L; ++i) {
+    if (!secret_matched[i]) {
+      secret_counts[secret.chars[i]]++;
+    }
+  }
+
+  // 2. Yellow pass
+  for (int i = 0; i < L; ++i) {
+    if (guess_colors[i] == 2)
+      continue;
+
+    uint8_t c = guess.chars[i];
+    if (secret_counts[c] > 0) {
+      guess_colors[i] = 1;
+      secret_counts[c]--;
+    }
+  }
+
+  // Encode base-3
+  typename WordTraits<L>::Pattern result = 0;
+  int multiplier = 1;
+  for (int i = 0; i < L; ++i) {
+    result += guess_colors[i] * multiplier;
+    multiplier *= 3;
+  }
+  return result;
+}
 
 } // namespace wordle
@@ -1,32 +1,58 @@
 #pragma once
+#include "libwordle_core/pattern.h"
+#include "libwordle_core/wordlist.h"
 #include <cstdint>
 #include <string>
 #include <vector>
 
 namespace wordle {
 
-class PatternTable {
+// Pattern matrix P[guess][solution] for words of length L. Entries use the
+// narrowest pattern type for L (one byte for 4 and 5 letters).
+template <int L> class BasicPatternTable {
 public:
-  PatternTable() = default;
+  using Traits = WordTraits<L>;
+  using Pattern = typename Traits::Pattern;
 
-  // Computes the full matrix P[guess][solution].
-  // This can take a few seconds for full lists.
-  void generate(const std::vector<std::string> &guesses,
-                const std::vector<std::string> &solutions);
+  BasicPatternTable() = default;
 
-  uint8_t get_pattern(size_t guess_idx, size_t sol_idx) const {
+  // Computes the full matrix P[guess][solution] straight from the packed
+  // word arrays. This can take a few seconds for full lists.
+  void generate(const BasicPackedWord<L> *guesses, size_t num_guesses,
+                const BasicPackedWord<L> *solutions, size_t num_solutions);
+
+  // Same, for a word list loaded with word_length() == L.
+  void generate(const WordList &words) {
+    generate(words.guesses_as<L>(), words.get_guesses().size(),
+             words.solutions_as<L>(), words.get_solutions().size());
+  }
+
+  // Copies the rows `guesses` and columns `solutions` of `full` into this
+  // table, so that P[i][j] here is full.P[guesses[i]][solutions[j]].
+  void extract(const BasicPatternTable &full, const std::vector<int> &guesses,
+               const std::vector<int> &solutions);
+
+  Pattern get_pattern(size_t guess_idx, size_t sol_idx) const {
     return table_[guess_idx * num_solutions_ + sol_idx];
   }
 
   size_t num_guesses() const { return num_guesses_; }
   size_t num_solutions() const { return num_solutions_; }
 
-  const std::vector<uint8_t> &get_raw_table() const { return table_; }
+  const std::vector<Pattern> &get_raw_table() const { return table_; }
 
 private:
-  std::vector<uint8_t> table_;
+  std::vector<Pattern> table_;
   size_t num_guesses_ = 0;
   size_t num_solutions_ = 0;
 };
 
+using PatternTable = BasicPatternTable<5>;
+
+extern template class BasicPatternTable<4>;
+extern template class BasicPatternTable<5>;
+extern template class BasicPatternTable<6>;
+extern template class BasicPatternTable<7>;
+extern template class BasicPatternTable<8>;
+
 } // namespace wordle
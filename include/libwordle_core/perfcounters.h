@@ -0,0 +1,116 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace wordle {
+
+// Events read by PerfCounters, in report order.
+enum class PerfEvent {
+  Cycles,
+  Instructions,
+  L1dMisses,   // L1 data cache read misses
+  LlcMisses,   // Last-level cache read misses
+  DtlbMisses,  // Data TLB read misses
+  BranchMisses,
+  TaskClock,   // CPU time in ns (software event)
+  PageFaults,  // Software event
+  Count
+};
+constexpr int kNumPerfEvents = static_cast<int>(PerfEvent::Count);
+
+// Name used in reports, e.g. "llc_misses".
+const char *perf_event_name(PerfEvent event);
+
+struct PerfReading {
+  uint64_t values[kNumPerfEvents] = {};
+};
+
+// Process-wide counters through Linux perf_event_open, user space only.
+// Opened with inherit, so threads started after construction are counted
+// too: construct it before any worker threads or thread pools start.
+// Events the kernel, VM or perf_event_paranoid setting do not allow are
+// reported as unavailable rather than failing; on other platforms every
+// event is unavailable.
+class PerfCounters {
+public:
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  bool available(PerfEvent event) const {
+    return fds_[static_cast<int>(event)] >= 0;
+  }
+  bool any_available() const;
+
+  // Why the first unavailable event could not be opened, or empty.
+  const std::string &error() const { return error_; }
+
+  // Current totals, scaled up when the kernel multiplexed an event.
+  // Unavailable events read 0.
+  PerfReading read() const;
+
+private:
+  int fds_[kNumPerfEvents];
+  std::string error_;
+};
+
+// Splits counter deltas and wall time into named phases. Time is always
+// charged to exactly one phase: enter() charges everything since the last
+// transition to the current phase and makes `phase` current, so a nested
+// phase is excluded from its parent. Single-threaded use only; threads the
+// caller waits on are counted in the caller's phase.
+class PerfPhases {
+public:
+  explicit PerfPhases(const PerfCounters &counters);
+
+  // Registers a phase (or returns the existing id for `name`).
+  int phase(const std::string &name);
+
+  // Switches to `phase` and returns the previous one (-1 before the first).
+  int enter(int phase);
+
+  // Charges the running phase and stops charging anything.
+  void stop() { enter(-1); }
+
+  // Writes {"available", "error", "events", "phases": [...]} with one
+  // object per phase: seconds, every event (null when unavailable) and ipc.
+  bool write_json(const std::string &path) const;
+
+private:
+  struct Phase {
+    std::string name;
+    double seconds = 0.0;
+    PerfReading totals;
+  };
+
+  const PerfCounters &counters_;
+  std::vector<Phase> phases_;
+  int current_ = -1;
+  PerfReading last_;
+  std::chrono::steady_clock::time_point last_time_;
+};
+
+// Runs its scope in `phase` and then returns to the previous one. A null
+// `phases` makes it a no-op, so call sites cost a branch when disabled.
+class PerfScope {
+public:
+  PerfScope(PerfPhases *phases, int phase)
+      : phases_(phases), previous_(phases ? phases->enter(phase) : -1) {}
+  ~PerfScope() {
+    if (phases_)
+      phases_->enter(previous_);
+  }
+
+  PerfScope(const PerfScope &) = delete;
+  PerfScope &operator=(const PerfScope &) = delete;
+
+private:
+  PerfPhases *phases_;
+  int previous_;
+};
+
+} // namespace wordle
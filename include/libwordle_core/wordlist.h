@@ -1,7 +1,9 @@
 #pragma once
 
+#include "libwordle_core/pattern.h"
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace wordle {
@@ -9,23 +11,70 @@ namespace wordle {
 class WordList {
 public:
   WordList() = default;
+  ~WordList();
+
+  // Views point into the mapped files, so a WordList is move-only.
+  WordList(const WordList &) = delete;
+  WordList &operator=(const WordList &) = delete;
+  WordList(WordList &&other) noexcept;
+  WordList &operator=(WordList &&other) noexcept;
 
   // Load solutions and guesses from files.
   // guesses_path should contain ALL valid guesses (including solutions).
   // If guesses_path is not provided or empty, it might default to solutions
   // (though usually distinct).
-  bool load(const std::string &solutions_path, const std::string &guesses_path);
+  // Lines that are not exactly `word_length` letters are skipped.
+  //
+  // Each file is mapped and parsed in a single pass that validates, packs
+  // and collects a view of every word. Sorting is skipped for files that are
+  // already sorted (the shipped lists are).
+  bool load(const std::string &solutions_path, const std::string &guesses_path,
+            size_t word_length = 5);
+
+  size_t word_length() const { return word_length_; }
+
+  // Sorted, deduplicated words; views into the mapped files, for display and
+  // lookups.
+  const std::vector<std::string_view> &get_solutions() const {
+    return solutions_;
+  }
+  const std::vector<std::string_view> &get_guesses() const { return guesses_; }
 
-  const std::vector<std::string> &get_solutions() const { return solutions_; }
-  const std::vector<std::string> &get_guesses() const { return guesses_; }
+  // The same words packed contiguously, word_length() letters (0-25) each.
+  const std::vector<uint8_t> &packed_solutions() const {
+    return packed_solutions_;
+  }
+  const std::vector<uint8_t> &packed_guesses() const { return packed_guesses_; }
+
+  // Typed views of the packed arrays; L must equal word_length().
+  template <int L> const BasicPackedWord<L> *solutions_as() const {
+    static_assert(sizeof(BasicPackedWord<L>) == L, "packed words are L bytes");
+    return reinterpret_cast<const BasicPackedWord<L> *>(
+        packed_solutions_.data());
+  }
+  template <int L> const BasicPackedWord<L> *guesses_as() const {
+    static_assert(sizeof(BasicPackedWord<L>) == L, "packed words are L bytes");
+    return reinterpret_cast<const BasicPackedWord<L> *>(packed_guesses_.data());
+  }
 
   // Returns a 64-bit checksum of the sorted word lists.
   uint64_t get_checksum() const { return checksum_; }
 
 private:
-  std::vector<std::string> solutions_;
-  std::vector<std::string> guesses_;
+  struct Mapping {
+    const char *data = nullptr;
+    size_t size = 0;
+  };
+
+  void unmap();
+
+  std::vector<Mapping> mappings_;
+  std::vector<std::string_view> solutions_;
+  std::vector<std::string_view> guesses_;
+  std::vector<uint8_t> packed_solutions_;
+  std::vector<uint8_t> packed_guesses_;
   uint64_t checksum_ = 0;
+  size_t word_length_ = 5;
 };
 
 } // namespace wordle
@@ -1,8 +1,11 @@
 #!/usr/bin/env python3
-import subprocess
-import re
+# Thin wrapper around `wordle_builder --sweep-openers`, which evaluates all
+# openers in one process (shared pattern table and memo, concurrent builds).
+import csv
 import os
+import subprocess
 import sys
+import tempfile
 
 # Default list if no file provided
 WORDS_TO_TEST = [
@@ -12,60 +15,42 @@ WORDS_TO_TEST = [
 BUILDER_BIN = "./build/bin/wordle_builder"
 SOLUTIONS = "data/solutions.txt"
 GUESSES = "data/guesses.txt"
-OUTPUT_BIN = "solver_data.bin"
 
-if len(sys.argv) > 1:
-    input_file = sys.argv[1]
-    print(f"Reading words from {input_file}...")
-    WORDS_TO_TEST = []
-    with open(input_file, 'r') as f:
-        for line in f:
-            # Skip header lines from rank_openers output if present
-            if "Openers" in line or "---" in line or "Generating" in line or "Ranking" in line:
-                continue
-            parts = line.strip().split()
-            if parts and parts[0].isalpha():
-                WORDS_TO_TEST.append(parts[0])
 
-results = []
+def sweep(tmpdir):
+    results_csv = os.path.join(tmpdir, "sweep.csv")
 
-print(f"Testing {len(WORDS_TO_TEST)} starting words...")
+    if len(sys.argv) > 1:
+        # A rank_openers output file, a plain word list, or "top-N".
+        spec = sys.argv[1]
+        print(f"Reading openers from {spec}...")
+    else:
+        spec = os.path.join(tmpdir, "openers.txt")
+        with open(spec, "w") as f:
+            f.write("\n".join(WORDS_TO_TEST) + "\n")
 
-for word in WORDS_TO_TEST:
-    print(f"Testing '{word}'...", end="", flush=True)
-    
     cmd = [
         BUILDER_BIN,
         "--solutions", SOLUTIONS,
         "--guesses", GUESSES,
-        "--output", OUTPUT_BIN,
-        "--start-word", word
+        "--sweep-openers", spec,
+        "--sweep-output", results_csv,
     ]
-    
-    try:
-        # Run builder and capture output
-        proc = subprocess.run(cmd, capture_output=True, text=True)
-        
-        if proc.returncode != 0:
-            print(" Failed.")
-            # print(proc.stderr)
-            continue
-            
-        # Parse "Average Guesses: 3.xyz"
-        match = re.search(r"Average Guesses: (\d+\.\d+)", proc.stdout)
-        if match:
-            avg = float(match.group(1))
-            results.append((word, avg))
-            print(f" Average: {avg}")
-        else:
-            print(" Could not parse average.")
-            
-    except Exception as e:
-        print(f" Error: {e}")
 
-print("\n--- Results ---")
-results.sort(key=lambda x: x[1])
+    proc = subprocess.run(cmd)
+    if proc.returncode != 0:
+        sys.exit(proc.returncode)
+
+    with open(results_csv) as f:
+        return [(r["opener"], float(r["average_guesses"]))
+                for r in csv.DictReader(f) if r["success"] == "1"]
 
+
+# The directory and the CSV in it are removed however the sweep ends.
+with tempfile.TemporaryDirectory() as tmpdir:
+    results = sweep(tmpdir)
+
+print("\n--- Results ---")
 for word, avg in results:
     print(f"{word}: {avg}")
 
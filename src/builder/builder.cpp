@@ -1,33 +1,52 @@
 #include "builder.h"
 #include "entropy.h"
+#include "memo_store.h"
 #include "threadpool.h"
 #include <algorithm>
 #include <cmath>
 #include <future>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace wordle {
 
-static uint32_t compute_mask(const std::string &w) {
+template <int L> static uint32_t compute_mask(const BasicPackedWord<L> &w) {
   uint32_t mask = 0;
-  for (char c : w) {
-    mask |= (1 << (c - 'a'));
-  }
+  for (int i = 0; i < L; ++i)
+    mask |= (1u << w.chars[i]);
   return mask;
 }
 
-Builder::Builder(const WordList &words, const PatternTable &table,
-                 const std::string &start_word, HeuristicType heuristic)
+std::shared_ptr<MemoryNode> MemoryNode::child(uint16_t pattern) const {
+  auto it = std::lower_bound(
+      children.begin(), children.end(), pattern,
+      [](const auto &entry, uint16_t p) { return entry.first < p; });
+  if (it != children.end() && it->first == pattern)
+    return it->second;
+  return nullptr;
+}
+
+template <int L>
+BasicBuilder<L>::BasicBuilder(const WordList &words, const Table &table,
+                              const std::string &start_word,
+                              HeuristicType heuristic,
+                              std::shared_ptr<Memo> memo)
     : words_(words), table_(table), start_word_(start_word),
-      heuristic_(heuristic) {
+      heuristic_(heuristic), cache_(std::move(memo)) {
+  if (!cache_)
+    cache_ = std::make_shared<Memo>();
 
   // Precompute solution -> guess mapping
   solution_to_guess_.resize(words_.get_solutions().size());
   const auto &guesses = words_.get_guesses();
   for (size_t i = 0; i < words_.get_solutions().size(); ++i) {
-    const std::string &sol = words_.get_solutions()[i];
+    std::string_view sol = words_.get_solutions()[i];
     auto it = std::lower_bound(guesses.begin(), guesses.end(), sol);
     if (it != guesses.end() && *it == sol) {
       solution_to_guess_[i] = std::distance(guesses.begin(), it);
@@ -40,17 +59,14 @@ Builder::Builder(const WordList &words, const PatternTable &table,
   // Precompute masks
   guess_masks_.resize(guesses.size());
   for (size_t i = 0; i < guesses.size(); ++i)
-    guess_masks_[i] = compute_mask(guesses[i]);
+    guess_masks_[i] = compute_mask(words_.guesses_as<L>()[i]);
 
   solution_masks_.resize(words_.get_solutions().size());
   for (size_t i = 0; i < words_.get_solutions().size(); ++i)
-    solution_masks_[i] = compute_mask(words_.get_solutions()[i]);
-
-  // Reserve capacity for memoization cache
-  cache_.reserve(words_.get_solutions().size() * 3);
+    solution_masks_[i] = compute_mask(words_.solutions_as<L>()[i]);
 }
 
-std::shared_ptr<MemoryNode> Builder::build() {
+template <int L> std::shared_ptr<MemoryNode> BasicBuilder<L>::build() {
   SolverState all_solutions(words_.get_solutions().size());
   for (size_t i = 0; i < words_.get_solutions().size(); ++i) {
     all_solutions.set(i);
@@ -65,16 +81,134 @@ struct ScoredGuess {
   int max_bucket;
 };
 
-std::shared_ptr<MemoryNode> Builder::solve(const SolverState &candidates,
-                                           int depth) {
+namespace {
+
+// Total order used for the beam: best score first (higher or lower per the
+// heuristic), ties broken by guess index so that any beam width selects a
+// prefix of the same ranking.
+template <HeuristicType H> struct BeamOrder {
+  bool operator()(const ScoredGuess &a, const ScoredGuess &b) const {
+    if (a.score != b.score)
+      return Heuristic<H>::kMaximize ? a.score > b.score : a.score < b.score;
+    return a.index < b.index;
+  }
+};
+
+// Running top-K selection. The heap keeps the current K-th best on top so it
+// doubles as the pruning threshold for the scoring kernel.
+template <HeuristicType H> class TopK {
+public:
+  explicit TopK(size_t k) : k_(k) {}
+
+  bool full() const { return heap_.size() >= k_; }
+  double threshold() const { return heap_.front().score; }
+
+  void offer(const ScoredGuess &g) {
+    if (!full()) {
+      heap_.push_back(g);
+      std::push_heap(heap_.begin(), heap_.end(), order_);
+    } else if (order_(g, heap_.front())) {
+      std::pop_heap(heap_.begin(), heap_.end(), order_);
+      heap_.back() = g;
+      std::push_heap(heap_.begin(), heap_.end(), order_);
+    }
+  }
+
+  std::vector<ScoredGuess> take() { return std::move(heap_); }
+
+private:
+  size_t k_;
+  BeamOrder<H> order_;
+  std::vector<ScoredGuess> heap_;
+};
+
+// Scores guesses[0, count) with the batched kernel for heuristic H and
+// returns the best K of them (unordered). While the local top-K is full its
+// K-th score is handed to the kernel as a bound, so hopeless guesses are
+// abandoned mid-scan. A chunk-local K-th best never exceeds the global one,
+// so this never drops a guess that belongs in the global beam.
+template <int L, HeuristicType H>
+std::vector<ScoredGuess> score_top_k(const std::vector<int> &active,
+                                     const int *guesses, size_t count,
+                                     const BasicPatternTable<L> &table,
+                                     const ScoreBound &rules, size_t K) {
+  constexpr bool kMaximize = Heuristic<H>::kMaximize;
+  TopK<H> top(K);
+  PolicyScore scores[kGuessBlock];
+  for (size_t b = 0; b < count; b += kGuessBlock) {
+    size_t width = std::min(kGuessBlock, count - b);
+    ScoreBound bound = rules;
+    bound.threshold = top.full()  ? top.threshold()
+                      : kMaximize ? -std::numeric_limits<double>::infinity()
+                                  : std::numeric_limits<double>::infinity();
+    score_policy<L, H>(active, guesses + b, width, table, scores, &bound);
+
+    for (size_t j = 0; j < width; ++j) {
+      const PolicyScore &h = scores[j];
+      if (h.pruned)
+        continue;
+      if (rules.reject_above > 0 && h.max_bucket > rules.reject_above)
+        continue;
+
+      double penalty =
+          (rules.penalize_above > 0 && h.max_bucket > rules.penalize_above)
+              ? rules.penalty
+              : 0.0;
+      double score = kMaximize ? h.score - penalty : h.score + penalty;
+      top.offer({guesses[b + j], score, h.max_bucket});
+    }
+  }
+  return top.take();
+}
+
+// Remaining-depth rules: at R=2 every candidate must be separated, at R=3
+// guesses leaving a bucket larger than 5 are heavily penalised.
+template <int L, HeuristicType H> ScoreBound depth_rules(int R) {
+  ScoreBound rules;
+  rules.reject_above = (R == 2) ? 1 : 0;
+  rules.penalize_above = (R == 3) ? 5 : 0;
+  rules.penalty = Heuristic<H>::kPenalty;
+  // A partition into 3^L patterns scores at most log2(3^L) bits.
+  if constexpr (H == HeuristicType::ENTROPY)
+    rules.penalty = std::max(rules.penalty, L * std::log2(3.0) + 1.0);
+  return rules;
+}
+
+// The K best guesses, best first: the one place solve() and solve_small()
+// switch on the heuristic, once per beam.
+template <int L, class Score>
+std::vector<ScoredGuess> best_k(HeuristicType heuristic, int R, size_t K,
+                                Score &&score) {
+  return dispatch_heuristic(heuristic, [&](auto h) {
+    constexpr HeuristicType H = decltype(h)::value;
+    std::vector<ScoredGuess> beam = score(h, depth_rules<L, H>(R));
+    size_t limit = std::min(beam.size(), K);
+    std::partial_sort(beam.begin(), beam.begin() + limit, beam.end(),
+                      BeamOrder<H>{});
+    beam.resize(limit);
+    return beam;
+  });
+}
+
+} // namespace
+
+template <int L>
+std::shared_ptr<MemoryNode>
+BasicBuilder<L>::solve(const SolverState &candidates, int depth) {
   if (candidates.count() == 0)
     return nullptr;
 
-  auto it = cache_.find(candidates);
-  if (it != cache_.end())
-    return it->second;
+  int R = kMaxGuesses - depth;
 
-  int R = 6 - depth;
+  MemoKey key{candidates, R};
+  if (auto cached = cache_->find(key))
+    return cached;
+  if (store_ && depth > 0) {
+    if (auto stored = store_->find(key)) {
+      cache_->insert(key, stored);
+      return stored;
+    }
+  }
 
   // Base Case: 1 candidate
   if (candidates.count() == 1) {
@@ -86,7 +220,7 @@ std::shared_ptr<MemoryNode> Builder::solve(const SolverState &candidates,
   }
 
   // Failure
-  if (depth >= 6)
+  if (depth >= kMaxGuesses)
     return nullptr;
 
   // Filter relevant guesses
@@ -114,162 +248,135 @@ std::shared_ptr<MemoryNode> Builder::solve(const SolverState &candidates,
     }
   }
 
-  std::vector<ScoredGuess> scored_guesses;
-  scored_guesses.reserve(candidate_guesses.size());
-
-  // Force start_word at depth 0
-  if (depth == 0) {
-    if (!start_word_.empty()) {
-      auto it = std::lower_bound(words_.get_guesses().begin(),
-                                 words_.get_guesses().end(), start_word_);
-      if (it != words_.get_guesses().end() && *it == start_word_) {
-        int idx = std::distance(words_.get_guesses().begin(), it);
-        double fake_score =
-            (heuristic_ == HeuristicType::ENTROPY) ? 100.0 : -100.0;
-        scored_guesses.push_back({idx, fake_score, 1});
-      } else {
-        std::cerr << "Warning: Start word '" << start_word_
-                  << "' not found in guesses." << std::endl;
+  // Small subproblem: everything below here fits a local sub-table.
+  if (small_states_ && depth > 0 && active_solution_indices.size() <= 64) {
+    SmallContext ctx;
+    ctx.solutions = active_solution_indices;
+    const size_t n = ctx.solutions.size();
+    Table local;
+    local.extract(table_, candidate_guesses, ctx.solutions);
+
+    // Guesses with equal rows here stay equal on every descendant and pass
+    // the letter filter together, so only the first (lowest index, which
+    // wins every tie) can ever be picked. Keep one row per distinct column.
+    std::vector<int> kept;
+    std::unordered_set<std::string_view> distinct;
+    distinct.reserve(candidate_guesses.size());
+    const auto *raw =
+        reinterpret_cast<const char *>(local.get_raw_table().data());
+    const size_t bytes = n * sizeof(Pattern);
+    for (size_t r = 0; r < candidate_guesses.size(); ++r) {
+      if (distinct.insert(std::string_view(raw + r * bytes, bytes)).second) {
+        kept.push_back(static_cast<int>(r));
+        ctx.guesses.push_back(candidate_guesses[r]);
+        ctx.masks.push_back(guess_masks_[candidate_guesses[r]]);
       }
     }
-  } else {
+    std::vector<int> columns(n);
+    std::iota(columns.begin(), columns.end(), 0);
+    ctx.table.extract(local, kept, columns);
+    ctx.solution_rows.reserve(ctx.solutions.size());
+    for (int s : ctx.solutions) {
+      auto it = std::lower_bound(ctx.guesses.begin(), ctx.guesses.end(),
+                                 solution_to_guess_[s]);
+      ctx.solution_rows.push_back(
+          it != ctx.guesses.end() && *it == solution_to_guess_[s]
+              ? static_cast<int>(it - ctx.guesses.begin())
+              : -1);
+    }
+    uint64_t all = active_solution_indices.size() == 64
+                       ? ~0ULL
+                       : (1ULL << active_solution_indices.size()) - 1;
+    auto node = solve_small(ctx, all, depth, false);
+    if (node)
+      cache_->insert(key, node);
+    return node;
+  }
 
-    unsigned int num_threads = std::thread::hardware_concurrency();
-    if (num_threads == 0)
-      num_threads = 4;
+  unsigned int num_threads = std::thread::hardware_concurrency();
+  if (num_threads == 0)
+    num_threads = 4;
+
+  // Returns the best K guesses for this state, best first.
+  auto select_beam = [&](size_t K) {
+    PerfScope scope(perf_, perf_scoring_);
+    return best_k<L>(heuristic_, R, K, [&](auto h, const ScoreBound &rules) {
+      constexpr HeuristicType H = decltype(h)::value;
+      auto score_range = [&](size_t start, size_t end) {
+        return score_top_k<L, H>(active_solution_indices,
+                                 candidate_guesses.data() + start,
+                                 end - start, table_, rules, K);
+      };
+      if (!parallel_scoring_ || candidate_guesses.size() < 100)
+        return score_range(0, candidate_guesses.size());
 
-    if (candidate_guesses.size() < 100) {
-      for (int g : candidate_guesses) {
-        auto h = compute_heuristic(candidates, g, table_, heuristic_);
-        if (R == 2 && h.max_bucket > 1)
-          continue;
-        double penalty = 0.0;
-        // Penalties are usually for entropy maximization.
-        // For min expected, we might add penalty (cost)
-        if (heuristic_ == HeuristicType::ENTROPY) {
-          if (R == 3 && h.max_bucket > 5)
-            penalty = 10.0;
-          scored_guesses.push_back({g, h.score - penalty, h.max_bucket});
-        } else {
-          if (R == 3 && h.max_bucket > 5)
-            penalty = 10.0;
-          scored_guesses.push_back({g, h.score + penalty, h.max_bucket});
-        }
-      }
-    } else {
       std::vector<std::future<std::vector<ScoredGuess>>> futures;
-      size_t chunk_size = candidate_guesses.size() / num_threads;
+      // Keep chunk boundaries on guess-block multiples so every chunk runs
+      // full blocks through the kernel. Rounding up (never below one block)
+      // may leave the last threads without work.
+      const size_t total = candidate_guesses.size();
+      size_t chunk_size = (total + num_threads - 1) / num_threads;
+      chunk_size = (chunk_size + kGuessBlock - 1) / kGuessBlock * kGuessBlock;
 
-      for (unsigned int t = 0; t < num_threads; ++t) {
-        size_t start = t * chunk_size;
-        size_t end = (t == num_threads - 1) ? candidate_guesses.size()
-                                            : start + chunk_size;
+      for (size_t start = 0; start < total; start += chunk_size) {
+        size_t end = std::min(total, start + chunk_size);
 
         futures.push_back(get_thread_pool().enqueue(
-            [start, end, &candidate_guesses, &candidates, this, R]() {
-              std::vector<ScoredGuess> local_results;
-              local_results.reserve(end - start);
-              for (size_t i = start; i < end; ++i) {
-                int g = candidate_guesses[i];
-                auto h = compute_heuristic(candidates, g, table_, heuristic_);
-                if (R == 2 && h.max_bucket > 1)
-                  continue;
-
-                double penalty = 0.0;
-                if (heuristic_ == HeuristicType::ENTROPY) {
-                  if (R == 3 && h.max_bucket > 5)
-                    penalty = 10.0;
-                  local_results.push_back({g, h.score - penalty, h.max_bucket});
-                } else {
-                  if (R == 3 && h.max_bucket > 5)
-                    penalty = 10.0;
-                  local_results.push_back({g, h.score + penalty, h.max_bucket});
-                }
-              }
-              return local_results;
-            }));
+            [start, end, &score_range]() { return score_range(start, end); }));
       }
 
+      std::vector<ScoredGuess> beam;
       for (auto &f : futures) {
         auto res = f.get();
-        scored_guesses.insert(scored_guesses.end(), res.begin(), res.end());
+        beam.insert(beam.end(), res.begin(), res.end());
       }
-    }
+      return beam;
+    });
+  };
 
-    // Sort: Entropy -> Descending, MinExpected -> Ascending
-    // Optimization: Use partial_sort to only sort top K candidates if we have
-    // more than K
-    int max_k = 5; // Default for first pass
-    // Actually, the loop below iterates K_values.
-    // We want to sort enough for the largest K we might use?
-    // K_values are {5, 50, 100000}.
-    // If we fail K=5, we need top 50.
-    // If we fail K=50, we need ALL.
-    // Since K=ALL is possible, partial_sort doesn't help if we fail the small
-    // beam. BUT: K=5 succeeds 99% of the time. So optimizing for K=5 is worth
-    // it? If we partial_sort(5), then fail, we have to re-sort for 50. That
-    // seems complex. However, we can just sort for the max reasonable K? Or
-    // just full sort. Actually, if we partially sort for 5, then loop needs 5.
-    // If loop fails, we come back... but we already returned or recursed?
-    // Wait, the K loop is *inside* solve.
-    // If K=5 fails, we proceed to K=50 loop.
-    // So we need the vector to be sorted up to 50.
-    // If we only sort 5, the rest are heap/undefined.
-
-    // Let's stick to std::sort for correctness across K retries,
-    // OR we can implement an incremental sort strategy?
-    // Too complex.
-    // Let's look at the K values again: 5, 50, 100000.
-    // Most of the time K=5 works.
-    // If we fully sort, it's safe.
-    // Is sorting 13000 items slow?
-    // 13000 * 14 = 180k comparisons. Microseconds.
-    // The overhead of re-sorting or managing state is likely higher.
-
-    // Decision: Stick to std::sort. It's robust and fast enough for N=13000.
-    // partial_sort for 13000 items is basically sort.
-
-    // ACTUALLY: The "Heuristics" loop in the spec says:
-    // "Iterate through Beam Widths K in {5, 50, ALL}".
-    // We generate heuristics ONCE.
-    // Then we try K=5.
-    // If fail, try K=50.
-
-    // If we want to optimize, we could `partial_sort` the first 5.
-    // If that fails, `partial_sort` the next 45 (total 50).
-    // If that fails, sort the rest.
-
-    // Let's try just sorting. The user asked "Can we build any faster?".
-    // Maybe ThreadPool is the real answer.
-
-    std::sort(scored_guesses.begin(), scored_guesses.end(),
-              [this](const auto &a, const auto &b) {
-                if (heuristic_ == HeuristicType::ENTROPY) {
-                  return a.score > b.score;
-                } else {
-                  return a.score < b.score;
-                }
-              });
+  // Force start_word at depth 0
+  std::vector<ScoredGuess> forced;
+  if (depth == 0) {
+    if (!start_word_.empty()) {
+      auto it = std::lower_bound(words_.get_guesses().begin(),
+                                 words_.get_guesses().end(), start_word_);
+      if (it != words_.get_guesses().end() && *it == start_word_) {
+        int idx = std::distance(words_.get_guesses().begin(), it);
+        double fake_score = higher_is_better(heuristic_) ? 100.0 : -100.0;
+        forced.push_back({idx, fake_score, 1});
+      } else {
+        std::cerr << "Warning: Start word '" << start_word_
+                  << "' not found in guesses." << std::endl;
+      }
+    }
   }
 
-  int K_values[] = {5, 50, 100000};
+  // Beam widths are tried in increasing order. K=5 almost always succeeds,
+  // so wider beams are only selected (and re-scored with a looser bound)
+  // after a narrower one fails; guesses already tried are skipped.
+  const size_t K_values[] = {5, 50, candidate_guesses.size()};
+  size_t tried = 0;
 
-  for (int K : K_values) {
-    int limit = std::min((int)scored_guesses.size(), K);
+  for (size_t K : K_values) {
+    // Without a usable start word the opener is searched like any other node.
+    std::vector<ScoredGuess> beam =
+        (depth == 0 && !forced.empty()) ? forced : select_beam(K);
 
-    for (int i = 0; i < limit; ++i) {
-      int g_idx = scored_guesses[i].index;
+    for (size_t i = tried; i < beam.size(); ++i) {
+      int g_idx = beam[i].index;
       auto node = std::make_shared<MemoryNode>();
       node->guess_index = g_idx;
 
       bool possible = true;
 
-      std::vector<std::vector<int>> bins(243);
-      for (int s : active_solution_indices) {
-        bins[table_.get_pattern(g_idx, s)].push_back(s);
+      std::vector<std::vector<int>> bins(Traits::kNumPatterns);
+      {
+        PerfScope scope(perf_, perf_partitioning_);
+        for (int s : active_solution_indices)
+          bins[table_.get_pattern(g_idx, s)].push_back(s);
       }
 
-      for (int p = 0; p < 243; ++p) {
+      for (int p = 0; p < Traits::kNumPatterns; ++p) {
         if (bins[p].empty())
           continue;
 
@@ -277,12 +384,13 @@ std::shared_ptr<MemoryNode> Builder::solve(const SolverState &candidates,
         for (int s : bins[p])
           next_state.set(s);
 
-        if (p != 242 && next_state.count() == candidates.count()) {
+        if (p != Traits::kSolvedPattern &&
+            next_state.count() == candidates.count()) {
           possible = false;
           break;
         }
 
-        if (p == 242) {
+        if (p == Traits::kSolvedPattern) {
           continue;
         }
 
@@ -291,17 +399,181 @@ std::shared_ptr<MemoryNode> Builder::solve(const SolverState &candidates,
           possible = false;
           break;
         }
-        node->children[p] = child;
+        node->children.emplace_back(static_cast<uint16_t>(p), child);
       }
 
       if (possible) {
-        cache_[candidates] = node;
+        // The root depends on the start word, so it is never memoized.
+        if (depth > 0)
+          cache_->insert(key, node);
         return node;
       }
     }
+
+    // Every scorable guess has been tried.
+    if (beam.size() < K)
+      break;
+    tried = beam.size();
   }
 
   return nullptr;
 }
 
+template <int L> struct BasicBuilder<L>::SmallContext {
+  // Local candidate j is global solution solutions[j]; local row r is global
+  // guess guesses[r]. Both keep global order, so local indices break ties
+  // exactly as global ones do and the tree is unchanged.
+  std::vector<int> solutions;
+  std::vector<int> guesses;
+  std::vector<uint32_t> masks;    // Letter mask per row
+  std::vector<int> solution_rows; // Row of each candidate's own guess
+  Table table; // rows x candidates: at most 64 patterns a row
+  // Solved and failed (nullptr) descendants by (mask, remaining guesses).
+  std::unordered_map<uint64_t, std::shared_ptr<MemoryNode>> memo[7];
+};
+
+// Mirror of solve() over local masks. Every decision (guess filter, rules,
+// beam widths, scoring kernel and order) matches, so results do too.
+template <int L>
+std::shared_ptr<MemoryNode>
+BasicBuilder<L>::solve_small(SmallContext &ctx, uint64_t mask, int depth,
+                             bool check_memo) {
+  if (mask == 0)
+    return nullptr;
+  const int R = kMaxGuesses - depth;
+  const int count = __builtin_popcountll(mask);
+
+  // Single candidates and exhausted budgets need no memo.
+  if (count == 1) {
+    auto node = std::make_shared<MemoryNode>();
+    node->guess_index =
+        solution_to_guess_[ctx.solutions[__builtin_ctzll(mask)]];
+    node->is_leaf = true;
+    return node;
+  }
+  if (depth >= kMaxGuesses)
+    return nullptr;
+
+  // The local memo first; the shared one (and the store) on a miss, so
+  // builds sharing a memo still share small subtrees.
+  SolverState state;
+  std::shared_ptr<MemoryNode> *slot = nullptr;
+  if (check_memo) {
+    auto [it, inserted] = ctx.memo[R].try_emplace(mask, nullptr);
+    if (!inserted)
+      return it->second;
+    slot = &it->second;
+    state = SolverState(table_.num_solutions());
+    for (uint64_t m = mask; m; m &= m - 1)
+      state.set(ctx.solutions[__builtin_ctzll(m)]);
+    MemoKey key{state, R};
+    if (auto cached = cache_->find(key))
+      return *slot = cached;
+    if (store_) {
+      if (auto stored = store_->find(key)) {
+        cache_->insert(key, stored);
+        return *slot = stored;
+      }
+    }
+  }
+
+  std::vector<int> active;
+  active.reserve(count);
+  uint32_t active_mask = 0;
+  for (uint64_t m = mask; m; m &= m - 1) {
+    int j = __builtin_ctzll(m);
+    active.push_back(j);
+    active_mask |= solution_masks_[ctx.solutions[j]];
+  }
+
+  std::vector<int> rows;
+  if (R == 1) {
+    for (int j : active)
+      if (ctx.solution_rows[j] >= 0)
+        rows.push_back(ctx.solution_rows[j]);
+  } else {
+    for (size_t r = 0; r < ctx.guesses.size(); ++r)
+      if (ctx.masks[r] & active_mask)
+        rows.push_back(static_cast<int>(r));
+  }
+
+  const size_t K_values[] = {5, 50, rows.size()};
+  size_t tried = 0;
+  std::shared_ptr<MemoryNode> result;
+
+  for (size_t K : K_values) {
+    std::vector<ScoredGuess> beam;
+    {
+      PerfScope scope(perf_, perf_scoring_);
+      beam = best_k<L>(heuristic_, R, K, [&](auto h, const ScoreBound &rules) {
+        return score_top_k<L, decltype(h)::value>(active, rows.data(),
+                                                  rows.size(), ctx.table,
+                                                  rules, K);
+      });
+    }
+
+    for (size_t i = tried; i < beam.size() && !result; ++i) {
+      const int row = beam[i].index;
+      const Pattern *patterns =
+          &ctx.table.get_raw_table()[row * ctx.solutions.size()];
+
+      // Child masks by pattern, in ascending pattern order.
+      std::pair<Pattern, uint64_t> bins[64];
+      int num_bins = 0;
+      {
+        PerfScope scope(perf_, perf_partitioning_);
+        for (int j : active) {
+          Pattern p = patterns[j];
+          int b = 0;
+          while (b < num_bins && bins[b].first != p)
+            ++b;
+          if (b == num_bins)
+            bins[num_bins++] = {p, 0};
+          bins[b].second |= 1ULL << j;
+        }
+        std::sort(bins, bins + num_bins, [](const auto &a, const auto &b) {
+          return a.first < b.first;
+        });
+      }
+
+      auto node = std::make_shared<MemoryNode>();
+      node->guess_index = ctx.guesses[row];
+      bool possible = true;
+      for (int b = 0; b < num_bins && possible; ++b) {
+        const Pattern p = bins[b].first;
+        if (p == Traits::kSolvedPattern)
+          continue;
+        if (bins[b].second == mask) {
+          possible = false;
+          break;
+        }
+        auto child = solve_small(ctx, bins[b].second, depth + 1, true);
+        if (!child) {
+          possible = false;
+          break;
+        }
+        node->children.emplace_back(static_cast<uint16_t>(p), child);
+      }
+      if (possible)
+        result = node;
+    }
+    if (result || beam.size() < K)
+      break;
+    tried = beam.size();
+  }
+
+  if (check_memo) {
+    *slot = result;
+    if (result)
+      cache_->insert(MemoKey{state, R}, result);
+  }
+  return result;
+}
+
+template class BasicBuilder<4>;
+template class BasicBuilder<5>;
+template class BasicBuilder<6>;
+template class BasicBuilder<7>;
+template class BasicBuilder<8>;
+
 } // namespace wordle
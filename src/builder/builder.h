@@ -1,49 +1,115 @@
 #pragma once
 #include "entropy.h"
 #include "libwordle_core/patterntable.h"
+#include "libwordle_core/perfcounters.h"
 #include "libwordle_core/wordlist.h"
+#include "memo.h"
 #include "state.h"
-#include <array>
 #include <memory>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace wordle {
 
+class MemoStore;
+
+// Guesses a single-board tree may use. States that cannot be solved within
+// it fail, and memo keys count the guesses left out of it.
+constexpr int kMaxGuesses = 6;
+
 struct MemoryNode {
   uint16_t guess_index = 0;
   bool is_leaf = false;
-  // Children: Index by pattern (0-242).
-  // If nullptr, that pattern is impossible.
-  std::array<std::shared_ptr<MemoryNode>, 243> children;
+  // Children for the possible patterns only, sorted by pattern (0 to
+  // 3^L - 1). Patterns without an entry are impossible. Kept sparse because a
+  // node rarely has more than a few dozen children and memos hold many nodes.
+  // Patterns are stored 16-bit so one node type serves every word length.
+  std::vector<std::pair<uint16_t, std::shared_ptr<MemoryNode>>> children;
+
+  // Returns the child for `pattern`, or nullptr if it is impossible.
+  std::shared_ptr<MemoryNode> child(uint16_t pattern) const;
 };
 
-class Builder {
+// Tree builder for words of length L. The scoring kernel, partitioning and
+// pattern table are specialized per L; instantiated for 4-8 letters.
+template <int L> class BasicBuilder {
 public:
-  Builder(const WordList &words, const PatternTable &table,
+  using Traits = WordTraits<L>;
+  using Pattern = typename Traits::Pattern;
+  using Table = BasicPatternTable<L>;
+
+  BasicBuilder(const WordList &words, const Table &table,
           const std::string &start_word,
-          HeuristicType heuristic = HeuristicType::ENTROPY);
+          HeuristicType heuristic = HeuristicType::ENTROPY,
+          std::shared_ptr<Memo> memo = nullptr);
 
   std::shared_ptr<MemoryNode> build();
 
+  // Solves one state `depth` guesses below the root, as build() would reach
+  // it (distributed workers solve root buckets this way). The result is
+  // memoized like any other subtree.
+  std::shared_ptr<MemoryNode> build_subtree(const SolverState &candidates,
+                                            int depth) {
+    return solve(candidates, depth);
+  }
+
+  // Scores guesses on the shared thread pool (default). Callers that already
+  // run several builds concurrently turn this off to avoid oversubscription.
+  void set_parallel_scoring(bool enabled) { parallel_scoring_ = enabled; }
+
+  // Solves states of at most 64 candidates with solve_small() (default).
+  // The result is the same tree either way; tests compare the two paths.
+  void set_small_states(bool enabled) { small_states_ = enabled; }
+
+  // Consults `store` for subtrees missing from the memo. The store must
+  // outlive the builder.
+  void set_memo_store(const MemoStore *store) { store_ = store; }
+
+  // Charges guess scoring and candidate partitioning to their own phases
+  // of `perf`; the rest of the build stays in the caller's phase. Only for
+  // a single build on the calling thread.
+  void set_perf(PerfPhases *perf) {
+    perf_ = perf;
+    perf_scoring_ = perf->phase("scoring");
+    perf_partitioning_ = perf->phase("partitioning");
+  }
+
 private:
   std::shared_ptr<MemoryNode> solve(const SolverState &candidates, int depth);
 
+  // States with at most 64 candidates are solved on a local sub-table with
+  // every descendant as a uint64_t mask over the local candidates.
+  struct SmallContext;
+  std::shared_ptr<MemoryNode> solve_small(SmallContext &ctx, uint64_t mask,
+                                          int depth, bool check_memo);
+
   const WordList &words_;
-  const PatternTable &table_;
+  const Table &table_;
   std::string start_word_;
   HeuristicType heuristic_;
+  bool parallel_scoring_ = true;
+  bool small_states_ = true;
 
-  std::unordered_map<SolverState, std::shared_ptr<MemoryNode>> cache_;
+  // Solved subtrees keyed by (candidates, remaining guesses). May be shared
+  // with other builders using the same words, table and heuristic.
+  std::shared_ptr<Memo> cache_;
+  const MemoStore *store_ = nullptr;
+  PerfPhases *perf_ = nullptr;
+  int perf_scoring_ = -1;
+  int perf_partitioning_ = -1;
   std::vector<int> solution_to_guess_;
 
   // Optimization: Character bitmasks for pruning
   std::vector<uint32_t> guess_masks_;
   std::vector<uint32_t> solution_masks_;
-
-  // Helper to get next state given a guess and pattern
-  SolverState filter_candidates(const SolverState &current, int guess_idx,
-                                uint8_t pattern);
 };
 
+using Builder = BasicBuilder<5>;
+
+extern template class BasicBuilder<4>;
+extern template class BasicBuilder<5>;
+extern template class BasicBuilder<6>;
+extern template class BasicBuilder<7>;
+extern template class BasicBuilder<8>;
+
 } // namespace wordle
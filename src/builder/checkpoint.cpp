@@ -0,0 +1,39 @@
+#include "checkpoint.h"
+#include <iostream>
+
+namespace wordle {
+
+Checkpointer::Checkpointer(MemoStore &store, const Memo &memo,
+                           std::chrono::seconds interval)
+    : store_(store), memo_(memo), interval_(interval),
+      thread_(&Checkpointer::run, this) {}
+
+Checkpointer::~Checkpointer() { stop(); }
+
+void Checkpointer::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+void Checkpointer::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!wake_.wait_for(lock, interval_, [this] { return stopping_; })) {
+    lock.unlock();
+    long written = store_.append(memo_);
+    lock.lock();
+    if (written < 0) {
+      std::cerr << "Warning: Checkpoint failed; retrying in "
+                << interval_.count() << "s." << std::endl;
+      continue;
+    }
+    written_ += written;
+    ++checkpoints_;
+  }
+}
+
+} // namespace wordle
@@ -0,0 +1,52 @@
+#pragma once
+#include "memo.h"
+#include "memo_store.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace wordle {
+
+// Appends newly solved memo entries to a MemoStore every `interval` from a
+// background thread, so a build that is killed or preempted can be resumed
+// from that store (builds use it like --memo-store). The build threads only
+// wait while the entries are collected, never on the disk.
+//
+// The root is not memoized, so a resumed build scores the root again and
+// finds every finished root bucket, and every finished subtree of an
+// unfinished one, in the store. Failed states are not stored and are
+// searched again.
+class Checkpointer {
+public:
+  Checkpointer(MemoStore &store, const Memo &memo,
+               std::chrono::seconds interval);
+  ~Checkpointer();
+
+  Checkpointer(const Checkpointer &) = delete;
+  Checkpointer &operator=(const Checkpointer &) = delete;
+
+  // Stops the writer thread after any checkpoint in progress. The caller
+  // then owns the store again (for the final append).
+  void stop();
+
+  // Records written and checkpoints taken so far.
+  long written() const { return written_; }
+  int checkpoints() const { return checkpoints_; }
+
+private:
+  void run();
+
+  MemoStore &store_;
+  const Memo &memo_;
+  std::chrono::seconds interval_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  long written_ = 0;
+  int checkpoints_ = 0;
+  std::thread thread_;
+};
+
+} // namespace wordle
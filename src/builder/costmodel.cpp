@@ -0,0 +1,235 @@
+#include "costmodel.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace wordle {
+
+namespace {
+
+// Samples a fitted mean is worth: sizes measured fewer times than this lean
+// mostly on the log2 fit.
+constexpr double kPriorWeight = 4.0;
+
+template <int L> class CostSampler {
+public:
+  using Pattern = typename WordTraits<L>::Pattern;
+
+  CostSampler(const BasicPatternTable<L> &table, CostSamples &samples)
+      : table_(table), samples_(samples) {}
+
+  // Total guesses the candidates in `set` take from `node` on. The root is
+  // not sampled: no guess has split its candidates yet.
+  long walk(const MemoryNode &node, const std::vector<int> &set,
+            bool sample = true) {
+    std::vector<std::pair<Pattern, int>> parts;
+    parts.reserve(set.size());
+    for (int s : set)
+      parts.emplace_back(table_.get_pattern(node.guess_index, s), s);
+    std::sort(parts.begin(), parts.end());
+
+    long total = static_cast<long>(set.size()); // This guess, for everyone
+    size_t largest = 0;
+    std::vector<int> bucket;
+    for (size_t i = 0; i < parts.size();) {
+      const Pattern p = parts[i].first;
+      bucket.clear();
+      for (; i < parts.size() && parts[i].first == p; ++i)
+        bucket.push_back(parts[i].second);
+      largest = std::max(largest, bucket.size());
+      if (p == WordTraits<L>::kSolvedPattern)
+        continue;
+      auto child = node.child(p);
+      if (child)
+        total += walk(*child, bucket);
+    }
+
+    if (!sample)
+      return total;
+    const double mean = static_cast<double>(total) / set.size();
+    add(samples_.sum, samples_.count, set.size(), mean);
+    add(samples_.bucket_sum, samples_.bucket_count, largest, mean);
+    ++samples_.states;
+    return total;
+  }
+
+private:
+  static void add(std::vector<double> &sum, std::vector<long> &count,
+                  size_t index, double value) {
+    if (sum.size() <= index) {
+      sum.resize(index + 1, 0.0);
+      count.resize(index + 1, 0);
+    }
+    sum[index] += value;
+    ++count[index];
+  }
+
+  const BasicPatternTable<L> &table_;
+  CostSamples &samples_;
+};
+
+} // namespace
+
+template <int L>
+void sample_costs(const std::shared_ptr<MemoryNode> &root,
+                  const WordList &words, const BasicPatternTable<L> &table,
+                  CostSamples &samples) {
+  std::vector<int> all(words.get_solutions().size());
+  for (size_t i = 0; i < all.size(); ++i)
+    all[i] = static_cast<int>(i);
+  CostSampler<L>(table, samples).walk(*root, all, false);
+  ++samples.trees;
+}
+
+CostModel fit_cost_model(const CostSamples &samples) {
+  CostModel model;
+  // The table stops at the largest size measured often enough to matter;
+  // the fit covers the rest.
+  size_t size = 2;
+  for (size_t n = 2; n < samples.count.size(); ++n)
+    if (samples.count[n] >= kPriorWeight)
+      size = n + 1;
+
+  // Weighted least squares of the mean on log2(n), n >= 2.
+  double w = 0, wx = 0, wy = 0, wxx = 0, wxy = 0;
+  for (size_t n = 2; n < samples.count.size(); ++n) {
+    if (!samples.count[n])
+      continue;
+    const double c = static_cast<double>(samples.count[n]);
+    const double x = std::log2(static_cast<double>(n));
+    const double y = samples.sum[n] / c;
+    w += c;
+    wx += c * x;
+    wy += c * y;
+    wxx += c * x * x;
+    wxy += c * x * y;
+  }
+  const double det = w * wxx - wx * wx;
+  if (w > 0 && det > 1e-12) {
+    model.tail_b = (w * wxy - wx * wy) / det;
+    model.tail_a = (wy - model.tail_b * wx) / w;
+  } else {
+    model.tail_b = 1.5; // The uncalibrated default
+  }
+
+  // Shrink each mean towards the fit, then pool adjacent violators so the
+  // table never decreases. One candidate always takes exactly one guess.
+  struct Block {
+    double value, weight;
+    size_t length;
+  };
+  std::vector<Block> blocks;
+  for (size_t n = 1; n < size; ++n) {
+    double value = 1.0, weight = kPriorWeight;
+    if (n >= 2) {
+      const double fit =
+          model.tail_a + model.tail_b * std::log2(static_cast<double>(n));
+      const bool seen = n < samples.count.size();
+      const double c = seen ? static_cast<double>(samples.count[n]) : 0.0;
+      const double s = seen ? samples.sum[n] : 0.0;
+      weight = c + kPriorWeight;
+      value = (s + kPriorWeight * fit) / weight;
+    }
+    blocks.push_back({value, weight, 1});
+    while (blocks.size() > 1 &&
+           blocks[blocks.size() - 2].value > blocks.back().value) {
+      Block b = blocks.back();
+      blocks.pop_back();
+      Block &a = blocks.back();
+      a.value = (a.value * a.weight + b.value * b.weight) / (a.weight + b.weight);
+      a.weight += b.weight;
+      a.length += b.length;
+    }
+  }
+  model.expected.push_back(0.0);
+  for (const Block &b : blocks)
+    model.expected.insert(model.expected.end(), b.length, b.value);
+  return model;
+}
+
+bool load_cost_model(const std::string &path, CostModel &model) {
+  std::ifstream in(path);
+  if (!in) {
+    std::cerr << "Failed to open cost model: " << path << std::endl;
+    return false;
+  }
+  model = CostModel();
+  bool has_tail = false;
+  std::string line;
+  for (int line_no = 1; std::getline(in, line); ++line_no) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    std::string first;
+    if (!(fields >> first))
+      continue;
+    bool ok;
+    if (first == "tail") {
+      ok = static_cast<bool>(fields >> model.tail_a >> model.tail_b);
+      has_tail = true;
+    } else {
+      double value;
+      ok = first == std::to_string(model.expected.size()) &&
+           static_cast<bool>(fields >> value) && std::isfinite(value) &&
+           value >= (model.expected.empty() ? 0.0 : model.expected.back());
+      if (ok)
+        model.expected.push_back(value);
+    }
+    std::string rest;
+    if (!ok || fields >> rest) {
+      std::cerr << "Invalid cost model line " << line_no << " in " << path
+                << " (expected \"<n> <E(n)>\" with n counting up from 0 and "
+                   "E non-decreasing, or \"tail <a> <b>\")"
+                << std::endl;
+      return false;
+    }
+  }
+  if (!has_tail || model.expected.size() < 2 || model.expected[0] != 0.0 ||
+      !std::isfinite(model.tail_a) || !std::isfinite(model.tail_b) ||
+      model.tail_b < 0) {
+    std::cerr << "Incomplete cost model: " << path
+              << " (needs E(0) = 0, E(1) and a non-decreasing tail)"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool write_cost_model(const std::string &path, const CostModel &model,
+                      const CostSamples &samples) {
+  std::ofstream out(path);
+  if (!out)
+    return false;
+  out << "# Expected guesses E(n) for n candidates, measured over "
+      << samples.states << " states of " << samples.trees << " trees\n"
+      << std::setprecision(9) << "tail " << model.tail_a << " "
+      << model.tail_b << "\n# n E(n)  (samples, measured mean)\n";
+  for (size_t n = 0; n < model.expected.size(); ++n) {
+    out << n << " " << model.expected[n];
+    if (n < samples.count.size() && samples.count[n])
+      out << "  # " << samples.count[n] << " "
+          << samples.sum[n] / samples.count[n];
+    out << "\n";
+  }
+  out << "# By largest bucket left by the guess (largest, samples, mean):\n";
+  for (size_t m = 0; m < samples.bucket_count.size(); ++m)
+    if (samples.bucket_count[m])
+      out << "#   " << m << " " << samples.bucket_count[m] << " "
+          << samples.bucket_sum[m] / samples.bucket_count[m] << "\n";
+  return static_cast<bool>(out);
+}
+
+#define WORDLE_INSTANTIATE_COSTS(L)                                           \
+  template void sample_costs<L>(const std::shared_ptr<MemoryNode> &,          \
+                                const WordList &, const BasicPatternTable<L> &, \
+                                CostSamples &);
+
+WORDLE_INSTANTIATE_COSTS(4)
+WORDLE_INSTANTIATE_COSTS(5)
+WORDLE_INSTANTIATE_COSTS(6)
+WORDLE_INSTANTIATE_COSTS(7)
+WORDLE_INSTANTIATE_COSTS(8)
+
+} // namespace wordle
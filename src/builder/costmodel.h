@@ -0,0 +1,65 @@
+#pragma once
+#include "builder.h"
+#include "libwordle_core/patterntable.h"
+#include "libwordle_core/wordlist.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace wordle {
+
+// E(n), the expected number of guesses still needed once a guess leaves `n`
+// candidates (the guess that solves the puzzle included), as min_expected
+// scores it. Loaded with --cost-model, written by --calibrate.
+struct CostModel {
+  std::vector<double> expected; // E(0) .. E(size - 1), non-decreasing
+  // Past the table, E(n) = tail_a + tail_b * log2(n) (but never less than
+  // the last entry).
+  double tail_a = 0.0;
+  double tail_b = 0.0;
+
+  double at(size_t n) const {
+    if (n < expected.size())
+      return expected[n];
+    const double last = expected.empty() ? 0.0 : expected.back();
+    return std::max(last,
+                    tail_a + tail_b * std::log2(static_cast<double>(n)));
+  }
+};
+
+// Guesses actually spent by built trees, gathered per candidate-set size.
+struct CostSamples {
+  // Per non-root node reached with n candidates: their mean guesses from
+  // that node on. Indexed by n.
+  std::vector<double> sum;
+  std::vector<long> count;
+  // The same means grouped by the largest bucket the node's guess leaves,
+  // for the report only.
+  std::vector<double> bucket_sum;
+  std::vector<long> bucket_count;
+  size_t trees = 0;
+  size_t states = 0;
+};
+
+// Adds every node below `root` to `samples`.
+template <int L>
+void sample_costs(const std::shared_ptr<MemoryNode> &root,
+                  const WordList &words, const BasicPatternTable<L> &table,
+                  CostSamples &samples);
+
+// Fits a model to the samples: measured means shrunk towards a weighted
+// least-squares log2 fit where sizes have few samples, then made
+// non-decreasing (weighted isotonic regression) so that min_expected's
+// bucket terms stay monotone, which its pruning bound relies on.
+CostModel fit_cost_model(const CostSamples &samples);
+
+// Text format: "tail <a> <b>" and one "<n> <E(n)>" line per size from 0;
+// '#' starts a comment. write_cost_model also records the samples behind
+// each entry and the largest-bucket profile as comments.
+bool load_cost_model(const std::string &path, CostModel &model);
+bool write_cost_model(const std::string &path, const CostModel &model,
+                      const CostSamples &samples);
+
+} // namespace wordle
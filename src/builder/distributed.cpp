@@ -0,0 +1,599 @@
+#include "distributed.h"
+#include "builder.h"
+#include "memo_store.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace wordle {
+
+namespace {
+
+// Every message is a MessageHeader followed by `size` payload bytes, in the
+// host byte order of both ends (little-endian in practice, like the
+// artifacts).
+constexpr uint32_t kWireMagic = 0x54534457; // "WDST"
+constexpr uint32_t kWireVersion = 2; // v2: cost table hash in Hello
+constexpr uint32_t kMaxPayload = 64u << 20;
+
+// Root buckets are one guess (the opener) deep, so their subtrees get the
+// rest of the builder's guess budget.
+constexpr int kBucketDepth = 1;
+constexpr int kBucketGuesses = kMaxGuesses - kBucketDepth;
+
+enum class MessageType : uint32_t {
+  Hello = 1, // Worker -> coordinator: Hello
+  Welcome,   // Coordinator -> worker: Welcome
+  Task,      // Coordinator -> worker: TaskHeader, uint32_t solutions[count]
+  Result,    // Worker -> coordinator: ResultHeader, StoredNode nodes[]
+  Done,      // Coordinator -> worker: no payload, disconnect
+};
+
+struct MessageHeader {
+  uint32_t magic = kWireMagic;
+  uint32_t type;
+  uint32_t size;
+  uint32_t reserved = 0;
+};
+
+struct Hello {
+  uint32_t version = kWireVersion;
+  uint32_t word_length;
+  uint64_t list_checksum;
+  uint32_t num_solutions;
+  uint32_t num_guesses;
+  uint64_t cost_table; // expected_costs_hash(): the same --cost-model
+};
+
+struct Welcome {
+  uint32_t heuristic;
+  uint32_t reserved = 0;
+};
+
+struct TaskHeader {
+  uint32_t task;
+  uint32_t depth; // Guesses already made, 1 for a root bucket
+  uint32_t count;
+  uint32_t reserved = 0;
+};
+
+struct ResultHeader {
+  uint32_t task;
+  uint32_t num_nodes; // 0: the bucket has no solution within the limit
+};
+
+bool send_all(int fd, const void *data, size_t size) {
+  const char *p = static_cast<const char *>(data);
+  while (size > 0) {
+    ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    p += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool recv_all(int fd, void *data, size_t size) {
+  char *p = static_cast<char *>(data);
+  while (size > 0) {
+    ssize_t n = recv(fd, p, size, 0);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    p += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Sends one message whose payload is the concatenation of `parts`.
+bool send_message(int fd, MessageType type,
+                  std::initializer_list<std::pair<const void *, size_t>> parts) {
+  MessageHeader h;
+  h.type = static_cast<uint32_t>(type);
+  h.size = 0;
+  for (const auto &part : parts)
+    h.size += static_cast<uint32_t>(part.second);
+  std::vector<uint8_t> out(sizeof(h));
+  std::memcpy(out.data(), &h, sizeof(h));
+  for (const auto &part : parts) {
+    const auto *bytes = static_cast<const uint8_t *>(part.first);
+    out.insert(out.end(), bytes, bytes + part.second);
+  }
+  return send_all(fd, out.data(), out.size());
+}
+
+// Blocking read of the next message (worker side).
+bool recv_message(int fd, MessageHeader &h, std::vector<uint8_t> &payload) {
+  if (!recv_all(fd, &h, sizeof(h)) || h.magic != kWireMagic ||
+      h.size > kMaxPayload)
+    return false;
+  payload.resize(h.size);
+  return recv_all(fd, payload.data(), h.size);
+}
+
+// "host:port" -> connected socket, or -1.
+int connect_to(const std::string &address) {
+  const size_t colon = address.rfind(':');
+  if (colon == std::string::npos) {
+    std::cerr << "Worker address must be host:port: " << address << std::endl;
+    return -1;
+  }
+  const std::string host = address.substr(0, colon);
+  const std::string port = address.substr(colon + 1);
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo *found = nullptr;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0) {
+    std::cerr << "Cannot resolve coordinator " << address << std::endl;
+    return -1;
+  }
+  int fd = -1;
+  for (addrinfo *a = found; a && fd < 0; a = a->ai_next) {
+    fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (fd >= 0 && connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(found);
+  if (fd < 0) {
+    std::cerr << "Cannot connect to coordinator " << address << ": "
+              << std::strerror(errno) << std::endl;
+    return -1;
+  }
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fd;
+}
+
+// One root bucket: the solutions sharing a pattern against the opener.
+struct Bucket {
+  std::vector<int> solutions;
+  SolverState state;
+  bool done = false;
+};
+
+struct Connection {
+  int fd = -1;
+  std::vector<uint8_t> in; // Bytes received, not yet parsed
+  bool ready = false;      // Handshake done
+  int task = -1;           // Bucket in flight
+};
+
+template <int L> class Coordinator {
+public:
+  using Pattern = typename WordTraits<L>::Pattern;
+
+  Coordinator(const WordList &words, const BasicPatternTable<L> &table,
+              HeuristicType heuristic, Memo &memo, DistributeStats &stats)
+      : words_(words), table_(table), heuristic_(heuristic), memo_(memo),
+        stats_(stats) {}
+
+  // Splits the solutions under `opener`; returns the number left to solve.
+  size_t partition(int opener) {
+    std::vector<std::vector<int>> parts(WordTraits<L>::kNumPatterns);
+    for (size_t s = 0; s < words_.get_solutions().size(); ++s)
+      parts[table_.get_pattern(opener, static_cast<int>(s))].push_back(
+          static_cast<int>(s));
+    for (int p = 0; p < WordTraits<L>::kNumPatterns; ++p) {
+      if (parts[p].empty() || p == WordTraits<L>::kSolvedPattern)
+        continue;
+      Bucket b;
+      b.state = SolverState(words_.get_solutions().size());
+      for (int s : parts[p])
+        b.state.set(s);
+      b.solutions = std::move(parts[p]);
+      ++stats_.buckets;
+      if (b.solutions.size() == 1 ||
+          memo_.find(MemoKey{b.state, kBucketGuesses})) {
+        ++stats_.cached; // Single words are solved without a search.
+        continue;
+      }
+      buckets_.push_back(std::move(b));
+    }
+    std::vector<int> order(buckets_.size());
+    for (size_t i = 0; i < order.size(); ++i)
+      order[i] = static_cast<int>(i);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+      return buckets_[a].solutions.size() > buckets_[b].solutions.size();
+    });
+    queue_.assign(order.begin(), order.end());
+    remaining_ = buckets_.size();
+    return remaining_;
+  }
+
+  size_t remaining() const { return remaining_; }
+
+  // Reads what `c` sent; false once it should be dropped.
+  bool receive(Connection &c) {
+    uint8_t buffer[1 << 16];
+    ssize_t n = recv(c.fd, buffer, sizeof(buffer), 0);
+    if (n < 0 && errno == EINTR)
+      return true;
+    if (n <= 0)
+      return false;
+    c.in.insert(c.in.end(), buffer, buffer + n);
+
+    while (c.in.size() >= sizeof(MessageHeader)) {
+      MessageHeader h;
+      std::memcpy(&h, c.in.data(), sizeof(h));
+      if (h.magic != kWireMagic || h.size > kMaxPayload)
+        return false;
+      if (c.in.size() < sizeof(h) + h.size)
+        break;
+      std::vector<uint8_t> payload(c.in.begin() + sizeof(h),
+                                   c.in.begin() + sizeof(h) + h.size);
+      c.in.erase(c.in.begin(), c.in.begin() + sizeof(h) + h.size);
+      if (!handle(c, static_cast<MessageType>(h.type), payload))
+        return false;
+    }
+    return true;
+  }
+
+  // Puts the bucket `c` was holding back in the queue.
+  void requeue(Connection &c) {
+    if (c.task >= 0 && !buckets_[c.task].done) {
+      queue_.push_front(c.task);
+      ++stats_.requeued;
+    }
+    c.task = -1;
+  }
+
+private:
+  bool handle(Connection &c, MessageType type,
+              const std::vector<uint8_t> &payload) {
+    if (type == MessageType::Hello && !c.ready) {
+      Hello hello;
+      if (payload.size() != sizeof(hello))
+        return false;
+      std::memcpy(&hello, payload.data(), sizeof(hello));
+      if (hello.version != kWireVersion || hello.word_length != L ||
+          hello.list_checksum != words_.get_checksum() ||
+          hello.num_solutions != words_.get_solutions().size() ||
+          hello.num_guesses != words_.get_guesses().size()) {
+        std::cerr << "Rejected a worker with different word lists or "
+                     "protocol version."
+                  << std::endl;
+        return false;
+      }
+      if (hello.cost_table != expected_costs_hash()) {
+        std::cerr << "Rejected a worker with a different cost table (pass it "
+                     "the same --cost-model)."
+                  << std::endl;
+        return false;
+      }
+      Welcome welcome;
+      welcome.heuristic = static_cast<uint32_t>(heuristic_);
+      if (!send_message(c.fd, MessageType::Welcome,
+                        {{&welcome, sizeof(welcome)}}))
+        return false;
+      c.ready = true;
+      ++stats_.workers;
+      return assign(c);
+    }
+
+    if (type == MessageType::Result && c.ready && c.task >= 0) {
+      ResultHeader rh;
+      if (payload.size() < sizeof(rh))
+        return false;
+      std::memcpy(&rh, payload.data(), sizeof(rh));
+      if (rh.task != static_cast<uint32_t>(c.task) ||
+          payload.size() != sizeof(rh) + rh.num_nodes * sizeof(StoredNode))
+        return false;
+      std::vector<StoredNode> nodes(rh.num_nodes);
+      if (rh.num_nodes)
+        std::memcpy(nodes.data(), payload.data() + sizeof(rh),
+                    rh.num_nodes * sizeof(StoredNode));
+      accept_result(c.task, nodes);
+      c.task = -1;
+      return assign(c);
+    }
+    return false; // Anything else breaks the protocol.
+  }
+
+  bool assign(Connection &c) {
+    while (!queue_.empty() && buckets_[queue_.front()].done)
+      queue_.pop_front();
+    if (queue_.empty())
+      return true; // Idle until the build ends.
+    c.task = queue_.front();
+    queue_.pop_front();
+    const Bucket &b = buckets_[c.task];
+    std::vector<uint32_t> solutions(b.solutions.begin(), b.solutions.end());
+    TaskHeader th{static_cast<uint32_t>(c.task), kBucketDepth,
+                  static_cast<uint32_t>(solutions.size())};
+    return send_message(c.fd, MessageType::Task,
+                        {{&th, sizeof(th)},
+                         {solutions.data(),
+                          solutions.size() * sizeof(uint32_t)}});
+  }
+
+  void accept_result(int task, const std::vector<StoredNode> &nodes) {
+    Bucket &b = buckets_[task];
+    b.done = true;
+    --remaining_;
+    stats_.nodes += nodes.size();
+    auto root = decode_subtree(nodes.data(), nodes.size());
+    if (!root || !solves(*root, b.solutions, kBucketGuesses)) {
+      // Left out of the memo: the final build solves it in process.
+      if (!nodes.empty())
+        std::cerr << "Worker result for bucket " << task
+                  << " does not solve it; solving locally." << std::endl;
+      ++stats_.failed;
+      return;
+    }
+    // Buckets hold disjoint candidates, so no two results share a subtree.
+    memo_.insert(MemoKey{b.state, kBucketGuesses}, root);
+    ++stats_.solved;
+  }
+
+  // Replays `set` through `node`: every candidate must be solved within
+  // `remaining` guesses, through known guesses and patterns only.
+  bool solves(const MemoryNode &node, const std::vector<int> &set,
+              int remaining) const {
+    if (remaining <= 0 || node.guess_index >= words_.get_guesses().size())
+      return false;
+    for (const auto &child : node.children)
+      if (child.first >= WordTraits<L>::kNumPatterns)
+        return false;
+    std::vector<std::pair<Pattern, int>> parts;
+    for (int s : set)
+      parts.emplace_back(table_.get_pattern(node.guess_index, s), s);
+    std::sort(parts.begin(), parts.end());
+    std::vector<int> bucket;
+    for (size_t i = 0; i < parts.size();) {
+      const Pattern p = parts[i].first;
+      bucket.clear();
+      for (; i < parts.size() && parts[i].first == p; ++i)
+        bucket.push_back(parts[i].second);
+      if (p == WordTraits<L>::kSolvedPattern)
+        continue;
+      auto child = node.child(p);
+      if (!child || !solves(*child, bucket, remaining - 1))
+        return false;
+    }
+    return true;
+  }
+
+  const WordList &words_;
+  const BasicPatternTable<L> &table_;
+  HeuristicType heuristic_;
+  Memo &memo_;
+  DistributeStats &stats_;
+  std::vector<Bucket> buckets_;
+  std::deque<int> queue_;
+  size_t remaining_ = 0;
+};
+
+} // namespace
+
+template <int L>
+DistributeStats distribute_root(const WordList &words,
+                                const BasicPatternTable<L> &table,
+                                int opener, HeuristicType heuristic, int port,
+                                int local_workers,
+                                const std::vector<std::string> &worker_command,
+                                Memo &memo) {
+  DistributeStats stats;
+  // Results travel as StoredNode, whose guess indices are 16-bit.
+  if (words.get_guesses().size() > UINT16_MAX) {
+    std::cerr << "--distribute supports at most " << UINT16_MAX
+              << " guesses." << std::endl;
+    return stats;
+  }
+  Coordinator<L> coordinator(words, table, heuristic, memo, stats);
+  if (coordinator.partition(opener) == 0) {
+    stats.valid = true;
+    return stats;
+  }
+
+  int listener = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  socklen_t addr_len = sizeof(addr);
+  if (listener < 0 ||
+      bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      listen(listener, 64) != 0 ||
+      getsockname(listener, reinterpret_cast<sockaddr *>(&addr),
+                  &addr_len) != 0) {
+    std::cerr << "Cannot listen on port " << port << ": "
+              << std::strerror(errno) << std::endl;
+    if (listener >= 0)
+      close(listener);
+    return stats;
+  }
+  const int bound_port = ntohs(addr.sin_port);
+  std::cout << "Coordinator: " << coordinator.remaining()
+            << " root buckets to solve, listening on port " << bound_port
+            << std::endl;
+
+  // Local workers run this executable again, so they share nothing (no
+  // threads, no locks) with this process.
+  std::vector<std::string> args = worker_command;
+  args.push_back("--worker");
+  args.push_back("127.0.0.1:" + std::to_string(bound_port));
+  std::vector<char *> argv;
+  for (auto &a : args)
+    argv.push_back(a.data());
+  argv.push_back(nullptr);
+  std::vector<pid_t> children;
+  std::cout.flush();
+  for (int i = 0; i < local_workers; ++i) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(listener);
+      execv("/proc/self/exe", argv.data());
+      _exit(127);
+    }
+    if (pid > 0)
+      children.push_back(pid);
+    else
+      std::cerr << "Failed to start a local worker: " << std::strerror(errno)
+                << std::endl;
+  }
+  size_t live_children = children.size();
+
+  std::vector<std::unique_ptr<Connection>> connections;
+  auto drop = [&](size_t i) {
+    coordinator.requeue(*connections[i]);
+    close(connections[i]->fd);
+    connections.erase(connections.begin() + i);
+  };
+
+  while (coordinator.remaining() > 0) {
+    for (pid_t &pid : children)
+      if (pid > 0 && waitpid(pid, nullptr, WNOHANG) == pid) {
+        pid = -1;
+        --live_children;
+      }
+    // Nobody left to hand buckets to: build() finishes them here.
+    if (connections.empty() && live_children == 0 &&
+        (stats.workers > 0 || local_workers > 0))
+      break;
+
+    std::vector<pollfd> fds{{listener, POLLIN, 0}};
+    for (const auto &c : connections)
+      fds.push_back({c->fd, POLLIN, 0});
+    if (poll(fds.data(), fds.size(), 200) < 0 && errno != EINTR)
+      break;
+
+    // Connections are only appended below, so fds[i + 1] is connection i.
+    for (size_t i = fds.size() - 1; i > 0; --i)
+      if (fds[i].revents & (POLLIN | POLLHUP | POLLERR))
+        if (!coordinator.receive(*connections[i - 1]))
+          drop(i - 1);
+    if (fds[0].revents & POLLIN) {
+      int fd = accept(listener, nullptr, nullptr);
+      if (fd >= 0) {
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connections.push_back(std::move(connection));
+      }
+    }
+  }
+
+  for (const auto &c : connections) {
+    send_message(c->fd, MessageType::Done, {});
+    close(c->fd);
+  }
+  close(listener);
+  for (pid_t pid : children)
+    if (pid > 0)
+      waitpid(pid, nullptr, 0);
+  stats.valid = true;
+  return stats;
+}
+
+template <int L>
+int run_worker(const std::string &address, const WordList &words,
+               const BasicPatternTable<L> &table, unsigned int num_threads) {
+  int fd = connect_to(address);
+  if (fd < 0)
+    return 1;
+
+  Hello hello;
+  hello.word_length = L;
+  hello.list_checksum = words.get_checksum();
+  hello.num_solutions = static_cast<uint32_t>(words.get_solutions().size());
+  hello.num_guesses = static_cast<uint32_t>(words.get_guesses().size());
+  hello.cost_table = expected_costs_hash();
+  MessageHeader h;
+  std::vector<uint8_t> payload;
+  Welcome welcome;
+  if (!send_message(fd, MessageType::Hello, {{&hello, sizeof(hello)}}) ||
+      !recv_message(fd, h, payload) ||
+      h.type != static_cast<uint32_t>(MessageType::Welcome) ||
+      payload.size() != sizeof(welcome) ||
+      (std::memcpy(&welcome, payload.data(), sizeof(welcome)),
+       welcome.heuristic >= static_cast<uint32_t>(kNumHeuristics))) {
+    std::cerr << "Coordinator " << address
+              << " refused this worker (word lists and --cost-model must "
+                 "match)."
+              << std::endl;
+    close(fd);
+    return 1;
+  }
+  const auto heuristic = static_cast<HeuristicType>(welcome.heuristic);
+
+  auto memo = std::make_shared<Memo>();
+  BasicBuilder<L> builder(words, table, "", heuristic, memo);
+  builder.set_parallel_scoring(num_threads > 1);
+  size_t tasks = 0;
+  std::vector<StoredNode> nodes;
+  while (recv_message(fd, h, payload)) {
+    if (h.type == static_cast<uint32_t>(MessageType::Done)) {
+      std::cout << "Worker: solved " << tasks << " buckets." << std::endl;
+      close(fd);
+      return 0;
+    }
+    TaskHeader th;
+    if (h.type != static_cast<uint32_t>(MessageType::Task) ||
+        payload.size() < sizeof(th))
+      break;
+    std::memcpy(&th, payload.data(), sizeof(th));
+    if (payload.size() != sizeof(th) + th.count * sizeof(uint32_t) ||
+        th.depth >= kMaxGuesses)
+      break;
+    SolverState state(words.get_solutions().size());
+    const auto *solutions =
+        reinterpret_cast<const uint32_t *>(payload.data() + sizeof(th));
+    bool in_range = true;
+    for (uint32_t i = 0; i < th.count; ++i) {
+      in_range = in_range && solutions[i] < words.get_solutions().size();
+      if (in_range)
+        state.set(solutions[i]);
+    }
+    if (!in_range)
+      break;
+
+    nodes.clear();
+    if (auto node = builder.build_subtree(state, static_cast<int>(th.depth)))
+      encode_subtree(*node, nodes);
+    ResultHeader rh{th.task, static_cast<uint32_t>(nodes.size())};
+    if (!send_message(fd, MessageType::Result,
+                      {{&rh, sizeof(rh)},
+                       {nodes.data(), nodes.size() * sizeof(StoredNode)}}))
+      break;
+    ++tasks;
+  }
+  std::cerr << "Worker: lost the coordinator at " << address << std::endl;
+  close(fd);
+  return 1;
+}
+
+#define WORDLE_INSTANTIATE_DISTRIBUTED(L)                                     \
+  template DistributeStats distribute_root<L>(                                \
+      const WordList &, const BasicPatternTable<L> &, int, HeuristicType,     \
+      int, int, const std::vector<std::string> &, Memo &);                    \
+  template int run_worker<L>(const std::string &, const WordList &,           \
+                             const BasicPatternTable<L> &, unsigned int);
+
+WORDLE_INSTANTIATE_DISTRIBUTED(4)
+WORDLE_INSTANTIATE_DISTRIBUTED(5)
+WORDLE_INSTANTIATE_DISTRIBUTED(6)
+WORDLE_INSTANTIATE_DISTRIBUTED(7)
+WORDLE_INSTANTIATE_DISTRIBUTED(8)
+
+} // namespace wordle
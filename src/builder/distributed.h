@@ -0,0 +1,50 @@
+#pragma once
+#include "entropy.h"
+#include "libwordle_core/patterntable.h"
+#include "libwordle_core/wordlist.h"
+#include "memo.h"
+#include <string>
+#include <vector>
+
+namespace wordle {
+
+struct DistributeStats {
+  bool valid = false;
+  size_t buckets = 0;    // Root buckets to solve
+  size_t cached = 0;     // Single words, or already in the memo (--base)
+  size_t solved = 0;     // Solved by workers and seeded into the memo
+  size_t failed = 0;     // Reported unsolvable by a worker
+  size_t requeued = 0;   // Reassigned after their worker disconnected
+  size_t workers = 0;    // Workers that completed the handshake
+  size_t nodes = 0;      // Encoded nodes received
+};
+
+// Coordinator of a distributed build. Splits the solutions by their pattern
+// against `opener` (the root guess) and hands the buckets out, largest
+// first, to workers connecting on `port` (0 picks a free one; it is
+// printed). `local_workers` workers are started on this machine by running
+// `worker_command` (this executable and its list arguments) with "--worker
+// 127.0.0.1:<port>" appended. Each result is checked and inserted into
+// `memo` under its bucket, so a following build() with the same opener
+// assembles the tree from memo hits and verifies it as usual.
+//
+// Buckets a worker was holding when it disconnected go back in the queue.
+// Once every worker has left (and at least one had connected, or every
+// local worker has exited), the coordinator returns and build() solves the
+// remaining buckets in process.
+template <int L>
+DistributeStats distribute_root(const WordList &words,
+                                const BasicPatternTable<L> &table,
+                                int opener, HeuristicType heuristic, int port,
+                                int local_workers,
+                                const std::vector<std::string> &worker_command,
+                                Memo &memo);
+
+// Worker side: connects to `address` ("host:port"), checks that both ends
+// loaded the same word lists, then solves buckets with the coordinator's
+// heuristic until it is done. Returns 0 on a clean shutdown.
+template <int L>
+int run_worker(const std::string &address, const WordList &words,
+               const BasicPatternTable<L> &table, unsigned int num_threads);
+
+} // namespace wordle
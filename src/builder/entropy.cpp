@@ -1,6 +1,9 @@
 #include "entropy.h"
+#include "costmodel.h"
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstring>
 #include <mutex>
 #include <vector>
 
@@ -12,11 +15,15 @@ static std::vector<double> LOG_TABLE;
 static std::vector<double> EXPECTED_TABLE;
 static std::once_flag tables_flag;
 
+// Largest bucket the tables cover: guess indices are 16-bit, so no
+// dictionary has more candidates than this.
+constexpr int kTableSize = 1 << 16;
+
 void init_tables() {
   // Log Table
-  LOG_TABLE.resize(13000); // Support full dictionary size just in case
+  LOG_TABLE.resize(kTableSize); // Support full dictionary size just in case
   LOG_TABLE[0] = 0.0;
-  for (int i = 1; i < 13000; ++i) {
+  for (int i = 1; i < kTableSize; ++i) {
     LOG_TABLE[i] = i * std::log2(static_cast<double>(i));
   }
 
@@ -27,83 +34,430 @@ void init_tables() {
   // E(n) approximation:
   // It takes roughly log_base(n) steps.
   // Let's use a sigmoid-like or log fit based on observations.
-  EXPECTED_TABLE.resize(13000);
+  EXPECTED_TABLE.resize(kTableSize);
   EXPECTED_TABLE[0] = 0;
   EXPECTED_TABLE[1] = 0;
   EXPECTED_TABLE[2] = 1.0;
-  for (int i = 3; i < 13000; ++i) {
+  for (int i = 3; i < kTableSize; ++i) {
     // Simple log model: log2(n) * scaling
     EXPECTED_TABLE[i] = std::log2(static_cast<double>(i)) * 1.5;
     // This is a rough heuristic to minimize tree depth
   }
+  // --cost-model replaces it with a measured table (set_expected_costs).
 }
 
-HeuristicResult compute_heuristic(const SolverState &candidates, int guess_idx,
-                                  const PatternTable &table,
-                                  HeuristicType type) {
+void set_expected_costs(const CostModel &model) {
   std::call_once(tables_flag, init_tables);
+  for (int i = 0; i < kTableSize; ++i)
+    EXPECTED_TABLE[i] = model.at(i);
+}
 
-  std::array<int, 243> counts = {0};
+uint64_t expected_costs_hash() {
+  std::call_once(tables_flag, init_tables);
+  uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a
+  const auto *bytes = reinterpret_cast<const uint8_t *>(EXPECTED_TABLE.data());
+  for (size_t i = 0; i < EXPECTED_TABLE.size() * sizeof(double); ++i)
+    hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+  return hash;
+}
 
-  const auto &words = candidates.get_words();
-  size_t count = 0;
+uint32_t artifact_build_info(HeuristicType type) {
+  uint32_t info = static_cast<uint32_t>(type) + 1;
+  if (type == HeuristicType::MIN_EXPECTED) {
+    const uint64_t hash = expected_costs_hash();
+    info |= static_cast<uint32_t>(hash ^ (hash >> 32)) << 8;
+  }
+  return info;
+}
 
-  const uint8_t *pattern_row =
-      table.get_raw_table().data() + (guess_idx * table.num_solutions());
+namespace {
 
-  for (size_t i = 0; i < words.size(); ++i) {
-    uint64_t w = words[i];
-    if (w == 0)
-      continue;
+constexpr const char *kHeuristicNames[kNumHeuristics] = {
+    "entropy", "min_expected", "minimax", "expected_size", "most_parts"};
 
-    size_t base_idx = i * 64;
+// Marks a bucket as already visited while summing a partial histogram.
+constexpr uint32_t kVisited = 0x80000000u;
 
-    while (w) {
-      int bit = __builtin_ctzll(w);
-      size_t sol_idx = base_idx + bit;
+// Calls add(c) for every non-empty bucket of a histogram holding the first
+// `scanned` candidates. Small candidate sets touch few buckets, so we walk
+// the active list instead of all 3^L buckets. With `clear` the histogram is
+// zeroed on the way (it must then hold every candidate); otherwise it is
+// left as found.
+template <int L, class Pattern, class Add>
+void for_each_bucket(uint32_t *counts, const Pattern *row,
+                     const std::vector<int> &active, size_t scanned,
+                     bool clear, Add &&add) {
+  constexpr int kNumPatterns = WordTraits<L>::kNumPatterns;
+  if (scanned < static_cast<size_t>(kNumPatterns)) {
+    if (clear) {
+      for (size_t i = 0; i < scanned; ++i) {
+        uint32_t &c = counts[row[active[i]]];
+        if (c == 0)
+          continue;
+        add(c);
+        c = 0;
+      }
+      return;
+    }
+    for (size_t i = 0; i < scanned; ++i) {
+      uint32_t &c = counts[row[active[i]]];
+      if (c & kVisited)
+        continue;
+      add(c);
+      c |= kVisited;
+    }
+    for (size_t i = 0; i < scanned; ++i)
+      counts[row[active[i]]] &= ~kVisited;
+  } else {
+    for (int p = 0; p < kNumPatterns; ++p)
+      if (counts[p])
+        add(counts[p]);
+    if (clear)
+      std::memset(counts, 0, kNumPatterns * sizeof(uint32_t));
+  }
+}
 
-      counts[pattern_row[sol_idx]]++;
-      count++;
+// Folds one finished histogram into its scores and clears it for the next
+// block.
+template <int L, class Pattern = typename WordTraits<L>::Pattern>
+GuessStats reduce_histogram(uint32_t *counts, const Pattern *row,
+                            const std::vector<int> &active, double total) {
+  double sum_n_log_n = 0.0;
+  // The solved bucket is a singleton that needs no further guess.
+  double expected_sum = -(counts[WordTraits<L>::kSolvedPattern] / total) *
+                        EXPECTED_TABLE[1];
+  uint32_t max_bucket = 0;
+  for_each_bucket<L>(counts, row, active, active.size(), true,
+                     [&](uint32_t c) {
+                       sum_n_log_n += LOG_TABLE[c];
+                       expected_sum += (static_cast<double>(c) / total) *
+                                       EXPECTED_TABLE[c];
+                       max_bucket = std::max(max_bucket, c);
+                     });
+  return {std::log2(total) - (sum_n_log_n / total), 1.0 + expected_sum,
+          static_cast<int>(max_bucket)};
+}
 
-      w &= (w - 1);
-    }
+// Clears a histogram that holds the first `scanned` candidates.
+template <int L, class Pattern = typename WordTraits<L>::Pattern>
+void clear_histogram(uint32_t *counts, const Pattern *row,
+                     const std::vector<int> &active, size_t scanned) {
+  constexpr int kNumPatterns = WordTraits<L>::kNumPatterns;
+  if (scanned < kNumPatterns) {
+    for (size_t i = 0; i < scanned; ++i)
+      counts[row[active[i]]] = 0;
+  } else {
+    std::memset(counts, 0, kNumPatterns * sizeof(uint32_t));
   }
+}
 
-  double total = static_cast<double>(count);
-  if (total == 0)
-    return {0.0, 0};
+// Running totals of a histogram's buckets.
+struct Accumulator {
+  double sum = 0.0; // Sum of Policy::term over the buckets
+  uint32_t max_bucket = 0;
+  uint32_t parts = 0;
+  uint32_t solved = 0; // Size of the solved bucket so far, 0 or 1
+};
 
-  int max_bucket = 0;
-  double score = 0.0;
+// Per-bucket arithmetic of each heuristic. term() is one bucket's share of
+// the sum; score() is the final score from the totals, or, with `unseen`
+// candidates not scanned yet, the best score still reachable (the unseen
+// candidates each land in a fresh singleton bucket). Buckets only grow and
+// every term is increasing, which makes that a bound the kernel can prune on.
+template <HeuristicType H> struct Policy;
 
-  if (type == HeuristicType::ENTROPY) {
-    // Entropy = log2(N) - (1/N) * sum(n * log2(n))
-    double sum_n_log_n = 0.0;
+template <> struct Policy<HeuristicType::ENTROPY> {
+  static double term(uint32_t c, double) { return LOG_TABLE[c]; }
+  static double score(const Accumulator &a, double total, size_t) {
+    return std::log2(total) - a.sum / total;
+  }
+};
 
-    for (int c : counts) {
-      if (c > 0) {
-        sum_n_log_n += LOG_TABLE[c];
-        if (c > max_bucket)
-          max_bucket = c;
+template <> struct Policy<HeuristicType::MIN_EXPECTED> {
+  static double term(uint32_t c, double total) {
+    return (static_cast<double>(c) / total) * EXPECTED_TABLE[c];
+  }
+  // The solved bucket costs nothing more; calibrated tables have E(1) = 1.
+  static double score(const Accumulator &a, double total, size_t) {
+    return 1.0 + a.sum - (a.solved / total) * EXPECTED_TABLE[1];
+  }
+};
+
+// Sum(n^2) / N^2 lies in (0, 1], so as a tie-break it never reorders
+// different primary scores.
+template <> struct Policy<HeuristicType::MINIMAX> {
+  static double term(uint32_t c, double) { return double(c) * c; }
+  static double score(const Accumulator &a, double total, size_t unseen) {
+    return std::max<uint32_t>(a.max_bucket, unseen ? 1 : 0) +
+           (a.sum + unseen) / (total * total);
+  }
+};
+
+template <> struct Policy<HeuristicType::EXPECTED_SIZE> {
+  static double term(uint32_t c, double) { return double(c) * c; }
+  static double score(const Accumulator &a, double total, size_t unseen) {
+    return (a.sum + unseen) / total;
+  }
+};
+
+template <> struct Policy<HeuristicType::MOST_PARTS> {
+  static double term(uint32_t c, double) { return double(c) * c; }
+  static double score(const Accumulator &a, double total, size_t unseen) {
+    return a.parts + unseen - (a.sum + unseen) / (total * total);
+  }
+};
+
+template <HeuristicType H, int L, class Pattern>
+Accumulator accumulate(uint32_t *counts, const Pattern *row,
+                       const std::vector<int> &active, size_t scanned,
+                       double total, bool clear) {
+  Accumulator a;
+  a.solved = counts[WordTraits<L>::kSolvedPattern];
+  for_each_bucket<L>(counts, row, active, scanned, clear, [&](uint32_t c) {
+    a.sum += Policy<H>::term(c, total);
+    a.max_bucket = std::max(a.max_bucket, c);
+    ++a.parts;
+  });
+  return a;
+}
+
+// True if a guess whose histogram holds the first `scanned` candidates can
+// no longer beat the bound, or already breaks its bucket limit.
+template <HeuristicType H, int L, class Pattern>
+bool cannot_beat(uint32_t *counts, const Pattern *row,
+                 const std::vector<int> &active, size_t scanned, double total,
+                 const ScoreBound &bound) {
+  const Accumulator a =
+      accumulate<H, L>(counts, row, active, scanned, total, false);
+  if (bound.reject_above > 0 && a.max_bucket > (uint32_t)bound.reject_above)
+    return true;
+  double penalty = (bound.penalize_above > 0 &&
+                    a.max_bucket > (uint32_t)bound.penalize_above)
+                       ? bound.penalty
+                       : 0.0;
+
+  // Small slack so summation-order rounding never prunes a true tie.
+  constexpr double kSlack = 1e-9;
+  const double best = Policy<H>::score(a, total, active.size() - scanned);
+  if (Heuristic<H>::kMaximize)
+    return best - penalty < bound.threshold - kSlack;
+  return best + penalty > bound.threshold + kSlack;
+}
+
+// The blocked histogram scan behind every kernel. Each block of guesses
+// shares one pass over `active`; with `bounded`, prune(j, scanned) is asked
+// every quarter of the list (but not more often than every 16 candidates)
+// whether guess j of the block can be dropped, and a block stops early once
+// all of them are. finish(j, counts) reduces and clears a complete histogram;
+// drop(j) reports a pruned guess (its histogram is already cleared).
+template <int L, class Prune, class Finish, class Drop>
+void scan_guesses(const std::vector<int> &active, const int *guesses,
+                  size_t num_guesses, const BasicPatternTable<L> &table,
+                  bool bounded, Prune &&prune, Finish &&finish, Drop &&drop) {
+  using Pattern = typename WordTraits<L>::Pattern;
+  constexpr int kNumPatterns = WordTraits<L>::kNumPatterns;
+
+  const Pattern *raw = table.get_raw_table().data();
+  const size_t stride = table.num_solutions();
+  const int *idx = active.data();
+  const size_t n = active.size();
+
+  // One histogram per guess in the block. Every exit path leaves them zeroed,
+  // so the per-thread scratch never needs clearing between calls.
+  alignas(64) thread_local uint32_t counts[kGuessBlock][kNumPatterns] = {};
+  const Pattern *rows[kGuessBlock];
+
+  const size_t segment = bounded ? std::max<size_t>(n / 4, 16) : n;
+
+  auto scan = [&](size_t width, size_t from, size_t to) {
+    if (width == kGuessBlock) {
+      // Full block: fixed trip count lets the compiler unroll the inner loop
+      // and keep all row pointers in registers.
+      for (size_t i = from; i < to; ++i) {
+        const int s = idx[i];
+        for (size_t j = 0; j < kGuessBlock; ++j)
+          counts[j][rows[j][s]]++;
+      }
+    } else {
+      for (size_t i = from; i < to; ++i) {
+        const int s = idx[i];
+        for (size_t j = 0; j < width; ++j)
+          counts[j][rows[j][s]]++;
       }
     }
-    score = std::log2(total) - (sum_n_log_n / total);
-  } else {
-    // Min Expected Guesses
-    // Cost = 1 + Sum( (n/N) * E(n) )
-    // We want to MINIMIZE this.
-    double expected_sum = 0.0;
-    for (int c : counts) {
-      if (c > 0) {
-        expected_sum += (static_cast<double>(c) / total) * EXPECTED_TABLE[c];
-        if (c > max_bucket)
-          max_bucket = c;
+  };
+
+  for (size_t b = 0; b < num_guesses; b += kGuessBlock) {
+    const size_t width = std::min(kGuessBlock, num_guesses - b);
+    for (size_t j = 0; j < width; ++j)
+      rows[j] = raw + static_cast<size_t>(guesses[b + j]) * stride;
+
+    size_t scanned = 0;
+    uint32_t live = (1u << width) - 1;
+    while (scanned < n) {
+      size_t to = std::min(n, scanned + segment);
+      scan(width, scanned, to);
+      scanned = to;
+      if (scanned == n)
+        break;
+      for (size_t j = 0; j < width; ++j) {
+        if ((live >> j & 1u) && prune(counts[j], rows[j], scanned))
+          live &= ~(1u << j);
+      }
+      if (!live)
+        break;
+    }
+
+    for (size_t j = 0; j < width; ++j) {
+      if (scanned < n) {
+        clear_histogram<L>(counts[j], rows[j], active, scanned);
+        drop(b + j);
+      } else {
+        finish(b + j, counts[j], rows[j]);
       }
     }
-    score = 1.0 + expected_sum;
   }
+}
+
+} // namespace
+
+const char *heuristic_name(HeuristicType type) {
+  return kHeuristicNames[static_cast<int>(type)];
+}
+
+bool parse_heuristic(std::string_view name, HeuristicType &type) {
+  for (int i = 0; i < kNumHeuristics; ++i) {
+    if (name == kHeuristicNames[i]) {
+      type = static_cast<HeuristicType>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <int L>
+HeuristicResult compute_heuristic(const SolverState &candidates, int guess_idx,
+                                  const BasicPatternTable<L> &table,
+                                  HeuristicType type) {
+  const std::vector<int> active = candidates.get_active_indices();
+  return dispatch_heuristic(type, [&](auto h) {
+    PolicyScore s;
+    score_policy<L, decltype(h)::value>(active, &guess_idx, 1, table, &s);
+    return HeuristicResult{s.score, s.max_bucket};
+  });
+}
+
+template <int L>
+void score_guesses(const std::vector<int> &active, const int *guesses,
+                   size_t num_guesses, const BasicPatternTable<L> &table,
+                   GuessStats *out) {
+  std::call_once(tables_flag, init_tables);
+  if (active.empty()) {
+    std::fill(out, out + num_guesses, GuessStats{0.0, 0.0, 0});
+    return;
+  }
+  const double total = static_cast<double>(active.size());
+  scan_guesses<L>(
+      active, guesses, num_guesses, table, false,
+      [](uint32_t *, const auto *, size_t) { return false; },
+      [&](size_t i, uint32_t *counts, const auto *row) {
+        out[i] = reduce_histogram<L>(counts, row, active, total);
+      },
+      [](size_t) {});
+}
 
-  return {score, max_bucket};
+template <int L, HeuristicType H>
+void score_policy(const std::vector<int> &active, const int *guesses,
+                  size_t num_guesses, const BasicPatternTable<L> &table,
+                  PolicyScore *out, const ScoreBound *bound) {
+  std::call_once(tables_flag, init_tables);
+  if (active.empty()) {
+    std::fill(out, out + num_guesses, PolicyScore{0.0, 0});
+    return;
+  }
+  const double total = static_cast<double>(active.size());
+  scan_guesses<L>(
+      active, guesses, num_guesses, table, bound != nullptr,
+      [&](uint32_t *counts, const auto *row, size_t scanned) {
+        return cannot_beat<H, L>(counts, row, active, scanned, total, *bound);
+      },
+      [&](size_t i, uint32_t *counts, const auto *row) {
+        const Accumulator a =
+            accumulate<H, L>(counts, row, active, active.size(), total, true);
+        out[i] = PolicyScore{Policy<H>::score(a, total, 0),
+                             static_cast<int>(a.max_bucket)};
+      },
+      [&](size_t i) { out[i] = PolicyScore{0.0, 0, true}; });
 }
 
-} // namespace wordle
\ No newline at end of file
+template <int L>
+void score_boards(const std::vector<std::vector<int>> &boards,
+                  const int *guesses, size_t num_guesses,
+                  const BasicPatternTable<L> &table, JointStats *out) {
+  using Pattern = typename WordTraits<L>::Pattern;
+  constexpr int kNumPatterns = WordTraits<L>::kNumPatterns;
+  constexpr int kSolved = WordTraits<L>::kSolvedPattern;
+  std::call_once(tables_flag, init_tables);
+
+  const Pattern *raw = table.get_raw_table().data();
+  const size_t stride = table.num_solutions();
+
+  alignas(64) thread_local uint32_t counts[kGuessBlock][kNumPatterns] = {};
+  const Pattern *rows[kGuessBlock];
+
+  for (size_t b = 0; b < num_guesses; b += kGuessBlock) {
+    const size_t width = std::min(kGuessBlock, num_guesses - b);
+    for (size_t j = 0; j < width; ++j) {
+      rows[j] = raw + static_cast<size_t>(guesses[b + j]) * stride;
+      out[b + j] = JointStats{0.0, 0.0, 0.0, 0};
+    }
+
+    for (const auto &active : boards) {
+      if (active.empty())
+        continue;
+      const double total = static_cast<double>(active.size());
+      for (int s : active)
+        for (size_t j = 0; j < width; ++j)
+          counts[j][rows[j][s]]++;
+
+      for (size_t j = 0; j < width; ++j) {
+        // At most one candidate can match the guess exactly.
+        const double solve = counts[j][kSolved] / total;
+        GuessStats g = reduce_histogram<L>(counts[j], rows[j], active, total);
+        JointStats &o = out[b + j];
+        o.entropy += g.entropy;
+        o.expected_cost += g.expected_cost;
+        o.solve_chance += solve;
+        o.max_bucket = std::max(o.max_bucket, g.max_bucket);
+      }
+    }
+  }
+}
+
+#define WORDLE_INSTANTIATE_POLICY(L, H)                                       \
+  template void score_policy<L, H>(const std::vector<int> &, const int *,      \
+                                   size_t, const BasicPatternTable<L> &,       \
+                                   PolicyScore *, const ScoreBound *);
+
+#define WORDLE_INSTANTIATE_ENTROPY(L)                                         \
+  template HeuristicResult compute_heuristic<L>(                               \
+      const SolverState &, int, const BasicPatternTable<L> &, HeuristicType);  \
+  template void score_guesses<L>(const std::vector<int> &, const int *,        \
+                                 size_t, const BasicPatternTable<L> &,         \
+                                 GuessStats *);                                \
+  WORDLE_INSTANTIATE_POLICY(L, HeuristicType::ENTROPY)                         \
+  WORDLE_INSTANTIATE_POLICY(L, HeuristicType::MIN_EXPECTED)                    \
+  WORDLE_INSTANTIATE_POLICY(L, HeuristicType::MINIMAX)                         \
+  WORDLE_INSTANTIATE_POLICY(L, HeuristicType::EXPECTED_SIZE)                   \
+  WORDLE_INSTANTIATE_POLICY(L, HeuristicType::MOST_PARTS)                      \
+  template void score_boards<L>(const std::vector<std::vector<int>> &,         \
+                                const int *, size_t,                           \
+                                const BasicPatternTable<L> &, JointStats *);
+
+WORDLE_INSTANTIATE_ENTROPY(4)
+WORDLE_INSTANTIATE_ENTROPY(5)
+WORDLE_INSTANTIATE_ENTROPY(6)
+WORDLE_INSTANTIATE_ENTROPY(7)
+WORDLE_INSTANTIATE_ENTROPY(8)
+
+} // namespace wordle
@@ -1,18 +1,181 @@
 #pragma once
 #include "libwordle_core/patterntable.h"
 #include "state.h"
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace wordle {
 
-enum class HeuristicType { ENTROPY, MIN_EXPECTED };
+enum class HeuristicType {
+  ENTROPY,       // Shannon entropy of the partition (maximized)
+  MIN_EXPECTED,  // 1 + Sum((n/N) * E(n)), estimated guesses (minimized)
+  MINIMAX,       // Largest bucket, ties by expected bucket size (minimized)
+  EXPECTED_SIZE, // Sum(n^2) / N, expected candidates left (minimized)
+  MOST_PARTS,    // Non-empty buckets, ties by expected size (maximized)
+};
+constexpr int kNumHeuristics = 5;
+
+struct CostModel;
+
+// Scores min_expected with a calibrated E(n) (see costmodel.h) instead of
+// the built-in log2 estimate. Call before any scoring starts.
+void set_expected_costs(const CostModel &model);
+
+// Hash of the E(n) table min_expected scores with, so that builds which
+// must agree on it (distributed workers, --base seeding) can check.
+uint64_t expected_costs_hash();
+
+// ArtifactHeader::build_info for a tree built with `type` under the current
+// cost table. Only min_expected depends on the table.
+uint32_t artifact_build_info(HeuristicType type);
+
+// "entropy", "min_expected", "minimax", "expected_size", "most_parts".
+const char *heuristic_name(HeuristicType type);
+bool parse_heuristic(std::string_view name, HeuristicType &type);
+
+// Compile-time properties of each heuristic. The per-bucket arithmetic is
+// specialized alongside the kernel in entropy.cpp.
+template <HeuristicType H> struct Heuristic;
+template <> struct Heuristic<HeuristicType::ENTROPY> {
+  static constexpr bool kMaximize = true;
+  // Raised to log2(3^L) + 1 bits where that is larger (7 and 8 letters),
+  // so a penalised guess always ranks below an unpenalised one.
+  static constexpr double kPenalty = 10.0;
+};
+template <> struct Heuristic<HeuristicType::MIN_EXPECTED> {
+  static constexpr bool kMaximize = false;
+  static constexpr double kPenalty = 10.0;
+};
+// The remaining scores grow with the candidate count, so their depth-rule
+// penalty has to outweigh any score.
+template <> struct Heuristic<HeuristicType::MINIMAX> {
+  static constexpr bool kMaximize = false;
+  static constexpr double kPenalty = 1e9;
+};
+template <> struct Heuristic<HeuristicType::EXPECTED_SIZE> {
+  static constexpr bool kMaximize = false;
+  static constexpr double kPenalty = 1e9;
+};
+template <> struct Heuristic<HeuristicType::MOST_PARTS> {
+  static constexpr bool kMaximize = true;
+  static constexpr double kPenalty = 1e9;
+};
+
+template <HeuristicType H>
+using HeuristicTag = std::integral_constant<HeuristicType, H>;
+
+// Calls f(HeuristicTag<H>{}) for the runtime `type`, so a caller switches
+// once and runs a loop specialized for H.
+template <class F> decltype(auto) dispatch_heuristic(HeuristicType type, F &&f) {
+  switch (type) {
+  case HeuristicType::MIN_EXPECTED:
+    return f(HeuristicTag<HeuristicType::MIN_EXPECTED>{});
+  case HeuristicType::MINIMAX:
+    return f(HeuristicTag<HeuristicType::MINIMAX>{});
+  case HeuristicType::EXPECTED_SIZE:
+    return f(HeuristicTag<HeuristicType::EXPECTED_SIZE>{});
+  case HeuristicType::MOST_PARTS:
+    return f(HeuristicTag<HeuristicType::MOST_PARTS>{});
+  default:
+    return f(HeuristicTag<HeuristicType::ENTROPY>{});
+  }
+}
+
+inline bool higher_is_better(HeuristicType type) {
+  return dispatch_heuristic(
+      type, [](auto h) { return Heuristic<decltype(h)::value>::kMaximize; });
+}
 
 struct HeuristicResult {
-  double score; // Higher is better for Entropy, Lower is better for Expected
+  double score; // Better is higher or lower, per Heuristic<H>::kMaximize
   int max_bucket;
 };
 
+// Scores a single guess against a candidate bitset under `type`.
+template <int L>
 HeuristicResult compute_heuristic(const SolverState &candidates, int guess_idx,
-                                  const PatternTable &table,
+                                  const BasicPatternTable<L> &table,
                                   HeuristicType type);
 
+// All scores the batched kernel produces for one guess.
+struct GuessStats {
+  double entropy;       // Shannon entropy of the partition (bits)
+  double expected_cost; // 1 + Sum((n/N) * E(n))
+  int max_bucket;
+  bool pruned = false; // Abandoned mid-scan; scores are not meaningful
+};
+
+// Early-exit parameters for score_policy. The kernel checks partial
+// histograms at a few points during the scan and abandons a block once every
+// guess in it provably cannot beat `threshold`, or breaks a hard bucket limit.
+struct ScoreBound {
+  // Score to beat (after penalties): the current K-th best.
+  double threshold = 0.0;
+  // Reject outright once any bucket grows past this size (0 = no limit).
+  int reject_above = 0;
+  // Apply `penalty` once any bucket grows past this size (0 = never).
+  int penalize_above = 0;
+  double penalty = 0.0;
+};
+
+// Number of guesses whose histograms are built together in one scan.
+constexpr size_t kGuessBlock = 8;
+
+// Batched kernel: scores `num_guesses` guesses against the same candidate set.
+// `active` is the decoded list of candidate solution indices, so callers pay
+// for the bitset walk once per state instead of once per guess. Guesses are
+// processed in blocks of kGuessBlock that share a single pass over `active`.
+// Instantiated for word lengths 4-8; each length gets its own histogram width
+// and pattern type at compile time. Reports entropy and expected cost
+// together, for ranking and reports.
+template <int L>
+void score_guesses(const std::vector<int> &active, const int *guesses,
+                   size_t num_guesses, const BasicPatternTable<L> &table,
+                   GuessStats *out);
+
+// One heuristic's score for a guess.
+struct PolicyScore {
+  double score;
+  int max_bucket;
+  bool pruned = false; // Abandoned mid-scan; the score is not meaningful
+};
+
+// The same kernel computing only heuristic H, which the builder's beam
+// search uses. With a `bound`, blocks that cannot beat it are abandoned and
+// reported as pruned. Each (L, H) pair is its own instantiation, so a
+// policy's bucket arithmetic is inlined into the scan and adding one leaves
+// the others' loops untouched.
+template <int L, HeuristicType H>
+void score_policy(const std::vector<int> &active, const int *guesses,
+                  size_t num_guesses, const BasicPatternTable<L> &table,
+                  PolicyScore *out, const ScoreBound *bound = nullptr);
+
+// Joint scores of one guess over several boards (multi-board variants). The
+// hidden words are independent, so the entropy of the feedback tuple is the
+// sum of the per-board entropies.
+struct JointStats {
+  double entropy;       // Sum of per-board entropies (bits)
+  double expected_cost; // Sum of per-board expected costs
+  double solve_chance;  // Sum over boards of P(guess is that board's word)
+  int max_bucket;       // Largest bucket on any board
+};
+
+// Scores guesses against every board in `boards` (decoded candidate lists;
+// empty boards are skipped). Each block of guesses loads its pattern rows once
+// and sweeps all boards with them, so rows are read in a single pass however
+// many boards there are.
+template <int L>
+void score_boards(const std::vector<std::vector<int>> &boards,
+                  const int *guesses, size_t num_guesses,
+                  const BasicPatternTable<L> &table, JointStats *out);
+
+// Ranking score for multi-board search: the single-board score credited with
+// the chance of finishing a board outright (higher is better for entropy,
+// lower for expected cost).
+inline double joint_score(const JointStats &s, HeuristicType type) {
+  return type == HeuristicType::ENTROPY ? s.entropy + s.solve_chance
+                                        : s.expected_cost - s.solve_chance;
+}
+
 } // namespace wordle
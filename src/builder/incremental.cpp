@@ -0,0 +1,260 @@
+#include "incremental.h"
+#include "builder.h"
+#include "libwordle_core/artifact.h"
+#include "libwordle_core/pattern.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace wordle {
+
+namespace {
+
+// Index of `word` in the sorted `list`, or -1.
+template <class List> int find_word(const List &list, std::string_view word) {
+  auto it = std::lower_bound(list.begin(), list.end(), word);
+  return it != list.end() && *it == word ? static_cast<int>(it - list.begin())
+                                         : -1;
+}
+
+struct BaseArtifact {
+  std::vector<uint8_t> bytes;
+  ArtifactHeader header;
+  const ArtifactNode *nodes = nullptr;
+  const uint32_t *children = nullptr;
+  std::vector<std::string> guesses;
+  std::vector<std::string> solutions;
+};
+
+// Reads a v3 artifact with embedded word tables and checks every section
+// against the file size.
+bool read_base(const std::string &path, size_t word_length,
+               HeuristicType heuristic, BaseArtifact &base) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    std::cerr << "Failed to open base artifact: " << path << std::endl;
+    return false;
+  }
+  base.bytes.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+
+  ArtifactHeader &h = base.header;
+  if (base.bytes.size() < sizeof(ArtifactHeader)) {
+    std::cerr << "Base artifact too small for header: " << path << std::endl;
+    return false;
+  }
+  std::memcpy(&h, base.bytes.data(), sizeof(ArtifactHeader));
+  if (h.magic != kArtifactMagic || h.version != kArtifactVersion) {
+    std::cerr << "Invalid base artifact (magic/version): " << path
+              << std::endl;
+    return false;
+  }
+  if (!(h.flags & kArtifactHasWords)) {
+    std::cerr << "Base artifact has no word tables to diff against (build it "
+                 "with --embed-words): "
+              << path << std::endl;
+    return false;
+  }
+  if (h.word_length != word_length ||
+      h.num_patterns != static_cast<uint32_t>(num_patterns(word_length))) {
+    std::cerr << "Base artifact is for " << h.word_length
+              << "-letter words: " << path << std::endl;
+    return false;
+  }
+  // Seeded subtrees are only what a full build would pick if the base was
+  // scored the same way.
+  const uint32_t build_info = artifact_build_info(heuristic);
+  if (h.build_info != build_info) {
+    if (h.build_info == 0)
+      std::cerr << "Base artifact does not record its heuristic (rebuild it "
+                   "from scratch once): ";
+    else if ((h.build_info & 0xFF) != (build_info & 0xFF))
+      std::cerr << "Base artifact was built with a different heuristic "
+                   "than --heuristic "
+                << heuristic_name(heuristic) << ": ";
+    else
+      std::cerr << "Base artifact was built with a different min_expected "
+                   "cost table (--cost-model): ";
+    std::cerr << path << std::endl;
+    return false;
+  }
+
+  const size_t nodes_end =
+      sizeof(ArtifactHeader) + static_cast<size_t>(h.num_nodes) *
+                                   (sizeof(ArtifactNode) +
+                                    h.num_patterns * sizeof(uint32_t));
+  const size_t words_end =
+      h.words_offset +
+      (2 * static_cast<size_t>(h.num_guesses) + h.num_solutions) * word_length;
+  if (h.num_nodes == 0 || h.root_index >= h.num_nodes ||
+      h.words_offset < nodes_end || words_end > base.bytes.size()) {
+    std::cerr << "Base artifact sections out of bounds: " << path
+              << std::endl;
+    return false;
+  }
+
+  const uint8_t *data = base.bytes.data();
+  base.nodes =
+      reinterpret_cast<const ArtifactNode *>(data + sizeof(ArtifactHeader));
+  base.children = reinterpret_cast<const uint32_t *>(
+      data + sizeof(ArtifactHeader) + h.num_nodes * sizeof(ArtifactNode));
+
+  const char *text = reinterpret_cast<const char *>(data + h.words_offset);
+  for (size_t i = 0; i < h.num_guesses; ++i)
+    base.guesses.emplace_back(text + i * word_length, word_length);
+  const uint8_t *packed =
+      data + h.words_offset + 2 * static_cast<size_t>(h.num_guesses) *
+                                  word_length;
+  for (size_t i = 0; i < h.num_solutions; ++i) {
+    std::string word(word_length, 'a');
+    for (size_t c = 0; c < word_length; ++c)
+      word[c] = static_cast<char>('a' + packed[i * word_length + c]);
+    base.solutions.push_back(std::move(word));
+  }
+  return true;
+}
+
+class Seeder {
+public:
+  Seeder(const BaseArtifact &base, const WordList &words, Memo &memo,
+         BaseStats &stats)
+      : base_(base), words_(words), memo_(memo), stats_(stats),
+        reused_(base.header.num_nodes, false),
+        old_names_(base.solutions.begin(), base.solutions.end()) {
+    for (const auto &g : base.guesses) {
+      guess_map_.push_back(find_word(words.get_guesses(), g));
+      stats.missing_guesses += guess_map_.back() < 0;
+    }
+    for (const auto &s : base.solutions) {
+      solution_map_.push_back(find_word(words.get_solutions(), s));
+      stats.removed += solution_map_.back() < 0;
+    }
+    std::vector<std::string_view> sorted_old = old_names_;
+    std::sort(sorted_old.begin(), sorted_old.end());
+    for (auto s : words.get_solutions())
+      stats.added += find_word(sorted_old, s) < 0;
+  }
+
+  void run() {
+    std::vector<int> olds(base_.solutions.size());
+    std::vector<int> news(words_.get_solutions().size());
+    for (size_t i = 0; i < olds.size(); ++i)
+      olds[i] = static_cast<int>(i);
+    for (size_t i = 0; i < news.size(); ++i)
+      news[i] = static_cast<int>(i);
+    walk(base_.header.root_index, 0, olds, news);
+    stats_.reused_nodes = std::count(reused_.begin(), reused_.end(), true);
+  }
+
+private:
+  using Bucket = std::vector<std::pair<uint16_t, int>>;
+
+  // Sorts the words of `set` by their pattern against `guess`.
+  static Bucket partition(std::string_view guess, const std::vector<int> &set,
+                          const std::vector<std::string_view> &names) {
+    Bucket out;
+    out.reserve(set.size());
+    for (int i : set)
+      out.emplace_back(calc_pattern(guess, names[i]), i);
+    std::sort(out.begin(), out.end());
+    return out;
+  }
+
+  // Returns the node remapped to the new lists if its whole subtree can be
+  // reused, nullptr otherwise. `olds` and `news` are the old and new
+  // solutions that reach this node.
+  std::shared_ptr<MemoryNode> walk(uint32_t index, int depth,
+                                   const std::vector<int> &olds,
+                                   const std::vector<int> &news) {
+    if (index >= base_.header.num_nodes || depth >= kMaxGuesses)
+      return nullptr;
+    const ArtifactNode &an = base_.nodes[index];
+    if (an.guess_index >= base_.guesses.size())
+      return nullptr;
+
+    // Every old word that survives reaches this node under the new lists
+    // too, so equal sizes with nothing removed means equal sets.
+    const int guess = guess_map_[an.guess_index];
+    bool clean = guess >= 0 && olds.size() == news.size();
+    for (int o : olds)
+      clean = clean && solution_map_[o] >= 0;
+
+    auto node = std::make_shared<MemoryNode>();
+    node->guess_index = static_cast<uint16_t>(guess);
+    node->is_leaf = (an.flags & 1) != 0;
+
+    if (!node->is_leaf) {
+      const std::string &word = base_.guesses[an.guess_index];
+      Bucket old_parts = partition(word, olds, old_names_);
+      Bucket new_parts = partition(word, news, words_.get_solutions());
+
+      const uint32_t *row =
+          base_.children + static_cast<size_t>(index) *
+                               base_.header.num_patterns;
+      auto o = old_parts.begin(), n = new_parts.begin();
+      std::vector<int> child_olds, child_news;
+      while (n != new_parts.end()) {
+        const uint16_t p = n->first;
+        child_olds.clear();
+        child_news.clear();
+        for (; n != new_parts.end() && n->first == p; ++n)
+          child_news.push_back(n->second);
+        while (o != old_parts.end() && o->first < p)
+          ++o;
+        for (; o != old_parts.end() && o->first == p; ++o)
+          child_olds.push_back(o->second);
+
+        if (p == solved_pattern(words_.word_length()))
+          continue;
+        if (row[p] == kNoChild) {
+          clean = false; // A new word the old tree never split off.
+          continue;
+        }
+        auto child = walk(row[p], depth + 1, child_olds, child_news);
+        if (!child)
+          clean = false;
+        else if (clean)
+          node->children.emplace_back(p, child);
+      }
+    }
+
+    if (!clean)
+      return nullptr;
+    reused_[index] = true;
+    if (depth > 0 && news.size() > 1) {
+      SolverState state(words_.get_solutions().size());
+      for (int s : news)
+        state.set(s);
+      memo_.insert(MemoKey{state, kMaxGuesses - depth}, node);
+      ++stats_.seeded;
+    }
+    return node;
+  }
+
+  const BaseArtifact &base_;
+  const WordList &words_;
+  Memo &memo_;
+  BaseStats &stats_;
+  std::vector<bool> reused_;
+  std::vector<std::string_view> old_names_;
+  std::vector<int> guess_map_;    // Old guess index -> new, or -1
+  std::vector<int> solution_map_; // Old solution index -> new, or -1
+};
+
+} // namespace
+
+BaseStats seed_from_base(const std::string &path, const WordList &words,
+                         HeuristicType heuristic, Memo &memo) {
+  BaseStats stats;
+  BaseArtifact base;
+  if (!read_base(path, words.word_length(), heuristic, base))
+    return stats;
+  stats.base_nodes = base.header.num_nodes;
+  Seeder(base, words, memo, stats).run();
+  stats.valid = true;
+  return stats;
+}
+
+} // namespace wordle
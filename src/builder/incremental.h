@@ -0,0 +1,36 @@
+#pragma once
+#include "entropy.h"
+#include "libwordle_core/wordlist.h"
+#include "memo.h"
+#include <string>
+
+namespace wordle {
+
+struct BaseStats {
+  bool valid = false;
+  size_t removed = 0;        // Old solutions missing from the new list
+  size_t added = 0;          // New solutions missing from the old list
+  size_t missing_guesses = 0; // Old guesses missing from the new list
+  size_t base_nodes = 0;     // Nodes in the old artifact
+  size_t reused_nodes = 0;   // Of those, inside a seeded subtree
+  size_t seeded = 0;         // Subtrees inserted into the memo
+};
+
+// Seeds `memo` with every subtree of an earlier artifact that is still an
+// answer for the current lists. The artifact must embed its word tables
+// (--embed-words) so the old lists can be diffed against `words`.
+//
+// Old and new solutions are played down the old tree side by side. A node
+// below the root whose candidate set is the same under both lists (no
+// removed or added words reach it) and whose subtree only uses guesses still
+// in the list is reused as is; guess indices are remapped. The builder then
+// re-solves only the dirty states, from the root down, and finds everything
+// else in the memo. When only the solutions changed the result is the tree a
+// full build would produce. The base must have been built with the same
+// heuristic and, for min_expected, the same cost table; both are checked
+// against the header's build_info. The root is always re-solved, so the
+// start word may change.
+BaseStats seed_from_base(const std::string &path, const WordList &words,
+                         HeuristicType heuristic, Memo &memo);
+
+} // namespace wordle
@@ -1,76 +1,361 @@
 #include "builder.h"
+#include "checkpoint.h"
+#include "costmodel.h"
+#include "distributed.h"
+#include "incremental.h"
+#include "libwordle_core/artifact.h"
 #include "libwordle_core/patterntable.h"
+#include "libwordle_core/perfcounters.h"
 #include "libwordle_core/wordlist.h"
+#include "memo_store.h"
+#include "multiboard.h"
+#include "refine.h"
+#include "sweep.h"
 #include "verify.h"
 #include "writer.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
 #include <chrono>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
-int main(int argc, char **argv) {
-  std::string s_path, g_path, out_path;
-  // Default to "trace" (avg 3.605) instead of "reast" (avg 3.602) because
-  // "trace" is a valid solution, offering a chance for a 1-guess win.
-  std::string start_word = "trace";
-  bool run_verify = false;
-  std::string single_list_path;
-  wordle::HeuristicType heuristic = wordle::HeuristicType::ENTROPY;
+namespace {
 
-  for (int i = 1; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "--solutions" && i + 1 < argc)
-      s_path = argv[++i];
-    else if (arg == "--guesses" && i + 1 < argc)
-      g_path = argv[++i];
-    else if (arg == "--output" && i + 1 < argc)
-      out_path = argv[++i];
-    else if (arg == "--start-word" && i + 1 < argc)
-      start_word = argv[++i];
-    else if (arg == "--single-list" && i + 1 < argc)
-      single_list_path = argv[++i];
-    else if (arg == "--heuristic" && i + 1 < argc) {
-      std::string h = argv[++i];
-      if (h == "min_expected")
-        heuristic = wordle::HeuristicType::MIN_EXPECTED;
-      else if (h == "entropy")
-        heuristic = wordle::HeuristicType::ENTROPY;
-      else {
-        std::cerr << "Unknown heuristic: " << h
-                  << " (use 'entropy' or 'min_expected')" << std::endl;
+bool parse_heuristic_arg(const std::string &name,
+                         wordle::HeuristicType &out) {
+  if (wordle::parse_heuristic(name, out))
+    return true;
+  std::cerr << "Unknown heuristic: " << name
+            << " (use entropy, min_expected, minimax, expected_size or "
+               "most_parts)"
+            << std::endl;
+  return false;
+}
+
+// Parses a whole decimal option value into `out`. Each option's range is
+// checked after parsing; this rejects what std::stoi would throw on, values
+// that do not fit `Int` and negative values for unsigned options.
+template <class Int>
+bool parse_int_arg(const std::string &option, const std::string &value,
+                   Int &out) {
+  char *end = nullptr;
+  errno = 0;
+  const long long n = std::strtoll(value.c_str(), &end, 10);
+  const char first = value.empty() ? '\0' : value[0];
+  if ((first != '-' && !std::isdigit(static_cast<unsigned char>(first))) ||
+      *end != '\0' || errno == ERANGE ||
+      n < static_cast<long long>(std::numeric_limits<Int>::min()) ||
+      static_cast<unsigned long long>(n) >
+          static_cast<unsigned long long>(std::numeric_limits<Int>::max())) {
+    std::cerr << "Invalid " << option << ": " << value << std::endl;
+    return false;
+  }
+  out = static_cast<Int>(n);
+  return true;
+}
+
+// One --bundle-trees entry, "opener:heuristic". An empty opener lets the
+// heuristic pick the root guess.
+struct BundleSpec {
+  std::string opener;
+  std::string heuristic_name;
+  wordle::HeuristicType heuristic;
+};
+
+bool parse_bundle_trees(const std::string &spec,
+                        std::vector<BundleSpec> &out) {
+  size_t begin = 0;
+  while (begin <= spec.size()) {
+    size_t end = spec.find(',', begin);
+    if (end == std::string::npos)
+      end = spec.size();
+    std::string item = spec.substr(begin, end - begin);
+    size_t colon = item.find(':');
+    BundleSpec tree;
+    tree.opener = item.substr(0, colon);
+    tree.heuristic_name =
+        colon == std::string::npos ? "entropy" : item.substr(colon + 1);
+    if (!parse_heuristic_arg(tree.heuristic_name, tree.heuristic))
+      return false;
+    if (tree.opener.size() >= sizeof(wordle::BundleTree::opener)) {
+      std::cerr << "Bundle opener too long: " << tree.opener << std::endl;
+      return false;
+    }
+    out.push_back(tree);
+    begin = end + 1;
+  }
+  return !out.empty();
+}
+
+struct Options {
+  std::string out_path;
+  std::string start_word;
+  wordle::HeuristicType heuristic;
+  std::string sweep_spec, sweep_output;
+  std::string memo_store_path;
+  unsigned int num_threads;
+  int num_boards;
+  int max_guesses;
+  bool embed_words;
+  bool embed_ranges;
+  std::string emit_cpp_path;
+  std::string verify_artifact_path;
+  std::string base_path;
+  std::string checkpoint_path;
+  int checkpoint_interval;
+  wordle::PerfPhases *perf; // Null unless --perf-json
+  std::string bundle_path;
+  std::vector<BundleSpec> bundle_trees;
+  int refine_seconds;
+  std::string calibrate_path;
+  std::string calibrate_openers;
+  int calibrate_rounds;
+  int distribute_port; // -1 unless --distribute
+  int local_workers;
+  std::vector<std::string> worker_command; // Runs a local worker
+  std::string worker_address;
+};
+
+// Charges what follows to the named phase when counters are on.
+void enter_phase(const Options &opts, const char *name) {
+  if (opts.perf)
+    opts.perf->enter(opts.perf->phase(name));
+}
+
+// --refine-seconds: spends the budget improving a verified tree.
+template <int L>
+std::shared_ptr<wordle::MemoryNode>
+refine(const Options &opts, std::shared_ptr<wordle::MemoryNode> root,
+       const wordle::WordList &words,
+       const wordle::BasicPatternTable<L> &table) {
+  if (opts.refine_seconds <= 0)
+    return root;
+  enter_phase(opts, "refine");
+  wordle::RefineStats stats;
+  root = wordle::refine_tree<L>(root, words, table,
+                                std::chrono::seconds(opts.refine_seconds),
+                                opts.num_threads, stats);
+  const double n = static_cast<double>(words.get_solutions().size());
+  std::cout << "Refine: " << stats.passes << " passes, " << stats.searched
+            << " subtrees re-solved, " << stats.improved
+            << " improved; average " << stats.guesses_before / n << " -> "
+            << stats.guesses_after / n
+            << (stats.timed_out ? " (budget used)" : " (exhaustive)")
+            << std::endl;
+  return root;
+}
+
+// Joint tree for several boards sharing every guess.
+template <int L>
+int run_multi(const Options &opts, const wordle::WordList &words,
+              const wordle::BasicPatternTable<L> &table) {
+  wordle::MultiBuilder<L> builder(words, table, opts.num_boards,
+                                  opts.max_guesses, opts.start_word,
+                                  opts.heuristic);
+  std::cout << "Building " << opts.num_boards << "-board Tree (Start: "
+            << opts.start_word << ", Max Guesses: " << opts.max_guesses
+            << ")..." << std::endl;
+  auto start = std::chrono::high_resolution_clock::now();
+  auto root = builder.build();
+  auto end = std::chrono::high_resolution_clock::now();
+  std::cout << "Build time: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(end -
+                                                                     start)
+                   .count()
+            << "ms (" << builder.memo_size() << " memoized states)"
+            << std::endl;
+
+  if (!root) {
+    std::cout << "Failed to build tree." << std::endl;
+    return 1;
+  }
+
+  enter_phase(opts, "verify");
+  if (!wordle::verify_multi_tree(root, words, opts.num_boards,
+                                 opts.max_guesses)) {
+    std::cerr << "Tree verification failed! Aborting write." << std::endl;
+    return 1;
+  }
+
+  if (!opts.out_path.empty()) {
+    std::cout << "Writing to " << opts.out_path << "..." << std::endl;
+    enter_phase(opts, "writing");
+    if (!wordle::write_multi_solution(opts.out_path, root, words,
+                                      opts.num_boards, opts.max_guesses)) {
+      std::cerr << "Failed to write " << opts.out_path << std::endl;
+      return 1;
+    }
+    std::cout << "Successfully wrote " << opts.out_path << std::endl;
+  }
+  return 0;
+}
+
+// Several single-board trees for the same lists, written as one bundle.
+// Trees with the same heuristic share a memo, as in an opener sweep.
+template <int L>
+int run_bundle(const Options &opts, const wordle::WordList &words,
+               const wordle::BasicPatternTable<L> &table) {
+  std::shared_ptr<wordle::Memo> memos[wordle::kNumHeuristics];
+  std::vector<wordle::BundleEntry> trees;
+  for (const auto &spec : opts.bundle_trees) {
+    enter_phase(opts, "recursion");
+    auto &memo = memos[static_cast<int>(spec.heuristic)];
+    if (!memo)
+      memo = std::make_shared<wordle::Memo>();
+    wordle::BasicBuilder<L> builder(words, table, spec.opener, spec.heuristic,
+                                    memo);
+    if (opts.perf)
+      builder.set_perf(opts.perf);
+    auto start = std::chrono::high_resolution_clock::now();
+    auto root = builder.build();
+    auto end = std::chrono::high_resolution_clock::now();
+    if (!root) {
+      std::cout << "Failed to build tree " << spec.opener << ":"
+                << spec.heuristic_name << "." << std::endl;
+      return 1;
+    }
+    root = refine<L>(opts, root, words, table);
+
+    enter_phase(opts, "verify");
+    const std::string opener(words.get_guesses()[root->guess_index]);
+    auto stats = wordle::evaluate_tree(root, words);
+    std::cout << "Tree " << opener << "/" << spec.heuristic_name << ": "
+              << (stats.valid ? "average " : "INVALID, average ")
+              << stats.average << ", max depth " << stats.max_depth << " ("
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end -
+                                                                       start)
+                     .count()
+              << "ms)" << std::endl;
+    if (!stats.valid) {
+      std::cerr << "Tree verification failed! Aborting write." << std::endl;
+      return 1;
+    }
+    for (const auto &tree : trees)
+      if (tree.opener == opener && tree.heuristic == spec.heuristic_name) {
+        std::cerr << "Duplicate bundle tree " << opener << "/"
+                  << spec.heuristic_name << std::endl;
         return 1;
       }
-    } else if (arg == "--verify")
-      run_verify = true;
+    trees.push_back({opener, spec.heuristic_name, root});
   }
 
-  if (!single_list_path.empty()) {
-    s_path = single_list_path;
-    g_path = single_list_path;
+  std::cout << "Writing bundle to " << opts.bundle_path << "..." << std::endl;
+  enter_phase(opts, "writing");
+  if (!wordle::write_bundle(opts.bundle_path, trees, words,
+                            opts.embed_words)) {
+    std::cerr << "Failed to write " << opts.bundle_path << std::endl;
+    return 1;
   }
+  enter_phase(opts, "verify");
+  return wordle::report_bundle(opts.bundle_path,
+                               wordle::verify_bundle<L>(opts.bundle_path,
+                                                        words,
+                                                        opts.num_threads))
+             ? 0
+             : 1;
+}
 
-  if (s_path.empty() || g_path.empty()) {
-    std::cerr << "Usage: " << argv[0]
-              << " (--solutions <path> --guesses <path> | --single-list "
-                 "<path>) [--output <path>] [--start-word <word>] [--heuristic "
-                 "entropy|min_expected] [--verify]"
-              << std::endl;
-    return 1;
+// --calibrate: builds trees, measures the guesses they actually spend per
+// candidate-set size, and fits min_expected's cost table to them. The first
+// round builds with --heuristic (and --cost-model, if given); each further
+// round rebuilds with min_expected on the table just fitted and measures
+// again.
+template <int L>
+int run_calibrate(const Options &opts, const wordle::WordList &words,
+                  const wordle::BasicPatternTable<L> &table) {
+  std::vector<std::string> openers{opts.start_word};
+  if (!opts.calibrate_openers.empty()) {
+    openers.clear();
+    if (!wordle::resolve_sweep_openers<L>(opts.calibrate_openers, words,
+                                          table, openers))
+      return 1;
   }
 
-  wordle::WordList words;
-  if (!words.load(s_path, g_path))
+  wordle::CostModel model;
+  wordle::CostSamples samples;
+  for (int round = 1; round <= opts.calibrate_rounds; ++round) {
+    const wordle::HeuristicType heuristic =
+        round == 1 ? opts.heuristic : wordle::HeuristicType::MIN_EXPECTED;
+    if (round > 1)
+      wordle::set_expected_costs(model);
+    // Subtrees depend on the table, so every round starts a fresh memo.
+    auto memo = std::make_shared<wordle::Memo>();
+    samples = wordle::CostSamples();
+    double sum = 0.0;
+    for (const auto &opener : openers) {
+      enter_phase(opts, "recursion");
+      wordle::BasicBuilder<L> builder(words, table, opener, heuristic, memo);
+      auto root = builder.build();
+      if (!root) {
+        std::cerr << "Failed to build tree for " << opener << std::endl;
+        return 1;
+      }
+      enter_phase(opts, "calibrate");
+      auto stats = wordle::evaluate_tree(root, words);
+      wordle::sample_costs<L>(root, words, table, samples);
+      std::cout << "  " << words.get_guesses()[root->guess_index] << ": "
+                << stats.average << std::endl;
+      sum += stats.average;
+    }
+    model = wordle::fit_cost_model(samples);
+    std::cout << "Round " << round << " ("
+              << wordle::heuristic_name(heuristic) << "): mean average "
+              << sum / openers.size() << " over " << openers.size()
+              << " trees; fitted E(n) = " << model.tail_a << " + "
+              << model.tail_b << " log2(n) from " << samples.states
+              << " states" << std::endl;
+  }
+
+  if (!wordle::write_cost_model(opts.calibrate_path, model, samples)) {
+    std::cerr << "Failed to write " << opts.calibrate_path << std::endl;
     return 1;
+  }
+  std::cout << "Wrote cost model to " << opts.calibrate_path << std::endl;
+  return 0;
+}
 
-  std::cout << "Loaded " << words.get_solutions().size() << " solutions."
-            << std::endl;
-  std::cout << "Loaded " << words.get_guesses().size() << " guesses."
-            << std::endl;
+// Everything after loading the word lists, specialized on the word length so
+// the pattern table, scoring kernels and builder use their compile-time
+// pattern types.
+template <int L> int run(const Options &opts, const wordle::WordList &words) {
+  const std::string &out_path = opts.out_path;
+  const std::string &start_word = opts.start_word;
+  const wordle::HeuristicType heuristic = opts.heuristic;
+  const std::string &sweep_spec = opts.sweep_spec;
+  const std::string &sweep_output = opts.sweep_output;
+  // A checkpoint is a memo store that is also appended to while building.
+  const std::string &memo_store_path = opts.memo_store_path.empty()
+                                           ? opts.checkpoint_path
+                                           : opts.memo_store_path;
+  const unsigned int num_threads = opts.num_threads;
 
-  wordle::PatternTable table;
+  // Deploy gate: check an existing artifact against the lists and stop.
+  if (!opts.verify_artifact_path.empty()) {
+    enter_phase(opts, "verify");
+    if (wordle::is_bundle(opts.verify_artifact_path))
+      return wordle::report_bundle(
+                 opts.verify_artifact_path,
+                 wordle::verify_bundle<L>(opts.verify_artifact_path, words,
+                                          num_threads))
+                 ? 0
+                 : 1;
+    auto stats = wordle::verify_artifact<L>(opts.verify_artifact_path, words,
+                                            num_threads);
+    return wordle::report_artifact(opts.verify_artifact_path, stats) ? 0 : 1;
+  }
+
+  wordle::BasicPatternTable<L> table;
   std::cout << "Generating Pattern Table..." << std::endl;
+  enter_phase(opts, "pattern_table");
   auto start = std::chrono::high_resolution_clock::now();
-  table.generate(words.get_guesses(), words.get_solutions());
+  table.generate(words);
   auto end = std::chrono::high_resolution_clock::now();
   std::cout << "Table generated in "
             << std::chrono::duration_cast<std::chrono::milliseconds>(end -
@@ -78,11 +363,147 @@ int main(int argc, char **argv) {
                    .count()
             << "ms" << std::endl;
 
-  wordle::Builder builder(words, table, start_word, heuristic);
+  if (!opts.worker_address.empty())
+    return wordle::run_worker<L>(opts.worker_address, words, table,
+                                 num_threads);
+
+  enter_phase(opts, "recursion");
+  if (opts.num_boards > 1)
+    return run_multi<L>(opts, words, table);
+  if (!opts.bundle_path.empty())
+    return run_bundle<L>(opts, words, table);
+  if (!opts.calibrate_path.empty())
+    return run_calibrate<L>(opts, words, table);
+
+  // Optional persistent memo, shared with earlier builds.
+  auto memo = std::make_shared<wordle::Memo>();
+  wordle::MemoStore store;
+  if (!memo_store_path.empty()) {
+    if (!store.open(memo_store_path, words.get_checksum(), heuristic))
+      return 1;
+    std::cout << (opts.checkpoint_path.empty() ? "Memo store: "
+                                               : "Checkpoint: ")
+              << store.size() << " reusable subtrees in " << memo_store_path
+              << std::endl;
+  }
+  const wordle::MemoStore *store_ptr =
+      memo_store_path.empty() ? nullptr : &store;
+
+  // Incremental rebuild: reuse every subtree of the previous artifact that
+  // the list change did not touch.
+  if (!opts.base_path.empty()) {
+    start = std::chrono::high_resolution_clock::now();
+    auto base = wordle::seed_from_base(opts.base_path, words, heuristic,
+                                       *memo);
+    end = std::chrono::high_resolution_clock::now();
+    if (!base.valid)
+      return 1;
+    std::cout << "Base " << opts.base_path << ": " << base.removed
+              << " solutions removed, " << base.added << " added, "
+              << base.missing_guesses << " guesses dropped; reusing "
+              << base.reused_nodes << " of " << base.base_nodes
+              << " nodes (" << base.seeded << " memo entries) in "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end -
+                                                                       start)
+                     .count()
+              << "us" << std::endl;
+  }
+
+  std::unique_ptr<wordle::Checkpointer> checkpointer;
+  if (!opts.checkpoint_path.empty())
+    checkpointer = std::make_unique<wordle::Checkpointer>(
+        store, *memo, std::chrono::seconds(opts.checkpoint_interval));
+
+  // Appends what this run solved to the store.
+  auto save_memo = [&]() {
+    if (!store_ptr)
+      return true;
+    if (checkpointer) {
+      checkpointer->stop();
+      std::cout << "Checkpoint: " << checkpointer->checkpoints()
+                << " periodic checkpoints wrote " << checkpointer->written()
+                << " subtrees" << std::endl;
+    }
+    long written = store.append(*memo);
+    if (written < 0)
+      return false;
+    std::cout << "Memo store: appended " << written << " subtrees to "
+              << memo_store_path << std::endl;
+    return true;
+  };
+
+  if (!sweep_spec.empty()) {
+    std::vector<std::string> openers;
+    if (!wordle::resolve_sweep_openers<L>(sweep_spec, words, table, openers))
+      return 1;
+    if (openers.empty()) {
+      std::cerr << "No openers to sweep." << std::endl;
+      return 1;
+    }
+
+    enter_phase(opts, "sweep");
+    std::cout << "Sweeping " << openers.size() << " openers on "
+              << num_threads << " threads..." << std::endl;
+    start = std::chrono::high_resolution_clock::now();
+    auto results = wordle::sweep_openers<L>(words, table, openers, heuristic,
+                                         num_threads, memo, store_ptr);
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "Sweep time: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end -
+                                                                       start)
+                     .count()
+              << "ms" << std::endl;
+
+    if (results.front().success)
+      std::cout << "Best Opener: " << results.front().opener << " ("
+                << results.front().average << ")" << std::endl;
+
+    if (!sweep_output.empty()) {
+      if (!wordle::write_sweep_results(sweep_output, results)) {
+        std::cerr << "Failed to write " << sweep_output << std::endl;
+        return 1;
+      }
+      std::cout << "Wrote " << sweep_output << std::endl;
+    }
+    return save_memo() ? 0 : 1;
+  }
+
+  // Distributed build: workers solve the root buckets into the memo, and
+  // build() below assembles and verifies the tree from it.
+  if (opts.distribute_port >= 0) {
+    const auto &guesses = words.get_guesses();
+    auto it = std::lower_bound(guesses.begin(), guesses.end(), start_word);
+    if (it == guesses.end() || *it != start_word) {
+      std::cerr << "--distribute needs a start word from the guess list."
+                << std::endl;
+      return 1;
+    }
+    enter_phase(opts, "distribute");
+    start = std::chrono::high_resolution_clock::now();
+    auto dist = wordle::distribute_root<L>(
+        words, table, static_cast<int>(it - guesses.begin()), heuristic,
+        opts.distribute_port, opts.local_workers, opts.worker_command, *memo);
+    end = std::chrono::high_resolution_clock::now();
+    if (!dist.valid)
+      return 1;
+    std::cout << "Distributed: " << dist.solved << " of " << dist.buckets
+              << " root buckets solved by " << dist.workers << " workers ("
+              << dist.cached << " trivial or cached, " << dist.failed
+              << " failed, " << dist.requeued << " requeued); "
+              << dist.nodes << " nodes received in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end -
+                                                                       start)
+                     .count()
+              << "ms" << std::endl;
+    enter_phase(opts, "recursion");
+  }
+
+  wordle::BasicBuilder<L> builder(words, table, start_word, heuristic, memo);
+  builder.set_memo_store(store_ptr);
+  if (opts.perf)
+    builder.set_perf(opts.perf);
   std::cout << "Building Tree (Start: " << start_word << ", Heuristic: "
-            << (heuristic == wordle::HeuristicType::ENTROPY ? "Entropy"
-                                                            : "MinExpected")
-            << ")..." << std::endl;
+            << wordle::heuristic_name(heuristic) << ")..." << std::endl;
   start = std::chrono::high_resolution_clock::now();
   auto root = builder.build();
   end = std::chrono::high_resolution_clock::now();
@@ -97,10 +518,16 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  if (!save_memo())
+    std::cerr << "Warning: Failed to update memo store." << std::endl;
+
+  root = refine<L>(opts, root, words, table);
+
   std::cout << "Success! Root Guess Index: " << root->guess_index << " ("
             << words.get_guesses()[root->guess_index] << ")" << std::endl;
 
   // Verify
+  enter_phase(opts, "verify");
   if (!wordle::verify_tree(root, words)) {
     std::cerr << "Tree verification failed! Aborting write." << std::endl;
     return 1;
@@ -109,13 +536,389 @@ int main(int argc, char **argv) {
   // Write
   if (!out_path.empty()) {
     std::cout << "Writing to " << out_path << "..." << std::endl;
-    if (wordle::write_solution(out_path, root, words)) {
+    enter_phase(opts, "writing");
+    if (wordle::write_solution(out_path, root, words, heuristic,
+                               opts.embed_words, opts.embed_ranges)) {
       std::cout << "Successfully wrote " << out_path << std::endl;
     } else {
       std::cerr << "Failed to write " << out_path << std::endl;
       return 1;
     }
+    // Check what actually reached the disk, not just the in-memory tree.
+    enter_phase(opts, "verify");
+    if (!wordle::report_artifact(
+            out_path,
+            wordle::verify_artifact<L>(out_path, words, num_threads)))
+      return 1;
+  }
+
+  // The same artifact as C++ source, for the static solver build.
+  enter_phase(opts, "writing");
+  if (!opts.emit_cpp_path.empty() &&
+      !wordle::write_solution_source(opts.emit_cpp_path, root, words,
+                                     heuristic)) {
+    std::cerr << "Failed to write " << opts.emit_cpp_path << std::endl;
+    return 1;
   }
 
   return 0;
 }
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string s_path, g_path, out_path;
+  std::string start_word;
+  bool run_verify = false;
+  std::string single_list_path;
+  wordle::HeuristicType heuristic = wordle::HeuristicType::ENTROPY;
+  std::string sweep_spec, sweep_output;
+  std::string memo_store_path;
+  unsigned int num_threads = std::thread::hardware_concurrency();
+  int word_length = 5;
+  int num_boards = 1;
+  int max_guesses = 0;
+  bool embed_words = false;
+  bool embed_ranges = false;
+  std::string emit_cpp_path;
+  std::string verify_artifact_path;
+  std::string base_path;
+  std::string checkpoint_path;
+  int checkpoint_interval = 60;
+  bool resume = false;
+  std::string perf_json_path;
+  std::string bundle_path;
+  std::vector<BundleSpec> bundle_trees;
+  int refine_seconds = 0;
+  std::string cost_model_path;
+  std::string calibrate_path;
+  std::string calibrate_openers;
+  int calibrate_rounds = 1;
+  int distribute_port = -1;
+  int local_workers = 0;
+  std::string worker_address;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--solutions" && i + 1 < argc)
+      s_path = argv[++i];
+    else if (arg == "--guesses" && i + 1 < argc)
+      g_path = argv[++i];
+    else if (arg == "--output" && i + 1 < argc)
+      out_path = argv[++i];
+    else if (arg == "--start-word" && i + 1 < argc)
+      start_word = argv[++i];
+    else if (arg == "--single-list" && i + 1 < argc)
+      single_list_path = argv[++i];
+    else if (arg == "--heuristic" && i + 1 < argc) {
+      if (!parse_heuristic_arg(argv[++i], heuristic))
+        return 1;
+    } else if (arg == "--verify")
+      run_verify = true;
+    else if (arg == "--sweep-openers" && i + 1 < argc)
+      sweep_spec = argv[++i];
+    else if (arg == "--sweep-output" && i + 1 < argc)
+      sweep_output = argv[++i];
+    else if (arg == "--memo-store" && i + 1 < argc)
+      memo_store_path = argv[++i];
+    else if (arg == "--threads" && i + 1 < argc) {
+      if (!parse_int_arg(arg, argv[++i], num_threads))
+        return 1;
+    } else if (arg == "--word-length" && i + 1 < argc) {
+      if (!parse_int_arg(arg, argv[++i], word_length))
+        return 1;
+    } else if (arg == "--embed-words")
+      embed_words = true;
+    else if (arg == "--embed-ranges")
+      embed_ranges = true;
+    else if (arg == "--emit-cpp" && i + 1 < argc)
+      emit_cpp_path = argv[++i];
+    else if (arg == "--verify-artifact" && i + 1 < argc)
+      verify_artifact_path = argv[++i];
+    else if (arg == "--checkpoint" && i + 1 < argc)
+      checkpoint_path = argv[++i];
+    else if (arg == "--checkpoint-interval" && i + 1 < argc) {
+      if (!parse_int_arg(arg, argv[++i], checkpoint_interval))
+        return 1;
+    } else if (arg == "--resume")
+      resume = true;
+    else if (arg == "--perf-json" && i + 1 < argc)
+      perf_json_path = argv[++i];
+    else if (arg == "--refine-seconds" && i + 1 < argc) {
+      if (!parse_int_arg(arg, argv[++i], refine_seconds))
+        return 1;
+    } else if (arg == "--cost-model" && i + 1 < argc)
+      cost_model_path = argv[++i];
+    else if (arg == "--calibrate" && i + 1 < argc)
+      calibrate_path = argv[++i];
+    else if (arg == "--calibrate-openers" && i + 1 < argc)
+      calibrate_openers = argv[++i];
+    else if (arg == "--calibrate-rounds" && i + 1 < argc) {
+      if (!parse_int_arg(arg, argv[++i], calibrate_rounds))
+        return 1;
+    } else if (arg == "--distribute" && i + 1 < argc) {
+      if (!parse_int_arg(arg, argv[++i], distribute_port))
+        return 1;
+    } else if (arg == "--local-workers" && i + 1 < argc) {
+      if (!parse_int_arg(arg, argv[++i], local_workers))
+        return 1;
+    } else if (arg == "--worker" && i + 1 < argc)
+      worker_address = argv[++i];
+    else if (arg == "--bundle" && i + 1 < argc)
+      bundle_path = argv[++i];
+    else if (arg == "--bundle-trees" && i + 1 < argc) {
+      if (!parse_bundle_trees(argv[++i], bundle_trees))
+        return 1;
+    } else if (arg == "--base" && i + 1 < argc)
+      base_path = argv[++i];
+    else if (arg == "--boards" && i + 1 < argc) {
+      if (!parse_int_arg(arg, argv[++i], num_boards))
+        return 1;
+    } else if (arg == "--max-guesses" && i + 1 < argc) {
+      if (!parse_int_arg(arg, argv[++i], max_guesses))
+        return 1;
+    }
+  }
+
+  if (!single_list_path.empty()) {
+    s_path = single_list_path;
+    g_path = single_list_path;
+  }
+
+  if (s_path.empty() || g_path.empty()) {
+    std::cerr << "Usage: " << argv[0]
+              << " (--solutions <path> --guesses <path> | --single-list "
+                 "<path>) [--word-length <4-8>] [--boards <1-4> "
+                 "[--max-guesses <n>]] [--output <path> [--embed-words] "
+                 "[--embed-ranges]] "
+                 "[--emit-cpp <path.cpp>] [--start-word <word>] [--heuristic "
+                 "entropy|min_expected|minimax|expected_size|most_parts] "
+                 "[--verify] [--verify-artifact <path>] "
+                 "[--memo-store <path>] [--base <old artifact>] "
+                 "[--checkpoint <path> [--checkpoint-interval <s>] "
+                 "[--resume]] [--refine-seconds <s>] [--perf-json <path>] "
+                 "[--distribute <port> [--local-workers <n>]] [--worker "
+                 "<host:port>] [--cost-model <path>] [--calibrate <path> "
+                 "[--calibrate-openers <file|top-N>] [--calibrate-rounds "
+                 "<n>]] [--bundle <path> "
+                 "--bundle-trees <opener:heuristic,...>] "
+                 "[--sweep-openers "
+                 "<file|top-N> [--sweep-output <file.csv|file.json>] "
+                 "[--threads <n>]]"
+              << std::endl;
+    return 1;
+  }
+
+  // Default to "trace" (avg 3.605) instead of "reast" (avg 3.602) because
+  // "trace" is a valid solution, offering a chance for a 1-guess win. Other
+  // word lengths let the heuristic pick the opener.
+  if (start_word.empty() && word_length == 5)
+    start_word = "trace";
+
+  if (word_length < 4 || word_length > 8) {
+    std::cerr << "Unsupported word length: " << word_length << " (use 4-8)"
+              << std::endl;
+    return 1;
+  }
+
+  if (num_boards < 1 || num_boards > wordle::kMaxBoards) {
+    std::cerr << "Unsupported board count: " << num_boards << " (use 1-"
+              << wordle::kMaxBoards << ")" << std::endl;
+    return 1;
+  }
+  // Dordle allows 7 guesses, Quordle 9: five beyond one per board.
+  if (max_guesses <= 0)
+    max_guesses = num_boards + 5;
+
+  // Joint multi-board scores exist for the first two heuristics only.
+  if (num_boards > 1 && heuristic != wordle::HeuristicType::ENTROPY &&
+      heuristic != wordle::HeuristicType::MIN_EXPECTED) {
+    std::cerr << "--boards supports the entropy and min_expected heuristics "
+                 "only."
+              << std::endl;
+    return 1;
+  }
+  if (!emit_cpp_path.empty() && num_boards > 1) {
+    std::cerr << "--emit-cpp supports single-board trees only." << std::endl;
+    return 1;
+  }
+  // Shared nodes of a multi-board tree or a bundle are reached with
+  // different candidate sets, so they have no single range.
+  if (embed_ranges && (num_boards > 1 || !bundle_path.empty())) {
+    std::cerr << "--embed-ranges supports single-tree artifacts only."
+              << std::endl;
+    return 1;
+  }
+  if (refine_seconds > 0 && (num_boards > 1 || !sweep_spec.empty())) {
+    std::cerr << "--refine-seconds supports single-board builds only."
+              << std::endl;
+    return 1;
+  }
+  if (!base_path.empty() && num_boards > 1) {
+    std::cerr << "--base supports single-board trees only." << std::endl;
+    return 1;
+  }
+
+  if (bundle_path.empty() != bundle_trees.empty()) {
+    std::cerr << "--bundle and --bundle-trees go together." << std::endl;
+    return 1;
+  }
+  if (!bundle_path.empty() &&
+      (num_boards > 1 || !memo_store_path.empty() || !checkpoint_path.empty() ||
+       !base_path.empty() || !sweep_spec.empty() || !out_path.empty() ||
+       !emit_cpp_path.empty() || !verify_artifact_path.empty())) {
+    std::cerr << "--bundle builds single-board trees on its own; it takes no "
+                 "--output, --emit-cpp, --sweep-openers, --memo-store, "
+                 "--checkpoint, --base or --verify-artifact."
+              << std::endl;
+    return 1;
+  }
+
+  if (distribute_port >= 0 || !worker_address.empty()) {
+    const bool single = num_boards == 1 && bundle_path.empty() &&
+                        calibrate_path.empty() && sweep_spec.empty() &&
+                        memo_store_path.empty() && checkpoint_path.empty() &&
+                        verify_artifact_path.empty();
+    if (!single || (distribute_port >= 0 && !worker_address.empty())) {
+      std::cerr << "--distribute and --worker split a single-board build; "
+                   "they take no --boards, --bundle, --calibrate, "
+                   "--sweep-openers, --memo-store, --checkpoint or "
+                   "--verify-artifact, and not each other."
+                << std::endl;
+      return 1;
+    }
+  }
+  if (distribute_port > 65535 || local_workers < 0 ||
+      (local_workers > 0 && distribute_port < 0)) {
+    std::cerr << "--local-workers requires --distribute <port> (0-65535)."
+              << std::endl;
+    return 1;
+  }
+
+  // Stored subtrees do not record the cost table they were built with.
+  if (!cost_model_path.empty() &&
+      (!memo_store_path.empty() || !checkpoint_path.empty())) {
+    std::cerr << "--cost-model cannot be combined with --memo-store or "
+                 "--checkpoint."
+              << std::endl;
+    return 1;
+  }
+  if (!calibrate_path.empty() &&
+      (num_boards > 1 || !bundle_path.empty() || !memo_store_path.empty() ||
+       !checkpoint_path.empty() || !base_path.empty() ||
+       !sweep_spec.empty() || !out_path.empty() || !emit_cpp_path.empty() ||
+       !verify_artifact_path.empty() || refine_seconds > 0)) {
+    std::cerr << "--calibrate builds single-board trees on its own; it takes "
+                 "no --output, --emit-cpp, --bundle, --sweep-openers, "
+                 "--memo-store, --checkpoint, --base, --refine-seconds or "
+                 "--verify-artifact."
+              << std::endl;
+    return 1;
+  }
+  if (calibrate_rounds < 1 ||
+      (calibrate_path.empty() &&
+       (!calibrate_openers.empty() || calibrate_rounds != 1))) {
+    std::cerr << "--calibrate-openers and --calibrate-rounds (at least 1) "
+                 "require --calibrate <path>."
+              << std::endl;
+    return 1;
+  }
+
+  if (!checkpoint_path.empty()) {
+    if (num_boards > 1 || !memo_store_path.empty()) {
+      std::cerr << "--checkpoint supports single-board trees without "
+                   "--memo-store only."
+                << std::endl;
+      return 1;
+    }
+    if (checkpoint_interval < 1) {
+      std::cerr << "Checkpoint interval must be at least 1s." << std::endl;
+      return 1;
+    }
+    // Never append to a stale checkpoint by accident.
+    if (!resume && std::ifstream(checkpoint_path).good()) {
+      std::cerr << "Checkpoint " << checkpoint_path
+                << " exists; pass --resume to continue from it." << std::endl;
+      return 1;
+    }
+  } else if (resume) {
+    std::cerr << "--resume requires --checkpoint <path>." << std::endl;
+    return 1;
+  }
+
+  if (!cost_model_path.empty()) {
+    wordle::CostModel model;
+    if (!wordle::load_cost_model(cost_model_path, model))
+      return 1;
+    wordle::set_expected_costs(model);
+  }
+
+  // Opened before any worker thread starts so that every thread is counted.
+  std::unique_ptr<wordle::PerfCounters> counters;
+  std::unique_ptr<wordle::PerfPhases> perf;
+  if (!perf_json_path.empty()) {
+    counters = std::make_unique<wordle::PerfCounters>();
+    if (!counters->any_available())
+      std::cerr << "Warning: No performance counters (" << counters->error()
+                << "); reporting wall time only." << std::endl;
+    perf = std::make_unique<wordle::PerfPhases>(*counters);
+    perf->enter(perf->phase("load_words"));
+  }
+
+  // A local worker loads the same lists and cost table, and scores on one
+  // thread: there is one worker per core.
+  std::vector<std::string> worker_command{
+      argv[0],        "--solutions", s_path, "--guesses", g_path,
+      "--word-length", std::to_string(word_length), "--threads", "1"};
+  if (!cost_model_path.empty()) {
+    worker_command.push_back("--cost-model");
+    worker_command.push_back(cost_model_path);
+  }
+
+  wordle::WordList words;
+  if (!words.load(s_path, g_path, word_length))
+    return 1;
+
+  std::cout << "Loaded " << words.get_solutions().size() << " solutions."
+            << std::endl;
+  std::cout << "Loaded " << words.get_guesses().size() << " guesses."
+            << std::endl;
+
+  Options opts{out_path,     start_word,      heuristic,   sweep_spec,
+               sweep_output, memo_store_path, num_threads, num_boards,
+               max_guesses,  embed_words,     embed_ranges, emit_cpp_path,
+               verify_artifact_path, base_path, checkpoint_path,
+               checkpoint_interval, perf.get(), bundle_path, bundle_trees,
+               refine_seconds, calibrate_path, calibrate_openers,
+               calibrate_rounds, distribute_port, local_workers,
+               worker_command, worker_address};
+  int rc;
+  switch (word_length) {
+  case 4:
+    rc = run<4>(opts, words);
+    break;
+  case 6:
+    rc = run<6>(opts, words);
+    break;
+  case 7:
+    rc = run<7>(opts, words);
+    break;
+  case 8:
+    rc = run<8>(opts, words);
+    break;
+  default:
+    rc = run<5>(opts, words);
+    break;
+  }
+
+  if (perf) {
+    perf->stop();
+    if (!perf->write_json(perf_json_path)) {
+      std::cerr << "Failed to write " << perf_json_path << std::endl;
+      return 1;
+    }
+    std::cout << "Wrote performance counters to " << perf_json_path
+              << std::endl;
+  }
+  return rc;
+}
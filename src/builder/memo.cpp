@@ -0,0 +1,27 @@
+#include "memo.h"
+
+namespace wordle {
+
+std::shared_ptr<MemoryNode> Memo::find(const MemoKey &key) const {
+  Shard &shard = shard_for(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.map.find(key);
+  return it != shard.map.end() ? it->second : nullptr;
+}
+
+void Memo::insert(const MemoKey &key, std::shared_ptr<MemoryNode> node) {
+  Shard &shard = shard_for(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.map.emplace(key, std::move(node));
+}
+
+size_t Memo::size() const {
+  size_t total = 0;
+  for (const auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    total += shard.map.size();
+  }
+  return total;
+}
+
+} // namespace wordle
@@ -0,0 +1,70 @@
+#pragma once
+#include "state.h"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace wordle {
+
+struct MemoryNode;
+
+// Memo key: a candidate set plus the number of guesses still available.
+// A subtree solved with R guesses left is not guaranteed to fit in fewer, and
+// the remaining-depth rules pick different guesses per R, so both are part of
+// the key. This makes a memo hit return exactly what a fresh solve would,
+// which is what allows one memo to be shared by many builds.
+struct MemoKey {
+  SolverState state;
+  int remaining = 0;
+
+  bool operator==(const MemoKey &other) const {
+    return remaining == other.remaining && state == other.state;
+  }
+};
+
+struct MemoKeyHash {
+  size_t operator()(const MemoKey &k) const {
+    return k.state.hash() ^ (static_cast<uint64_t>(k.remaining) *
+                             0x9E3779B97F4A7C15ULL);
+  }
+};
+
+// Thread-safe memo of solved subtrees, sharded by key hash so concurrent
+// builds rarely contend on the same lock.
+class Memo {
+public:
+  std::shared_ptr<MemoryNode> find(const MemoKey &key) const;
+
+  // Inserts unless the key is already present (a concurrent build may have
+  // solved the same state; both results are identical).
+  void insert(const MemoKey &key, std::shared_ptr<MemoryNode> node);
+
+  size_t size() const;
+
+  // Calls f(key, node) for every entry. Holds one shard lock at a time, so
+  // `f` must not call back into this memo.
+  template <class F> void for_each(F &&f) const {
+    for (const auto &shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      for (const auto &[key, node] : shard.map)
+        f(key, node);
+    }
+  }
+
+private:
+  static constexpr size_t kShards = 64;
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<MemoKey, std::shared_ptr<MemoryNode>, MemoKeyHash> map;
+  };
+
+  Shard &shard_for(const MemoKey &key) const {
+    return shards_[MemoKeyHash()(key) % kShards];
+  }
+
+  mutable std::array<Shard, kShards> shards_;
+};
+
+} // namespace wordle
@@ -0,0 +1,240 @@
+#include "memo_store.h"
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wordle {
+
+namespace {
+
+constexpr uint32_t kStoreMagic = 0x4D454D57; // "WMEM"
+constexpr uint32_t kStoreVersion = 2; // v2: 16-bit patterns (4-8 letters)
+
+struct StoreHeader {
+  uint32_t magic = kStoreMagic;
+  uint32_t version = kStoreVersion;
+};
+
+struct RecordHeader {
+  uint64_t state_hash;
+  uint64_t list_checksum;
+  uint8_t remaining;
+  uint8_t heuristic;
+  uint16_t reserved;
+  uint32_t num_words; // bitset words that follow
+  uint32_t num_nodes; // pre-order nodes that follow the bits
+  uint32_t reserved2;
+};
+
+uint64_t index_key(uint64_t state_hash, int remaining) {
+  return state_hash ^ (static_cast<uint64_t>(remaining) * 0x9E3779B97F4A7C15ULL);
+}
+
+size_t record_size(const RecordHeader &h) {
+  return sizeof(RecordHeader) + h.num_words * sizeof(uint64_t) +
+         h.num_nodes * sizeof(StoredNode);
+}
+
+// Rebuilds the subtree starting at nodes[pos]; `pos` advances past it.
+std::shared_ptr<MemoryNode> decode(const StoredNode *nodes, size_t count,
+                                   size_t &pos, int depth) {
+  if (pos >= count || depth > kMaxSubtreeDepth)
+    return nullptr;
+  const StoredNode &sn = nodes[pos++];
+  auto node = std::make_shared<MemoryNode>();
+  node->guess_index = sn.guess_index;
+  node->is_leaf = (sn.flags & 1) != 0;
+  node->children.reserve(sn.num_children);
+  for (uint16_t i = 0; i < sn.num_children; ++i) {
+    if (pos >= count)
+      return nullptr;
+    uint16_t pattern = nodes[pos].pattern;
+    auto child = decode(nodes, count, pos, depth + 1);
+    if (!child)
+      return nullptr;
+    node->children.emplace_back(pattern, std::move(child));
+  }
+  return node;
+}
+
+void encode(const MemoryNode &node, uint16_t pattern,
+            std::vector<StoredNode> &out) {
+  StoredNode sn{};
+  sn.guess_index = node.guess_index;
+  sn.pattern = pattern;
+  sn.flags = node.is_leaf ? 1 : 0;
+  sn.num_children = static_cast<uint16_t>(node.children.size());
+  out.push_back(sn);
+  for (const auto &[p, child] : node.children)
+    encode(*child, p, out);
+}
+
+} // namespace
+
+void encode_subtree(const MemoryNode &root, std::vector<StoredNode> &out) {
+  encode(root, 0, out);
+}
+
+std::shared_ptr<MemoryNode> decode_subtree(const StoredNode *nodes,
+                                           size_t count) {
+  size_t pos = 0;
+  auto root = decode(nodes, count, pos, 0);
+  return pos == count ? root : nullptr;
+}
+
+MemoStore::~MemoStore() {
+  if (data_)
+    munmap(const_cast<uint8_t *>(data_), size_);
+}
+
+bool MemoStore::open(const std::string &path, uint64_t list_checksum,
+                     HeuristicType heuristic) {
+  path_ = path;
+  list_checksum_ = list_checksum;
+  heuristic_ = heuristic;
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    return true; // Nothing stored yet.
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    std::cerr << "Failed to get file size for: " << path << std::endl;
+    close(fd);
+    return false;
+  }
+  if (st.st_size == 0) {
+    close(fd);
+    return true;
+  }
+
+  size_ = st.st_size;
+  void *mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    std::cerr << "Failed to mmap file: " << path << std::endl;
+    size_ = 0;
+    return false;
+  }
+  data_ = static_cast<const uint8_t *>(mapped);
+  has_header_ = true;
+
+  StoreHeader header;
+  if (size_ < sizeof(StoreHeader)) {
+    std::cerr << "Memo store too small for header: " << path << std::endl;
+    return false;
+  }
+  std::memcpy(&header, data_, sizeof(StoreHeader));
+  if (header.magic != kStoreMagic || header.version != kStoreVersion) {
+    std::cerr << "Invalid memo store (magic/version): " << path << std::endl;
+    return false;
+  }
+
+  size_t offset = sizeof(StoreHeader);
+  while (offset + sizeof(RecordHeader) <= size_) {
+    const auto *rh = reinterpret_cast<const RecordHeader *>(data_ + offset);
+    if (offset + record_size(*rh) > size_)
+      break; // Truncated tail.
+    if (rh->list_checksum == list_checksum_ &&
+        rh->heuristic == static_cast<uint8_t>(heuristic_))
+      index_.emplace(index_key(rh->state_hash, rh->remaining), offset);
+    offset += record_size(*rh);
+  }
+  valid_end_ = offset;
+  return true;
+}
+
+const uint8_t *MemoStore::find_record(const MemoKey &key) const {
+  if (index_.empty())
+    return nullptr;
+
+  const auto &words = key.state.get_words();
+  auto range = index_.equal_range(index_key(key.state.hash(), key.remaining));
+  for (auto it = range.first; it != range.second; ++it) {
+    const uint8_t *rec = data_ + it->second;
+    const auto *rh = reinterpret_cast<const RecordHeader *>(rec);
+    if (rh->remaining == key.remaining && rh->num_words == words.size() &&
+        std::memcmp(rec + sizeof(RecordHeader), words.data(),
+                    words.size() * sizeof(uint64_t)) == 0)
+      return rec;
+  }
+  return nullptr;
+}
+
+std::shared_ptr<MemoryNode> MemoStore::find(const MemoKey &key) const {
+  const uint8_t *rec = find_record(key);
+  if (!rec)
+    return nullptr;
+
+  const auto *rh = reinterpret_cast<const RecordHeader *>(rec);
+  const auto *nodes = reinterpret_cast<const StoredNode *>(
+      rec + sizeof(RecordHeader) + rh->num_words * sizeof(uint64_t));
+  return decode_subtree(nodes, rh->num_nodes);
+}
+
+long MemoStore::append(const Memo &memo) {
+  // Collect first so the builder is never blocked on disk writes.
+  std::vector<std::pair<MemoKey, std::shared_ptr<MemoryNode>>> pending;
+  memo.for_each([&](const MemoKey &key,
+                    const std::shared_ptr<MemoryNode> &node) {
+    if (node && !appended_.count(key) && !find_record(key))
+      pending.emplace_back(key, node);
+  });
+  if (pending.empty())
+    return 0;
+
+  // Drop a torn tail first: records appended after it would be misparsed.
+  if (has_header_ && valid_end_ < size_) {
+    if (truncate(path_.c_str(), static_cast<off_t>(valid_end_)) == -1) {
+      std::cerr << "Failed to drop the truncated tail of " << path_
+                << std::endl;
+      return -1;
+    }
+    valid_end_ = size_; // Once: later appends follow complete records
+  }
+
+  std::ofstream out(path_, std::ios::binary | std::ios::app);
+  if (!out) {
+    std::cerr << "Failed to open memo store for append: " << path_
+              << std::endl;
+    return -1;
+  }
+  if (!has_header_) {
+    StoreHeader header;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(StoreHeader));
+    has_header_ = true;
+  }
+
+  long written = 0;
+  std::vector<StoredNode> nodes;
+  for (auto &[key, node] : pending) {
+    nodes.clear();
+    encode_subtree(*node, nodes);
+
+    const auto &words = key.state.get_words();
+    RecordHeader rh{};
+    rh.state_hash = key.state.hash();
+    rh.list_checksum = list_checksum_;
+    rh.remaining = static_cast<uint8_t>(key.remaining);
+    rh.heuristic = static_cast<uint8_t>(heuristic_);
+    rh.num_words = static_cast<uint32_t>(words.size());
+    rh.num_nodes = static_cast<uint32_t>(nodes.size());
+
+    out.write(reinterpret_cast<const char *>(&rh), sizeof(RecordHeader));
+    out.write(reinterpret_cast<const char *>(words.data()),
+              words.size() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char *>(nodes.data()),
+              nodes.size() * sizeof(StoredNode));
+    appended_.insert(std::move(key));
+    ++written;
+  }
+
+  out.close();
+  return out ? written : -1;
+}
+
+} // namespace wordle
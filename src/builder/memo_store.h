@@ -0,0 +1,91 @@
+#pragma once
+#include "builder.h"
+#include "entropy.h"
+#include "memo.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace wordle {
+
+// Pre-order encoding of a subtree, used by store records and by distributed
+// build results.
+struct StoredNode {
+  uint16_t guess_index;
+  uint16_t pattern; // Edge label from the parent (0 for the encoded root)
+  uint8_t flags;    // 0x1: IsLeaf
+  uint8_t reserved;
+  uint16_t num_children;
+};
+
+// Deeper encodings are rejected: no tree in this project reaches it.
+constexpr int kMaxSubtreeDepth = 16;
+
+void encode_subtree(const MemoryNode &root, std::vector<StoredNode> &out);
+
+// Rebuilds a subtree from exactly `count` encoded nodes, or returns nullptr
+// if they are not one well-formed subtree.
+std::shared_ptr<MemoryNode> decode_subtree(const StoredNode *nodes,
+                                           size_t count);
+
+// Optional on-disk store of solved subtrees, shared across builds.
+//
+// Subtrees below the root do not depend on the opener, so builds with a
+// different --start-word (or a repeated build) can reuse them. Records are
+// keyed by candidate-set hash, remaining guesses, heuristic and word-list
+// checksum; records for other lists or heuristics are kept but ignored. The
+// file is mapped read-only at startup and new entries are appended at exit.
+//
+// File layout (little-endian):
+//   StoreHeader, then records of
+//   RecordHeader, uint64_t bits[num_words], StoredNode nodes[num_nodes]
+// where the nodes are the subtree in pre-order.
+class MemoStore {
+public:
+  MemoStore() = default;
+  ~MemoStore();
+
+  MemoStore(const MemoStore &) = delete;
+  MemoStore &operator=(const MemoStore &) = delete;
+
+  // Maps `path` and indexes the records that match this build. A missing
+  // file is an empty store. A truncated trailing record (e.g. from a crash
+  // during append) is ignored, and cut off before the next append.
+  bool open(const std::string &path, uint64_t list_checksum,
+            HeuristicType heuristic);
+
+  // Materializes the stored subtree for `key`, or returns nullptr.
+  // Thread-safe: the index is immutable after open().
+  std::shared_ptr<MemoryNode> find(const MemoKey &key) const;
+
+  // Appends every entry of `memo` that the store does not already hold,
+  // including entries appended earlier by this process, so it can be called
+  // repeatedly while a build runs. Memo locks are only held while the
+  // entries are collected. Not safe to call concurrently with itself.
+  // Returns the number of records written, or -1 on I/O failure.
+  long append(const Memo &memo);
+
+  // Number of usable records found at open().
+  size_t size() const { return index_.size(); }
+
+private:
+  // Returns the matching record for this build, or nullptr.
+  const uint8_t *find_record(const MemoKey &key) const;
+
+  std::string path_;
+  uint64_t list_checksum_ = 0;
+  HeuristicType heuristic_ = HeuristicType::ENTROPY;
+
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+  size_t valid_end_ = 0; // End of the last complete record
+  // (state hash ^ remaining) -> record offsets; bits are compared on lookup.
+  std::unordered_multimap<uint64_t, size_t> index_;
+  // Keys appended since open(); the mapped index above is never modified.
+  std::unordered_set<MemoKey, MemoKeyHash> appended_;
+  bool has_header_ = false;
+};
+
+} // namespace wordle
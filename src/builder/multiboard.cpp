@@ -0,0 +1,470 @@
+#include "multiboard.h"
+#include "libwordle_core/artifact.h"
+#include "libwordle_core/pattern.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <thread>
+
+namespace wordle {
+
+namespace {
+
+template <int L> uint32_t compute_mask(const BasicPackedWord<L> &w) {
+  uint32_t mask = 0;
+  for (int i = 0; i < L; ++i)
+    mask |= (1u << w.chars[i]);
+  return mask;
+}
+
+bool board_less(const SolverState &a, const SolverState &b) {
+  size_t ca = a.count(), cb = b.count();
+  if (ca != cb)
+    return ca < cb;
+  return a.get_words() < b.get_words();
+}
+
+// Beam widths, as in the single-board builder: narrow first, then wider
+// beams only after every guess in the narrower one failed.
+constexpr size_t kBeamWidths[] = {5, 50};
+
+} // namespace
+
+const MultiEdge *MultiNode::find(uint64_t feedback) const {
+  auto it = std::lower_bound(
+      children.begin(), children.end(), feedback,
+      [](const MultiEdge &e, uint64_t f) { return e.feedback < f; });
+  if (it != children.end() && it->feedback == feedback)
+    return &*it;
+  return nullptr;
+}
+
+uint8_t canonicalize_boards(std::vector<SolverState> &boards) {
+  const size_t n = boards.size();
+  int order[kMaxBoards];
+  std::iota(order, order + n, 0);
+  std::stable_sort(order, order + n, [&](int a, int b) {
+    return board_less(boards[a], boards[b]);
+  });
+
+  uint8_t perm = 0;
+  std::vector<SolverState> sorted(n);
+  for (size_t pos = 0; pos < n; ++pos) {
+    sorted[pos] = std::move(boards[order[pos]]);
+    perm |= static_cast<uint8_t>(pos << (2 * order[pos]));
+  }
+  boards = std::move(sorted);
+  return perm;
+}
+
+template <int L>
+MultiBuilder<L>::MultiBuilder(const WordList &words, const Table &table,
+                              int num_boards, int max_guesses,
+                              const std::string &start_word,
+                              HeuristicType heuristic)
+    : words_(words), table_(table), num_boards_(num_boards),
+      max_guesses_(max_guesses), heuristic_(heuristic) {
+  const auto &guesses = words_.get_guesses();
+  solution_to_guess_.resize(words_.get_solutions().size());
+  for (size_t i = 0; i < words_.get_solutions().size(); ++i) {
+    auto it = std::lower_bound(guesses.begin(), guesses.end(),
+                               words_.get_solutions()[i]);
+    solution_to_guess_[i] = static_cast<int>(std::distance(guesses.begin(), it));
+  }
+
+  if (!start_word.empty()) {
+    auto it = std::lower_bound(guesses.begin(), guesses.end(), start_word);
+    if (it != guesses.end() && *it == start_word)
+      start_index_ = static_cast<int>(std::distance(guesses.begin(), it));
+    else
+      std::cerr << "Warning: Start word '" << start_word
+                << "' not found in guesses." << std::endl;
+  }
+
+  guess_masks_.resize(guesses.size());
+  for (size_t i = 0; i < guesses.size(); ++i)
+    guess_masks_[i] = compute_mask(words_.guesses_as<L>()[i]);
+  solution_masks_.resize(words_.get_solutions().size());
+  for (size_t i = 0; i < words_.get_solutions().size(); ++i)
+    solution_masks_[i] = compute_mask(words_.solutions_as<L>()[i]);
+}
+
+template <int L> std::shared_ptr<MultiNode> MultiBuilder<L>::build() {
+  SolverState all_solutions(words_.get_solutions().size());
+  for (size_t i = 0; i < words_.get_solutions().size(); ++i)
+    all_solutions.set(i);
+  return solve(Boards(num_boards_, all_solutions), 0);
+}
+
+template <int L>
+std::vector<int>
+MultiBuilder<L>::rank_guesses(const std::vector<std::vector<int>> &active,
+                              bool must_solve, int used) const {
+  std::vector<int> candidates;
+  if (used == 0 && start_index_ >= 0) {
+    candidates.push_back(start_index_);
+    return candidates;
+  }
+
+  if (must_solve) {
+    // Every remaining guess has to finish a board: only candidates qualify.
+    for (const auto &board : active)
+      for (int s : board)
+        candidates.push_back(solution_to_guess_[s]);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+  } else {
+    uint32_t active_mask = 0;
+    for (const auto &board : active)
+      for (int s : board)
+        active_mask |= solution_masks_[s];
+    for (size_t i = 0; i < words_.get_guesses().size(); ++i)
+      if (guess_masks_[i] & active_mask)
+        candidates.push_back(static_cast<int>(i));
+  }
+
+  std::vector<JointStats> stats(candidates.size());
+  unsigned int num_threads = std::thread::hardware_concurrency();
+  if (num_threads == 0)
+    num_threads = 4;
+  if (candidates.size() < 512) {
+    score_boards(active, candidates.data(), candidates.size(), table_,
+                 stats.data());
+  } else {
+    size_t chunk = candidates.size() / num_threads;
+    chunk -= chunk % kGuessBlock;
+    std::vector<std::future<void>> futures;
+    for (unsigned int t = 0; t < num_threads; ++t) {
+      size_t start = t * chunk;
+      size_t end = (t == num_threads - 1) ? candidates.size() : start + chunk;
+      futures.push_back(get_thread_pool().enqueue([&, start, end]() {
+        score_boards(active, candidates.data() + start, end - start, table_,
+                     stats.data() + start);
+      }));
+    }
+    for (auto &f : futures)
+      f.get();
+  }
+
+  std::vector<size_t> order(candidates.size());
+  std::iota(order.begin(), order.end(), 0);
+  const bool entropy = heuristic_ == HeuristicType::ENTROPY;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    double sa = joint_score(stats[a], heuristic_);
+    double sb = joint_score(stats[b], heuristic_);
+    return entropy ? sa > sb : sa < sb;
+  });
+
+  std::vector<int> ranked(order.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    ranked[i] = candidates[order[i]];
+  return ranked;
+}
+
+template <int L>
+std::shared_ptr<MultiNode> MultiBuilder<L>::solve(const Boards &boards,
+                                                  int used) {
+  const int R = max_guesses_ - used;
+  int live = 0;
+  for (const auto &b : boards)
+    live += b.empty() ? 0 : 1;
+  // Each guess can finish at most one board.
+  if (live == 0 || live > R)
+    return nullptr;
+
+  MultiKey key{boards, R};
+  if (auto it = cache_.find(key); it != cache_.end())
+    return it->second;
+
+  std::vector<std::vector<int>> active(boards.size());
+  for (size_t b = 0; b < boards.size(); ++b)
+    active[b] = boards[b].get_active_indices();
+
+  // With at most two candidates per board a candidate guess always splits
+  // its own board completely, so the endgame is searched over candidates
+  // only, as it must be once every remaining guess has to finish a board.
+  size_t widest = 0;
+  for (const auto &a : active)
+    widest = std::max(widest, a.size());
+  const std::vector<int> ranked =
+      rank_guesses(active, live == R || widest <= 2, used);
+
+  // Per-board outcomes of one guess: (pattern, next candidate set).
+  using Outcomes = std::vector<std::pair<uint16_t, SolverState>>;
+  std::vector<Outcomes> outcomes(boards.size());
+  std::vector<std::vector<int>> bins(Traits::kNumPatterns);
+
+  size_t tried = 0;
+  for (size_t width : kBeamWidths) {
+    const size_t limit = std::min(width, ranked.size());
+    for (size_t i = tried; i < limit; ++i) {
+      const int g = ranked[i];
+      bool progress = false;
+
+      for (size_t b = 0; b < boards.size(); ++b) {
+        outcomes[b].clear();
+        if (active[b].empty()) {
+          outcomes[b].emplace_back(Traits::kSolvedPattern, boards[b]);
+          continue;
+        }
+        for (int s : active[b])
+          bins[table_.get_pattern(g, s)].push_back(s);
+        for (int p = 0; p < Traits::kNumPatterns; ++p) {
+          if (bins[p].empty())
+            continue;
+          SolverState next(table_.num_solutions());
+          if (p != Traits::kSolvedPattern)
+            for (int s : bins[p])
+              next.set(s);
+          if (p == Traits::kSolvedPattern || bins[p].size() < active[b].size())
+            progress = true;
+          outcomes[b].emplace_back(static_cast<uint16_t>(p), std::move(next));
+          bins[p].clear();
+        }
+      }
+      // A guess that changes no board can only waste a turn.
+      if (!progress)
+        continue;
+
+      auto node = std::make_shared<MultiNode>();
+      node->guess_index = static_cast<uint16_t>(g);
+      bool possible = true;
+
+      // Odometer over the cartesian product of per-board outcomes.
+      std::vector<size_t> pick(boards.size(), 0);
+      while (possible) {
+        Boards child(boards.size());
+        uint64_t feedback = 0, scale = 1;
+        bool finished = true;
+        for (size_t b = 0; b < boards.size(); ++b) {
+          const auto &[p, state] = outcomes[b][pick[b]];
+          feedback += p * scale;
+          scale *= Traits::kNumPatterns;
+          child[b] = state;
+          finished &= state.empty();
+        }
+
+        if (!finished) {
+          uint8_t perm = canonicalize_boards(child);
+          auto sub = solve(child, used + 1);
+          if (!sub)
+            possible = false;
+          else
+            node->children.push_back({feedback, perm, std::move(sub)});
+        }
+
+        size_t b = 0;
+        while (b < boards.size() && ++pick[b] == outcomes[b].size())
+          pick[b++] = 0;
+        if (b == boards.size())
+          break;
+      }
+
+      if (possible) {
+        std::sort(node->children.begin(), node->children.end(),
+                  [](const MultiEdge &a, const MultiEdge &b) {
+                    return a.feedback < b.feedback;
+                  });
+        cache_.emplace(std::move(key), node);
+        return node;
+      }
+    }
+    if (limit == ranked.size())
+      break;
+    tried = limit;
+  }
+
+  cache_.emplace(std::move(key), nullptr);
+  return nullptr;
+}
+
+template class MultiBuilder<4>;
+template class MultiBuilder<5>;
+template class MultiBuilder<6>;
+template class MultiBuilder<7>;
+template class MultiBuilder<8>;
+
+namespace {
+
+// Plays one tuple of secrets; returns the number of guesses or -1 on failure.
+int play_multi(const MultiNode *node, const WordList &words,
+               const std::vector<const std::string_view *> &secrets,
+               int max_guesses) {
+  const int n = static_cast<int>(secrets.size());
+  const uint64_t patterns = num_patterns(words.word_length());
+  const uint16_t solved = solved_pattern(words.word_length());
+  int slot[kMaxBoards];
+  bool done[kMaxBoards] = {};
+  for (int b = 0; b < n; ++b)
+    slot[b] = b;
+
+  for (int step = 1; step <= max_guesses && node; ++step) {
+    std::string_view guess = words.get_guesses()[node->guess_index];
+    uint16_t canon[kMaxBoards];
+    bool all_done = true;
+    for (int b = 0; b < n; ++b) {
+      uint16_t p = done[b] ? solved : calc_pattern(guess, *secrets[b]);
+      done[b] = (p == solved);
+      all_done &= done[b];
+      canon[slot[b]] = p;
+    }
+    if (all_done)
+      return step;
+
+    uint64_t feedback = 0, scale = 1;
+    for (int i = 0; i < n; ++i, scale *= patterns)
+      feedback += canon[i] * scale;
+    const MultiEdge *edge = node->find(feedback);
+    if (!edge)
+      return -1;
+    for (int b = 0; b < n; ++b)
+      slot[b] = (edge->perm >> (2 * slot[b])) & 3;
+    node = edge->child.get();
+  }
+  return -1;
+}
+
+} // namespace
+
+MultiTreeStats evaluate_multi_tree(std::shared_ptr<MultiNode> root,
+                                   const WordList &words, int num_boards,
+                                   int max_guesses, size_t limit) {
+  MultiTreeStats stats;
+  const auto &solutions = words.get_solutions();
+  const size_t S = solutions.size();
+
+  double total_tuples = 1.0;
+  for (int b = 0; b < num_boards; ++b)
+    total_tuples *= static_cast<double>(S);
+  stats.exhaustive = total_tuples <= static_cast<double>(limit);
+  const size_t games =
+      stats.exhaustive ? static_cast<size_t>(total_tuples) : limit;
+
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<size_t> pick(0, S - 1);
+  std::vector<const std::string_view *> secrets(num_boards);
+  size_t total_guesses = 0;
+  stats.valid = (root != nullptr);
+
+  for (size_t g = 0; g < games && stats.valid; ++g) {
+    size_t rest = g;
+    for (int b = 0; b < num_boards; ++b) {
+      if (stats.exhaustive) {
+        secrets[b] = &solutions[rest % S];
+        rest /= S;
+      } else {
+        secrets[b] = &solutions[pick(rng)];
+      }
+    }
+    int steps = play_multi(root.get(), words, secrets, max_guesses);
+    if (steps < 0) {
+      stats.valid = false;
+      break;
+    }
+    stats.max_guesses = std::max(stats.max_guesses, steps);
+    total_guesses += steps;
+    ++stats.games;
+  }
+
+  if (stats.games)
+    stats.average = static_cast<double>(total_guesses) / stats.games;
+  return stats;
+}
+
+bool verify_multi_tree(std::shared_ptr<MultiNode> root, const WordList &words,
+                       int num_boards, int max_guesses) {
+  MultiTreeStats stats =
+      evaluate_multi_tree(root, words, num_boards, max_guesses);
+  std::cout << "Verified " << stats.games
+            << (stats.exhaustive ? " (all)" : " (sampled)") << " "
+            << num_boards << "-board games." << std::endl;
+  if (!stats.valid) {
+    std::cerr << "Fail: a game was not finished within " << max_guesses
+              << " guesses." << std::endl;
+    return false;
+  }
+  std::cout << "Verification Passed! Max Guesses: " << stats.max_guesses
+            << std::endl;
+  std::cout << "Average Guesses: " << stats.average << std::endl;
+  return true;
+}
+
+bool write_multi_solution(const std::string &path,
+                          std::shared_ptr<MultiNode> root,
+                          const WordList &words, int num_boards,
+                          int max_guesses) {
+  if (!root)
+    return false;
+
+  // Flatten; shared subtrees are written once.
+  std::vector<const MultiNode *> flat_nodes;
+  std::unordered_map<const MultiNode *, uint32_t> node_map;
+  flat_nodes.push_back(root.get());
+  node_map[root.get()] = 0;
+  size_t num_edges = 0;
+
+  for (size_t head = 0; head < flat_nodes.size(); ++head) {
+    for (const auto &edge : flat_nodes[head]->children) {
+      ++num_edges;
+      if (node_map.emplace(edge.child.get(), flat_nodes.size()).second)
+        flat_nodes.push_back(edge.child.get());
+    }
+  }
+
+  // Load factor at most 1/2 keeps probe sequences short.
+  uint64_t capacity = 2;
+  while (capacity < 2 * num_edges)
+    capacity <<= 1;
+
+  MultiArtifactEdge empty{};
+  empty.parent = kNoChild;
+  std::vector<MultiArtifactEdge> table(capacity, empty);
+  for (uint32_t parent = 0; parent < flat_nodes.size(); ++parent) {
+    for (const auto &edge : flat_nodes[parent]->children) {
+      uint64_t slot = multi_edge_slot(parent, edge.feedback, capacity);
+      while (table[slot].parent != kNoChild)
+        slot = (slot + 1) & (capacity - 1);
+      MultiArtifactEdge &e = table[slot];
+      e.feedback = edge.feedback;
+      e.parent = parent;
+      e.child = node_map[edge.child.get()];
+      e.perm = edge.perm;
+    }
+  }
+
+  std::cout << "Writing " << flat_nodes.size() << " nodes and " << num_edges
+            << " edges to " << path << std::endl;
+
+  std::ofstream out(path, std::ios::binary);
+  if (!out)
+    return false;
+
+  MultiArtifactHeader header;
+  header.checksum = words.get_checksum();
+  header.num_nodes = static_cast<uint32_t>(flat_nodes.size());
+  header.root_index = 0;
+  header.word_length = static_cast<uint32_t>(words.word_length());
+  header.num_patterns = static_cast<uint32_t>(num_patterns(words.word_length()));
+  header.num_boards = static_cast<uint32_t>(num_boards);
+  header.max_guesses = static_cast<uint32_t>(max_guesses);
+  header.num_edges = static_cast<uint32_t>(num_edges);
+  header.edge_capacity = static_cast<uint32_t>(capacity);
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  for (const MultiNode *node : flat_nodes) {
+    ArtifactNode dn{node->guess_index, 0};
+    out.write(reinterpret_cast<const char *>(&dn), sizeof(dn));
+  }
+  out.write(reinterpret_cast<const char *>(table.data()),
+            table.size() * sizeof(MultiArtifactEdge));
+
+  out.close();
+  return static_cast<bool>(out);
+}
+
+} // namespace wordle
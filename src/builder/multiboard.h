@@ -0,0 +1,127 @@
+#pragma once
+#include "entropy.h"
+#include "libwordle_core/patterntable.h"
+#include "libwordle_core/wordlist.h"
+#include "state.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wordle {
+
+struct MultiNode;
+
+// Edge for one feedback tuple. `feedback` packs the per-board patterns in the
+// parent's canonical board order (pattern[i] * 3^(L*i)); `perm` gives the
+// child position of each parent position, 2 bits per board.
+struct MultiEdge {
+  uint64_t feedback = 0;
+  uint8_t perm = 0;
+  std::shared_ptr<MultiNode> child;
+};
+
+struct MultiNode {
+  uint16_t guess_index = 0;
+  // Sorted by feedback. Tuples that finish every board have no edge.
+  std::vector<MultiEdge> children;
+
+  // Returns the edge for `feedback`, or nullptr if it is impossible or final.
+  const MultiEdge *find(uint64_t feedback) const;
+};
+
+// Memo key: board states in canonical order plus guesses left. Sorting the
+// boards lets every permutation of the same states share one subtree.
+struct MultiKey {
+  std::vector<SolverState> boards;
+  int remaining = 0;
+
+  bool operator==(const MultiKey &other) const {
+    return remaining == other.remaining && boards == other.boards;
+  }
+};
+
+struct MultiKeyHash {
+  size_t operator()(const MultiKey &k) const {
+    uint64_t h = static_cast<uint64_t>(k.remaining) * 0x9E3779B97F4A7C15ULL;
+    for (const auto &b : k.boards)
+      h = (h ^ b.hash()) * 1099511628211ULL;
+    return h;
+  }
+};
+
+// Sorts `boards` into canonical order (by candidate count, then bits) and
+// returns the permutation applied: input position i moved to
+// (perm >> 2i) & 3.
+uint8_t canonicalize_boards(std::vector<SolverState> &boards);
+
+// Joint tree builder for N boards (2-4) sharing every guess. A node is a
+// tuple of candidate sets; its children are the cartesian product of the
+// per-board partitions. Like the single-board builder it takes the first
+// guess from a widening beam whose subtrees all fit in the guess budget.
+template <int L> class MultiBuilder {
+public:
+  using Traits = WordTraits<L>;
+  using Table = BasicPatternTable<L>;
+
+  MultiBuilder(const WordList &words, const Table &table, int num_boards,
+               int max_guesses, const std::string &start_word,
+               HeuristicType heuristic = HeuristicType::ENTROPY);
+
+  std::shared_ptr<MultiNode> build();
+
+  size_t memo_size() const { return cache_.size(); }
+
+private:
+  using Boards = std::vector<SolverState>;
+
+  std::shared_ptr<MultiNode> solve(const Boards &boards, int used);
+
+  // Candidate guesses for a node, best first under the joint heuristic.
+  std::vector<int> rank_guesses(const std::vector<std::vector<int>> &active,
+                                bool must_solve, int used) const;
+
+  const WordList &words_;
+  const Table &table_;
+  int num_boards_;
+  int max_guesses_;
+  int start_index_ = -1;
+  HeuristicType heuristic_;
+
+  // Solved (and failed, as nullptr) subtrees.
+  std::unordered_map<MultiKey, std::shared_ptr<MultiNode>, MultiKeyHash>
+      cache_;
+  std::vector<int> solution_to_guess_;
+  std::vector<uint32_t> guess_masks_;
+  std::vector<uint32_t> solution_masks_;
+};
+
+struct MultiTreeStats {
+  bool valid = false;
+  int max_guesses = 0;
+  double average = 0.0;
+  size_t games = 0;
+  bool exhaustive = false; // Every ordered tuple was played, not a sample
+};
+
+// Plays solution tuples through the tree: all of them when there are at most
+// `limit`, otherwise `limit` tuples drawn with a fixed seed.
+MultiTreeStats evaluate_multi_tree(std::shared_ptr<MultiNode> root,
+                                   const WordList &words, int num_boards,
+                                   int max_guesses, size_t limit = 2000000);
+
+bool verify_multi_tree(std::shared_ptr<MultiNode> root, const WordList &words,
+                       int num_boards, int max_guesses);
+
+bool write_multi_solution(const std::string &path,
+                          std::shared_ptr<MultiNode> root,
+                          const WordList &words, int num_boards,
+                          int max_guesses);
+
+extern template class MultiBuilder<4>;
+extern template class MultiBuilder<5>;
+extern template class MultiBuilder<6>;
+extern template class MultiBuilder<7>;
+extern template class MultiBuilder<8>;
+
+} // namespace wordle
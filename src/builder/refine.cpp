@@ -0,0 +1,379 @@
+#include "refine.h"
+#include "entropy.h"
+#include "memo.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace wordle {
+
+namespace {
+
+constexpr long kFail = std::numeric_limits<long>::max();
+
+// Fewest total guesses for n candidates: one may be the next guess, every
+// other one needs at least a second.
+long lower_bound_cost(size_t n) { return n == 1 ? 1 : 2 * long(n) - 1; }
+
+template <int L> struct RefineContext {
+  using Pattern = typename WordTraits<L>::Pattern;
+
+  const WordList &words;
+  const BasicPatternTable<L> &table;
+  std::vector<int> solution_to_guess;
+  std::vector<uint32_t> guess_masks;
+  std::vector<uint32_t> solution_masks;
+  std::chrono::steady_clock::time_point deadline;
+  std::atomic<bool> expired{false};
+
+  RefineContext(const WordList &w, const BasicPatternTable<L> &t)
+      : words(w), table(t) {
+    const auto &guesses = words.get_guesses();
+    for (std::string_view s : words.get_solutions())
+      solution_to_guess.push_back(static_cast<int>(
+          std::lower_bound(guesses.begin(), guesses.end(), s) -
+          guesses.begin()));
+    auto mask = [](const auto &w) {
+      uint32_t m = 0;
+      for (int i = 0; i < L; ++i)
+        m |= 1u << w.chars[i];
+      return m;
+    };
+    for (size_t i = 0; i < guesses.size(); ++i)
+      guess_masks.push_back(mask(words.guesses_as<L>()[i]));
+    for (size_t i = 0; i < words.get_solutions().size(); ++i)
+      solution_masks.push_back(mask(words.solutions_as<L>()[i]));
+  }
+
+  // Total guesses `set` takes from `node` at `depth`, or kFail if a
+  // candidate is not solved within the six-guess limit.
+  long cost(const MemoryNode *node, const std::vector<int> &set,
+            int depth) const {
+    long total = 0;
+    for (int s : set) {
+      const MemoryNode *n = node;
+      for (int d = depth + 1;; ++d) {
+        if (d > 6 || !n)
+          return kFail;
+        const Pattern p = table.get_pattern(n->guess_index, s);
+        if (p == WordTraits<L>::kSolvedPattern) {
+          total += d - depth;
+          break;
+        }
+        n = n->child(p).get();
+      }
+    }
+    return total;
+  }
+};
+
+// Branch and bound over one worker's subtrees, memoised by (candidates,
+// remaining guesses). An entry either holds the cheapest subtree among the
+// guesses tried or a bound no subtree beats.
+template <int L> class SubtreeSearch {
+public:
+  using Pattern = typename WordTraits<L>::Pattern;
+
+  SubtreeSearch(RefineContext<L> &ctx, size_t width)
+      : ctx_(ctx), width_(width) {}
+
+  // Cheapest subtree for `set` with `R` guesses left costing less than
+  // `budget`, or kFail.
+  long solve(const std::vector<int> &set, int R, long budget,
+             std::shared_ptr<MemoryNode> &out) {
+    const size_t n = set.size();
+    if (n == 1) {
+      if (budget <= 1)
+        return kFail;
+      out = std::make_shared<MemoryNode>();
+      out->guess_index = ctx_.solution_to_guess[set[0]];
+      out->is_leaf = true;
+      return 1;
+    }
+    if (R <= 1 || lower_bound_cost(n) >= budget || expired())
+      return kFail;
+
+    SolverState state(ctx_.words.get_solutions().size());
+    for (int s : set)
+      state.set(s);
+    MemoKey key{state, R};
+    auto it = memo_.find(key);
+    if (it != memo_.end()) {
+      if (it->second.node) {
+        if (it->second.cost >= budget)
+          return kFail;
+        out = it->second.node;
+        return it->second.cost;
+      }
+      if (it->second.cost >= budget)
+        return kFail;
+    }
+
+    long best = budget;
+    std::shared_ptr<MemoryNode> best_node;
+    std::vector<std::pair<Pattern, int>> parts(n);
+    std::vector<std::pair<size_t, size_t>> buckets;
+    for (int g : rank(set, R)) {
+      for (size_t i = 0; i < n; ++i)
+        parts[i] = {ctx_.table.get_pattern(g, set[i]), set[i]};
+      std::sort(parts.begin(), parts.end());
+
+      buckets.clear();
+      long rest = 0; // Lower bound of the buckets not yet solved
+      for (size_t b = 0, e; b < n; b = e) {
+        for (e = b + 1; e < n && parts[e].first == parts[b].first;)
+          ++e;
+        if (parts[b].first == WordTraits<L>::kSolvedPattern)
+          continue;
+        buckets.emplace_back(b, e);
+        rest += lower_bound_cost(e - b);
+      }
+      if (buckets.size() == 1 && buckets[0].second - buckets[0].first == n)
+        continue; // No information
+      if (long(n) + rest >= best)
+        continue;
+
+      auto node = std::make_shared<MemoryNode>();
+      node->guess_index = static_cast<uint16_t>(g);
+      long total = n;
+      std::vector<int> child_set;
+      for (auto [b, e] : buckets) {
+        rest -= lower_bound_cost(e - b);
+        child_set.clear();
+        for (size_t i = b; i < e; ++i)
+          child_set.push_back(parts[i].second);
+        std::shared_ptr<MemoryNode> child;
+        long c = solve(child_set, R - 1, best - total - rest, child);
+        if (c == kFail) {
+          total = kFail;
+          break;
+        }
+        total += c;
+        node->children.emplace_back(static_cast<uint16_t>(parts[b].first),
+                                    child);
+      }
+      if (total < best) {
+        best = total;
+        best_node = std::move(node);
+      }
+    }
+
+    // A search cut short by the deadline proves nothing about the bound.
+    if (!expired()) {
+      Entry &entry = memo_[key];
+      if (best_node)
+        entry = {best, best_node};
+      else if (!entry.node)
+        entry.cost = std::max(entry.cost, budget);
+    }
+    if (!best_node)
+      return kFail;
+    out = best_node;
+    return best;
+  }
+
+private:
+  struct Entry {
+    long cost = 0; // Subtree cost, or the bound when node is null
+    std::shared_ptr<MemoryNode> node;
+  };
+
+  bool expired() {
+    if ((++calls_ & 255) == 0 &&
+        std::chrono::steady_clock::now() >= ctx_.deadline)
+      ctx_.expired = true;
+    return ctx_.expired.load(std::memory_order_relaxed);
+  }
+
+  // The `width_` lowest expected-cost guesses sharing a letter with the
+  // candidates, then up to as many candidates (which may win outright),
+  // cheapest first. With two guesses left only full splits can work.
+  std::vector<int> rank(const std::vector<int> &set, int R) const {
+    uint32_t active_mask = 0;
+    for (int s : set)
+      active_mask |= ctx_.solution_masks[s];
+    std::vector<int> guesses;
+    for (size_t g = 0; g < ctx_.guess_masks.size(); ++g)
+      if (ctx_.guess_masks[g] & active_mask)
+        guesses.push_back(static_cast<int>(g));
+    std::vector<GuessStats> stats(guesses.size());
+    score_guesses(set, guesses.data(), guesses.size(), ctx_.table,
+                  stats.data());
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < guesses.size(); ++i)
+      if (R > 2 || stats[i].max_bucket == 1)
+        order.push_back(i);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      if (stats[a].expected_cost != stats[b].expected_cost)
+        return stats[a].expected_cost < stats[b].expected_cost;
+      return a < b;
+    });
+
+    std::vector<int> members;
+    for (int s : set)
+      members.push_back(ctx_.solution_to_guess[s]);
+    std::sort(members.begin(), members.end());
+
+    std::vector<int> out;
+    size_t others = 0, own = 0;
+    for (size_t i : order) {
+      size_t &taken =
+          std::binary_search(members.begin(), members.end(), guesses[i])
+              ? own
+              : others;
+      if (taken < width_) {
+        ++taken;
+        out.push_back(guesses[i]);
+      }
+    }
+    return out;
+  }
+
+  RefineContext<L> &ctx_;
+  size_t width_;
+  unsigned int calls_ = 0;
+  std::unordered_map<MemoKey, Entry, MemoKeyHash> memo_;
+};
+
+// One subtree to re-solve in a pass.
+struct RefineItem {
+  const MemoryNode *node;
+  std::vector<int> set;
+  int depth;
+  long cost;
+  std::shared_ptr<MemoryNode> replacement;
+};
+
+template <int L>
+void collect(const RefineContext<L> &ctx, const MemoryNode *node,
+             const std::vector<int> &set, int depth, size_t cap,
+             std::vector<RefineItem> &items) {
+  if (node->is_leaf)
+    return;
+  if (depth > 0 && set.size() <= cap) {
+    long cost = ctx.cost(node, set, depth);
+    if (cost > lower_bound_cost(set.size()))
+      items.push_back({node, set, depth, cost, nullptr});
+    return;
+  }
+  std::vector<std::pair<uint16_t, int>> parts;
+  for (int s : set)
+    parts.emplace_back(ctx.table.get_pattern(node->guess_index, s), s);
+  std::sort(parts.begin(), parts.end());
+  std::vector<int> child_set;
+  for (size_t b = 0, e; b < parts.size(); b = e) {
+    child_set.clear();
+    for (e = b; e < parts.size() && parts[e].first == parts[b].first; ++e)
+      child_set.push_back(parts[e].second);
+    if (auto child = node->child(parts[b].first))
+      collect(ctx, child.get(), child_set, depth + 1, cap, items);
+  }
+}
+
+// Copies the paths down to replaced nodes; everything else is shared.
+std::shared_ptr<MemoryNode> rebuild(
+    const std::shared_ptr<MemoryNode> &node,
+    const std::unordered_map<const MemoryNode *, std::shared_ptr<MemoryNode>>
+        &replacements) {
+  auto it = replacements.find(node.get());
+  if (it != replacements.end())
+    return it->second;
+  std::shared_ptr<MemoryNode> copy;
+  for (size_t i = 0; i < node->children.size(); ++i) {
+    auto child = rebuild(node->children[i].second, replacements);
+    if (child == node->children[i].second)
+      continue;
+    if (!copy)
+      copy = std::make_shared<MemoryNode>(*node);
+    copy->children[i].second = std::move(child);
+  }
+  return copy ? copy : node;
+}
+
+} // namespace
+
+template <int L>
+std::shared_ptr<MemoryNode>
+refine_tree(std::shared_ptr<MemoryNode> root, const WordList &words,
+            const BasicPatternTable<L> &table, std::chrono::milliseconds budget,
+            unsigned int num_threads, RefineStats &stats) {
+  RefineContext<L> ctx(words, table);
+  ctx.deadline = std::chrono::steady_clock::now() + budget;
+  num_threads = std::max(1u, num_threads);
+
+  std::vector<int> all(words.get_solutions().size());
+  for (size_t i = 0; i < all.size(); ++i)
+    all[i] = static_cast<int>(i);
+  stats.guesses_before = ctx.cost(root.get(), all, 0);
+  stats.guesses_after = stats.guesses_before;
+
+  for (size_t width = 8, cap = 32; !ctx.expired; width *= 2, cap *= 2) {
+    std::vector<RefineItem> items;
+    collect(ctx, root.get(), all, 0, cap, items);
+    std::sort(items.begin(), items.end(),
+              [](const RefineItem &a, const RefineItem &b) {
+                return a.cost - lower_bound_cost(a.set.size()) >
+                       b.cost - lower_bound_cost(b.set.size());
+              });
+    ++stats.passes;
+
+    std::atomic<size_t> next{0}, searched{0};
+    auto worker = [&]() {
+      SubtreeSearch<L> search(ctx, width);
+      for (size_t i = next++; i < items.size() && !ctx.expired; i = next++) {
+        RefineItem &item = items[i];
+        std::shared_ptr<MemoryNode> node;
+        long cost = search.solve(item.set, 6 - item.depth, item.cost, node);
+        if (ctx.expired)
+          break;
+        ++searched;
+        // Trust only what replays: fewer guesses, every candidate in time.
+        if (cost != kFail && ctx.cost(node.get(), item.set, item.depth) == cost)
+          item.replacement = node;
+      }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < num_threads; ++t)
+      threads.emplace_back(worker);
+    worker();
+    for (auto &t : threads)
+      t.join();
+
+    // Items are disjoint subtrees, so every improvement applies.
+    std::unordered_map<const MemoryNode *, std::shared_ptr<MemoryNode>>
+        replacements;
+    for (const auto &item : items)
+      if (item.replacement)
+        replacements.emplace(item.node, item.replacement);
+    stats.searched += searched;
+    stats.improved += replacements.size();
+    if (!replacements.empty()) {
+      root = rebuild(root, replacements);
+      stats.guesses_after = ctx.cost(root.get(), all, 0);
+    }
+
+    // Exhaustive: every candidate set and every guess already covered.
+    if (cap >= all.size() && width >= words.get_guesses().size())
+      break;
+  }
+  stats.timed_out = ctx.expired;
+  return root;
+}
+
+#define WORDLE_INSTANTIATE_REFINE(L)                                          \
+  template std::shared_ptr<MemoryNode> refine_tree<L>(                         \
+      std::shared_ptr<MemoryNode>, const WordList &,                           \
+      const BasicPatternTable<L> &, std::chrono::milliseconds, unsigned int,  \
+      RefineStats &);
+
+WORDLE_INSTANTIATE_REFINE(4)
+WORDLE_INSTANTIATE_REFINE(5)
+WORDLE_INSTANTIATE_REFINE(6)
+WORDLE_INSTANTIATE_REFINE(7)
+WORDLE_INSTANTIATE_REFINE(8)
+
+} // namespace wordle
@@ -0,0 +1,39 @@
+#pragma once
+#include "builder.h"
+#include "libwordle_core/patterntable.h"
+#include "libwordle_core/wordlist.h"
+#include <chrono>
+#include <memory>
+
+namespace wordle {
+
+struct RefineStats {
+  int passes = 0;          // Passes started
+  size_t searched = 0;     // Subtrees re-solved to completion
+  size_t improved = 0;     // Of those, swapped in
+  long guesses_before = 0; // Total guesses over all solutions
+  long guesses_after = 0;
+  bool timed_out = false; // Stopped by the budget, not by running out of work
+};
+
+// Anytime improvement of a finished tree. The builder commits to the first
+// guess that fits the depth limit; this pass re-solves subtrees with a
+// branch-and-bound search that minimises total guesses (ties to the cheapest
+// ranked guess), trying the `width` lowest expected-cost guesses plus as many
+// candidates at every node.
+//
+// Each pass takes the topmost subtrees below the root with at most `cap`
+// candidates, most reach-weighted slack (guesses over the 2n - 1 lower bound)
+// first, and searches them on `num_threads` workers with the current cost as
+// the bound to beat. A result is swapped in only if replaying its candidates
+// through it gives fewer guesses within the depth limit. Later passes double
+// `width` and `cap`. When `budget` runs out the searches in flight are
+// abandoned and the best tree so far is returned; the input tree is never
+// modified (changed paths are copied), and the root guess is kept.
+template <int L>
+std::shared_ptr<MemoryNode>
+refine_tree(std::shared_ptr<MemoryNode> root, const WordList &words,
+            const BasicPatternTable<L> &table, std::chrono::milliseconds budget,
+            unsigned int num_threads, RefineStats &stats);
+
+} // namespace wordle
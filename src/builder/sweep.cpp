@@ -0,0 +1,225 @@
+#include "sweep.h"
+#include "builder.h"
+#include "verify.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace wordle {
+
+namespace {
+
+bool is_word(const std::string &token) {
+  return !token.empty() &&
+         std::all_of(token.begin(), token.end(),
+                     [](unsigned char c) { return std::isalpha(c); });
+}
+
+template <int L>
+std::vector<std::string> top_entropy_openers(const WordList &words,
+                                             const BasicPatternTable<L> &table,
+                                             size_t n) {
+  const auto &guesses = words.get_guesses();
+  SolverState all_solutions(words.get_solutions().size());
+  for (size_t i = 0; i < words.get_solutions().size(); ++i)
+    all_solutions.set(i);
+
+  std::vector<int> active = all_solutions.get_active_indices();
+  std::vector<int> order(guesses.size());
+  for (size_t i = 0; i < guesses.size(); ++i)
+    order[i] = static_cast<int>(i);
+
+  std::vector<GuessStats> stats(guesses.size());
+  score_guesses(active, order.data(), order.size(), table, stats.data());
+
+  n = std::min(n, order.size());
+  std::partial_sort(order.begin(), order.begin() + n, order.end(),
+                    [&](int a, int b) {
+                      if (stats[a].entropy != stats[b].entropy)
+                        return stats[a].entropy > stats[b].entropy;
+                      return a < b;
+                    });
+
+  std::vector<std::string> out;
+  out.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+    out.emplace_back(guesses[order[i]]);
+  return out;
+}
+
+} // namespace
+
+template <int L>
+bool resolve_sweep_openers(const std::string &spec, const WordList &words,
+                           const BasicPatternTable<L> &table,
+                           std::vector<std::string> &out) {
+  out.clear();
+
+  if (spec.rfind("top-", 0) == 0) {
+    std::string count = spec.substr(4);
+    if (count.empty() ||
+        !std::all_of(count.begin(), count.end(),
+                     [](unsigned char c) { return std::isdigit(c); })) {
+      std::cerr << "Invalid sweep spec: " << spec << std::endl;
+      return false;
+    }
+    out = top_entropy_openers(words, table, std::stoul(count));
+    return true;
+  }
+
+  std::ifstream f(spec);
+  if (!f.is_open()) {
+    std::cerr << "Failed to open file: " << spec << std::endl;
+    return false;
+  }
+
+  const auto &guesses = words.get_guesses();
+  std::string line;
+  while (std::getline(f, line)) {
+    std::istringstream tokens(line);
+    std::string word;
+    tokens >> word;
+    std::transform(word.begin(), word.end(), word.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    if (!is_word(word) || word.size() != words.word_length())
+      continue;
+    if (!std::binary_search(guesses.begin(), guesses.end(), word)) {
+      // Header lines of rank_openers output ("Top", "Ranking", ...) end up
+      // here too, so this is only worth a note for 5-letter tokens.
+      if (word.size() == words.word_length())
+        std::cerr << "Warning: Skipping opener '" << word
+                  << "' (not in guesses)" << std::endl;
+      continue;
+    }
+    if (std::find(out.begin(), out.end(), word) == out.end())
+      out.push_back(word);
+  }
+  return true;
+}
+
+template <int L>
+std::vector<SweepResult> sweep_openers(const WordList &words,
+                                       const BasicPatternTable<L> &table,
+                                       const std::vector<std::string> &openers,
+                                       HeuristicType heuristic,
+                                       unsigned int num_threads,
+                                       std::shared_ptr<Memo> memo,
+                                       const MemoStore *store) {
+  std::vector<SweepResult> results(openers.size());
+
+  if (num_threads == 0)
+    num_threads = 1;
+  num_threads = std::min<unsigned int>(num_threads, openers.size());
+
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> done{0};
+  std::mutex print_mutex;
+
+  // Each worker builds whole trees. Scoring inside a build stays serial:
+  // parallelism comes from running openers side by side, and the builds
+  // never wait on the shared thread pool.
+  auto worker = [&]() {
+    for (size_t i = next++; i < openers.size(); i = next++) {
+      SweepResult &r = results[i];
+      r.opener = openers[i];
+
+      auto start = std::chrono::high_resolution_clock::now();
+      BasicBuilder<L> builder(words, table, openers[i], heuristic, memo);
+      builder.set_parallel_scoring(false);
+      builder.set_memo_store(store);
+      auto root = builder.build();
+      auto end = std::chrono::high_resolution_clock::now();
+      r.build_ms =
+          std::chrono::duration<double, std::milli>(end - start).count();
+
+      if (root) {
+        TreeStats stats = evaluate_tree(root, words);
+        r.success = stats.valid;
+        r.average = stats.average;
+        r.max_depth = stats.max_depth;
+      }
+
+      std::ostringstream line;
+      line << std::fixed << std::setprecision(5) << r.opener;
+      if (r.success)
+        line << " avg " << r.average << " max " << r.max_depth;
+      else
+        line << " failed";
+      line << " (" << std::setprecision(0) << r.build_ms << " ms)";
+
+      std::lock_guard<std::mutex> lock(print_mutex);
+      std::cout << "[" << ++done << "/" << openers.size() << "] "
+                << line.str() << std::endl;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < num_threads; ++t)
+    threads.emplace_back(worker);
+  for (auto &t : threads)
+    t.join();
+
+  std::stable_sort(results.begin(), results.end(),
+                   [](const SweepResult &a, const SweepResult &b) {
+                     if (a.success != b.success)
+                       return a.success;
+                     return a.average < b.average;
+                   });
+  return results;
+}
+
+bool write_sweep_results(const std::string &path,
+                         const std::vector<SweepResult> &results) {
+  std::ofstream out(path);
+  if (!out)
+    return false;
+
+  bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+  out << std::fixed;
+
+  if (json) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+      const auto &r = results[i];
+      out << "  {\"opener\": \"" << r.opener << "\", \"success\": "
+          << (r.success ? "true" : "false") << ", \"average_guesses\": "
+          << std::setprecision(5) << r.average
+          << ", \"max_depth\": " << r.max_depth
+          << ", \"build_ms\": " << std::setprecision(1) << r.build_ms << "}"
+          << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+  } else {
+    out << "opener,success,average_guesses,max_depth,build_ms\n";
+    for (const auto &r : results) {
+      out << r.opener << "," << (r.success ? 1 : 0) << ","
+          << std::setprecision(5) << r.average << "," << r.max_depth << ","
+          << std::setprecision(1) << r.build_ms << "\n";
+    }
+  }
+  return static_cast<bool>(out);
+}
+
+#define WORDLE_INSTANTIATE_SWEEP(L)                                           \
+  template bool resolve_sweep_openers<L>(                                      \
+      const std::string &, const WordList &, const BasicPatternTable<L> &,     \
+      std::vector<std::string> &);                                             \
+  template std::vector<SweepResult> sweep_openers<L>(                          \
+      const WordList &, const BasicPatternTable<L> &,                          \
+      const std::vector<std::string> &, HeuristicType, unsigned int,           \
+      std::shared_ptr<Memo>, const MemoStore *);
+
+WORDLE_INSTANTIATE_SWEEP(4)
+WORDLE_INSTANTIATE_SWEEP(5)
+WORDLE_INSTANTIATE_SWEEP(6)
+WORDLE_INSTANTIATE_SWEEP(7)
+WORDLE_INSTANTIATE_SWEEP(8)
+
+} // namespace wordle
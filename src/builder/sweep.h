@@ -0,0 +1,47 @@
+#pragma once
+#include "entropy.h"
+#include "memo.h"
+#include "libwordle_core/patterntable.h"
+#include "libwordle_core/wordlist.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace wordle {
+
+class MemoStore;
+
+struct SweepResult {
+  std::string opener;
+  bool success = false;
+  double average = 0.0;
+  int max_depth = 0;
+  double build_ms = 0.0;
+};
+
+// Resolves a --sweep-openers argument: "top-N" selects the N highest-entropy
+// openers, anything else is read as a file with one word per line (the first
+// token of each line, so rank_openers output works as-is).
+template <int L>
+bool resolve_sweep_openers(const std::string &spec, const WordList &words,
+                           const BasicPatternTable<L> &table,
+                           std::vector<std::string> &out);
+
+// Builds and evaluates a tree for every opener in one process. All builds
+// share `table` and `memo` (and `store`, if given), and up to `num_threads`
+// openers run concurrently. Results are sorted by average guesses (failures
+// last).
+template <int L>
+std::vector<SweepResult> sweep_openers(const WordList &words,
+                                       const BasicPatternTable<L> &table,
+                                       const std::vector<std::string> &openers,
+                                       HeuristicType heuristic,
+                                       unsigned int num_threads,
+                                       std::shared_ptr<Memo> memo,
+                                       const MemoStore *store = nullptr);
+
+// Writes results as JSON if `path` ends in ".json", CSV otherwise.
+bool write_sweep_results(const std::string &path,
+                         const std::vector<SweepResult> &results);
+
+} // namespace wordle
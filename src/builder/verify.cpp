@@ -1,22 +1,35 @@
 #include "verify.h"
+#include "libwordle_core/artifact.h"
 #include "libwordle_core/pattern.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
 #include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace wordle {
 
-bool verify_tree(std::shared_ptr<MemoryNode> root, const WordList &words) {
+namespace {
+
+TreeStats walk_tree(std::shared_ptr<MemoryNode> root, const WordList &words,
+                    bool verbose) {
   int max_depth = 0;
   size_t total_guesses = 0;
   bool all_valid = true;
 
   const auto &solutions = words.get_solutions();
   const auto &guesses = words.get_guesses();
+  const uint16_t solved = solved_pattern(words.word_length());
 
-  std::cout << "Verifying tree against " << solutions.size() << " solutions..."
-            << std::endl;
+  if (verbose)
+    std::cout << "Verifying tree against " << solutions.size()
+              << " solutions..." << std::endl;
 
   for (size_t s_idx = 0; s_idx < solutions.size(); ++s_idx) {
-    const std::string &secret = solutions[s_idx];
+    std::string_view secret = solutions[s_idx];
 
     auto node = root;
     int depth = 0;
@@ -24,34 +37,39 @@ bool verify_tree(std::shared_ptr<MemoryNode> root, const WordList &words) {
 
     while (node) {
       depth++;
-      const std::string &guess = guesses[node->guess_index];
-      uint8_t p = calc_pattern(guess, secret);
+      std::string_view guess = guesses[node->guess_index];
+      uint16_t p = calc_pattern(guess, secret);
 
-      if (p == 242) { // GGGGG
+      if (p == solved) { // All green
         // Game over.
         found = true;
         break;
       }
 
       if (depth >= 6) {
-        std::cerr << "Fail: Depth limit exceeded for " << secret
-                  << " (Last guess: " << guess << ")" << std::endl;
+        if (verbose)
+          std::cerr << "Fail: Depth limit exceeded for " << secret
+                    << " (Last guess: " << guess << ")" << std::endl;
         all_valid = false;
         break;
       }
 
       // Transition
-      if (p >= node->children.size() || !node->children[p]) {
-        std::cerr << "Fail: Invalid transition for " << secret << " at guess "
-                  << guess << " pattern " << (int)p << std::endl;
+      auto next = node->child(p);
+      if (!next) {
+        if (verbose)
+          std::cerr << "Fail: Invalid transition for " << secret
+                    << " at guess " << guess << " pattern " << (int)p
+                    << std::endl;
         all_valid = false;
         break;
       }
-      node = node->children[p];
+      node = next;
     }
 
     if (!found && all_valid) {
-      std::cerr << "Fail: Did not find " << secret << std::endl;
+      if (verbose)
+        std::cerr << "Fail: Did not find " << secret << std::endl;
       all_valid = false;
     }
     if (depth > max_depth)
@@ -59,14 +77,508 @@ bool verify_tree(std::shared_ptr<MemoryNode> root, const WordList &words) {
     total_guesses += depth;
   }
 
-  if (all_valid) {
-    double average = static_cast<double>(total_guesses) / solutions.size();
-    std::cout << "Verification Passed! Max Depth: " << max_depth << std::endl;
-    std::cout << "Average Guesses: " << average << std::endl;
+  TreeStats stats;
+  stats.valid = all_valid;
+  stats.max_depth = max_depth;
+  stats.average = static_cast<double>(total_guesses) / solutions.size();
+  return stats;
+}
+
+} // namespace
+
+TreeStats evaluate_tree(std::shared_ptr<MemoryNode> root,
+                        const WordList &words) {
+  return walk_tree(root, words, false);
+}
+
+bool verify_tree(std::shared_ptr<MemoryNode> root, const WordList &words) {
+  TreeStats stats = walk_tree(root, words, true);
+  if (stats.valid) {
+    std::cout << "Verification Passed! Max Depth: " << stats.max_depth
+              << std::endl;
+    std::cout << "Average Guesses: " << stats.average << std::endl;
   } else {
     std::cout << "Verification FAILED." << std::endl;
   }
-  return all_valid;
+  return stats.valid;
+}
+
+namespace {
+
+// Read-only mapping of a whole file, unmapped on scope exit.
+struct MappedFile {
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+
+  bool map(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+      std::cerr << "Failed to open file: " << path << std::endl;
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
+      std::cerr << "Failed to get file size for: " << path << std::endl;
+      close(fd);
+      return false;
+    }
+    void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+      std::cerr << "Failed to mmap file: " << path << std::endl;
+      return false;
+    }
+    data = static_cast<const uint8_t *>(mapped);
+    size = st.st_size;
+    return true;
+  }
+
+  ~MappedFile() {
+    if (data)
+      munmap(const_cast<uint8_t *>(data), size);
+  }
+};
+
+// One thread's share of the work.
+struct ArtifactShard {
+  std::vector<size_t> histogram;
+  size_t failures = 0;
+  std::string first_error;
+
+  void fail(const std::string &msg) {
+    if (failures++ == 0)
+      first_error = msg;
+  }
+};
+
+// Checks the embedded word tables at `words_offset` against the lists.
+template <int L>
+bool check_words(const MappedFile &file, const WordList &words,
+                 uint32_t num_guesses, uint32_t num_solutions,
+                 uint64_t words_offset, size_t tree_end) {
+  const size_t G = words.get_guesses().size();
+  const size_t S = words.get_solutions().size();
+  if (num_guesses != G || num_solutions != S || words_offset < tree_end ||
+      words_offset > file.size || (2 * G + S) * L > file.size - words_offset) {
+    std::cerr << "Embedded word tables do not fit or do not match the lists"
+              << std::endl;
+    return false;
+  }
+  const uint8_t *text = file.data + words_offset;
+  bool same =
+      std::memcmp(text + G * L, words.packed_guesses().data(), G * L) == 0 &&
+      std::memcmp(text + 2 * G * L, words.packed_solutions().data(), S * L) ==
+          0;
+  for (size_t g = 0; same && g < G; ++g)
+    same = std::memcmp(text + g * L, words.get_guesses()[g].data(), L) == 0;
+  if (!same) {
+    std::cerr << "Embedded word tables differ from the lists" << std::endl;
+    return false;
+  }
+  return true;
 }
 
+// Checks the candidate ranges after the children: `order` is a permutation
+// of the solutions, and every node's range holds exactly the solutions that
+// reach it. Runs after check_tree(), so the walk is safe.
+template <int L>
+bool check_ranges(const MappedFile &file, const ArtifactNode *nodes,
+                  const uint32_t *children, uint32_t num_nodes, uint32_t root,
+                  const WordList &words, uint32_t num_solutions,
+                  size_t tree_end, uint64_t words_offset, bool has_words) {
+  using Pattern = typename WordTraits<L>::Pattern;
+  constexpr Pattern kSolved = WordTraits<L>::kSolvedPattern;
+  constexpr uint32_t kPatterns = WordTraits<L>::kNumPatterns;
+  const size_t S = words.get_solutions().size();
+  const size_t bytes =
+      num_nodes * sizeof(ArtifactRange) + S * sizeof(uint32_t);
+  if (num_solutions != S || bytes > file.size - tree_end ||
+      (has_words && words_offset < tree_end + bytes)) {
+    std::cerr << "Candidate ranges do not fit or do not match the lists"
+              << std::endl;
+    return false;
+  }
+  const auto *ranges =
+      reinterpret_cast<const ArtifactRange *>(file.data + tree_end);
+  const auto *order = reinterpret_cast<const uint32_t *>(
+      file.data + tree_end + num_nodes * sizeof(ArtifactRange));
+
+  std::vector<uint32_t> position(S, UINT32_MAX);
+  for (uint32_t i = 0; i < S; ++i) {
+    if (order[i] >= S || position[order[i]] != UINT32_MAX) {
+      std::cerr << "Candidate order is not a permutation of the solutions"
+                << std::endl;
+      return false;
+    }
+    position[order[i]] = i;
+  }
+
+  const auto *guesses = words.guesses_as<L>();
+  const auto *solutions = words.solutions_as<L>();
+  std::vector<uint32_t> reached(num_nodes, 0);
+  for (uint32_t s = 0; s < S; ++s) {
+    for (uint32_t node = root;;) {
+      const ArtifactRange &range = ranges[node];
+      if (position[s] < range.begin || position[s] >= range.end) {
+        std::cerr << "Solution " << words.get_solutions()[s]
+                  << " lies outside the range of node " << node << std::endl;
+        return false;
+      }
+      ++reached[node];
+      Pattern p = calc_pattern<L>(guesses[nodes[node].guess_index],
+                                  solutions[s]);
+      if (p == kSolved)
+        break;
+      node = children[node * size_t(kPatterns) + p];
+    }
+  }
+  for (uint32_t n = 0; n < num_nodes; ++n) {
+    if (ranges[n].end - ranges[n].begin != reached[n]) {
+      std::cerr << "Node " << n << " range holds "
+                << ranges[n].end - ranges[n].begin << " solutions, "
+                << reached[n] << " reach it" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Runs check(t) for every t < num_threads, t > 0 on their own threads.
+template <class F>
+std::vector<ArtifactShard> run_shards(unsigned int num_threads, F &&check) {
+  std::vector<std::future<ArtifactShard>> futures;
+  for (unsigned int t = 1; t < num_threads; ++t)
+    futures.push_back(std::async(std::launch::async, check, t));
+  std::vector<ArtifactShard> shards;
+  shards.push_back(check(0));
+  for (auto &f : futures)
+    shards.push_back(f.get());
+  return shards;
+}
+
+// Checks every guess and child index of the node pool, split across
+// threads. Must pass before any tree in the pool is walked: a bad index in
+// one thread's slice can be reached from every solution.
+template <int L>
+bool check_nodes(const ArtifactNode *nodes, const uint32_t *children,
+                 uint32_t num_nodes, const WordList &words,
+                 unsigned int num_threads) {
+  constexpr uint32_t kPatterns = WordTraits<L>::kNumPatterns;
+  const size_t num_guesses = words.get_guesses().size();
+  num_threads = std::max(1u, num_threads);
+
+  auto shards = run_shards(num_threads, [&](unsigned int t) {
+    ArtifactShard shard;
+    size_t n_begin = num_nodes * size_t(t) / num_threads;
+    size_t n_end = num_nodes * size_t(t + 1) / num_threads;
+    for (size_t n = n_begin; n < n_end; ++n) {
+      if (nodes[n].guess_index >= num_guesses)
+        shard.fail("Node " + std::to_string(n) + " guess index " +
+                   std::to_string(nodes[n].guess_index) + " out of bounds");
+      const uint32_t *row = children + n * kPatterns;
+      for (uint32_t p = 0; p < kPatterns; ++p)
+        if (row[p] != kNoChild && row[p] >= num_nodes)
+          shard.fail("Node " + std::to_string(n) + " child " +
+                     std::to_string(row[p]) + " out of bounds");
+    }
+    return shard;
+  });
+
+  size_t failures = 0;
+  for (const auto &shard : shards) {
+    if (shard.failures && failures == 0)
+      std::cerr << "Fail: " << shard.first_error << std::endl;
+    failures += shard.failures;
+  }
+  if (failures > 1)
+    std::cerr << "(" << failures - 1 << " more failures)" << std::endl;
+  return failures == 0;
+}
+
+// Game play from `root`, split across threads. The indices must already
+// have passed check_nodes().
+template <int L>
+ArtifactStats check_tree(const ArtifactNode *nodes, const uint32_t *children,
+                         uint32_t root, const WordList &words,
+                         unsigned int num_threads, int max_guesses) {
+  using Pattern = typename WordTraits<L>::Pattern;
+  constexpr Pattern kSolved = WordTraits<L>::kSolvedPattern;
+  constexpr uint32_t kPatterns = WordTraits<L>::kNumPatterns;
+  ArtifactStats stats;
+
+  const auto *guesses = words.guesses_as<L>();
+  const auto *solutions = words.solutions_as<L>();
+  const size_t num_solutions = words.get_solutions().size();
+  num_threads = std::max(1u, num_threads);
+
+  auto check = [&](unsigned int t) {
+    ArtifactShard shard;
+    shard.histogram.assign(max_guesses + 1, 0);
+
+    size_t s_begin = num_solutions * t / num_threads;
+    size_t s_end = num_solutions * (t + 1) / num_threads;
+    for (size_t s = s_begin; s < s_end; ++s) {
+      uint32_t node = root;
+      for (int depth = 1;; ++depth) {
+        Pattern p = calc_pattern<L>(guesses[nodes[node].guess_index],
+                                    solutions[s]);
+        if (p == kSolved) {
+          ++shard.histogram[depth];
+          break;
+        }
+        uint32_t next = children[node * size_t(kPatterns) + p];
+        if (depth >= max_guesses || next == kNoChild) {
+          shard.fail("Solution " + std::string(words.get_solutions()[s]) +
+                     (next == kNoChild ? " hits a missing child"
+                                       : " is not solved in " +
+                                             std::to_string(max_guesses)) +
+                     " at node " + std::to_string(node));
+          break;
+        }
+        node = next;
+      }
+    }
+    return shard;
+  };
+
+  auto shards = run_shards(num_threads, check);
+
+  stats.depth_histogram.assign(max_guesses + 1, 0);
+  size_t failures = 0, total = 0;
+  for (const auto &shard : shards) {
+    if (shard.failures && failures == 0)
+      std::cerr << "Fail: " << shard.first_error << std::endl;
+    failures += shard.failures;
+    for (int d = 0; d <= max_guesses; ++d) {
+      stats.depth_histogram[d] += shard.histogram[d];
+      total += shard.histogram[d] * d;
+      if (shard.histogram[d])
+        stats.max_depth = std::max(stats.max_depth, d);
+    }
+  }
+  if (failures > 1)
+    std::cerr << "(" << failures - 1 << " more failures)" << std::endl;
+  stats.valid = failures == 0;
+  stats.average = num_solutions ? static_cast<double>(total) / num_solutions
+                                : 0.0;
+  return stats;
+}
+
+} // namespace
+
+template <int L>
+ArtifactStats verify_artifact(const std::string &path, const WordList &words,
+                              unsigned int num_threads, int max_guesses) {
+  constexpr uint32_t kPatterns = WordTraits<L>::kNumPatterns;
+  ArtifactStats stats;
+
+  MappedFile file;
+  if (!file.map(path))
+    return stats;
+
+  // Header
+  ArtifactHeader h;
+  if (file.size < sizeof(ArtifactHeaderV1)) {
+    std::cerr << "Artifact too small for header: " << path << std::endl;
+    return stats;
+  }
+  std::memcpy(&h, file.data, std::min(file.size, sizeof(ArtifactHeader)));
+  size_t nodes_offset = sizeof(ArtifactHeader);
+  if (h.magic != kArtifactMagic) {
+    std::cerr << "Invalid magic in " << path << std::endl;
+    return stats;
+  }
+  if (h.version == 1) {
+    h.word_length = 5;
+    h.num_patterns = 243;
+    h.flags = 0;
+    nodes_offset = sizeof(ArtifactHeaderV1);
+  } else if (h.version == 2 && file.size >= sizeof(ArtifactHeaderV2)) {
+    h.flags = 0;
+    nodes_offset = sizeof(ArtifactHeaderV2);
+  } else if (h.version != 3 || file.size < sizeof(ArtifactHeader)) {
+    std::cerr << "Unsupported artifact version " << h.version << std::endl;
+    return stats;
+  }
+  if (h.word_length != L || h.num_patterns != kPatterns) {
+    std::cerr << "Artifact is for " << h.word_length << "-letter words with "
+              << h.num_patterns << " patterns, expected " << L << " and "
+              << kPatterns << std::endl;
+    return stats;
+  }
+  if (h.checksum != words.get_checksum()) {
+    std::cerr << "Artifact checksum does not match the word lists"
+              << std::endl;
+    return stats;
+  }
+  if (h.num_nodes == 0 || h.root_index >= h.num_nodes) {
+    std::cerr << "Root index " << h.root_index << " out of bounds ("
+              << h.num_nodes << " nodes)" << std::endl;
+    return stats;
+  }
+
+  // Sections
+  const size_t children_offset =
+      nodes_offset + static_cast<size_t>(h.num_nodes) * sizeof(ArtifactNode);
+  const size_t children_end =
+      children_offset +
+      static_cast<size_t>(h.num_nodes) * kPatterns * sizeof(uint32_t);
+  if (children_end > file.size) {
+    std::cerr << "Artifact truncated: " << children_end << " bytes of tree, "
+              << file.size << " in file" << std::endl;
+    return stats;
+  }
+  const auto *nodes =
+      reinterpret_cast<const ArtifactNode *>(file.data + nodes_offset);
+  const auto *children =
+      reinterpret_cast<const uint32_t *>(file.data + children_offset);
+
+  if ((h.flags & kArtifactHasWords) &&
+      !check_words<L>(file, words, h.num_guesses, h.num_solutions,
+                      h.words_offset, children_end))
+    return stats;
+
+  if (!check_nodes<L>(nodes, children, h.num_nodes, words, num_threads))
+    return stats;
+  ArtifactStats played = check_tree<L>(nodes, children, h.root_index, words,
+                                       num_threads, max_guesses);
+  if (played.valid && (h.flags & kArtifactHasRanges) &&
+      !check_ranges<L>(file, nodes, children, h.num_nodes, h.root_index,
+                       words, h.num_solutions, children_end, h.words_offset,
+                       h.flags & kArtifactHasWords))
+    return stats;
+  return played;
+}
+
+bool is_bundle(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+  uint32_t magic = 0;
+  bool bundle = read(fd, &magic, sizeof(magic)) == sizeof(magic) &&
+                magic == kBundleMagic;
+  close(fd);
+  return bundle;
+}
+
+template <int L>
+BundleStats verify_bundle(const std::string &path, const WordList &words,
+                          unsigned int num_threads) {
+  constexpr uint32_t kPatterns = WordTraits<L>::kNumPatterns;
+  BundleStats stats;
+
+  MappedFile file;
+  if (!file.map(path))
+    return stats;
+
+  BundleHeader h;
+  if (file.size < sizeof(BundleHeader)) {
+    std::cerr << "Bundle too small for header: " << path << std::endl;
+    return stats;
+  }
+  std::memcpy(&h, file.data, sizeof(BundleHeader));
+  if (h.magic != kBundleMagic || h.version != kBundleVersion) {
+    std::cerr << "Invalid bundle (magic/version): " << path << std::endl;
+    return stats;
+  }
+  if (h.word_length != L || h.num_patterns != kPatterns) {
+    std::cerr << "Bundle is for " << h.word_length << "-letter words with "
+              << h.num_patterns << " patterns, expected " << L << " and "
+              << kPatterns << std::endl;
+    return stats;
+  }
+  if (h.checksum != words.get_checksum()) {
+    std::cerr << "Bundle checksum does not match the word lists" << std::endl;
+    return stats;
+  }
+
+  const size_t nodes_offset =
+      sizeof(BundleHeader) + static_cast<size_t>(h.num_trees) *
+                                 sizeof(BundleTree);
+  const size_t children_offset =
+      nodes_offset + static_cast<size_t>(h.num_nodes) * sizeof(ArtifactNode);
+  const size_t children_end =
+      children_offset +
+      static_cast<size_t>(h.num_nodes) * kPatterns * sizeof(uint32_t);
+  if (h.num_trees == 0 || h.num_nodes == 0 || children_end > file.size) {
+    std::cerr << "Bundle truncated or empty: " << children_end
+              << " bytes of trees, " << file.size << " in file" << std::endl;
+    return stats;
+  }
+  if ((h.flags & kArtifactHasWords) &&
+      !check_words<L>(file, words, h.num_guesses, h.num_solutions,
+                      h.words_offset, children_end))
+    return stats;
+
+  const auto *toc =
+      reinterpret_cast<const BundleTree *>(file.data + sizeof(BundleHeader));
+  const auto *nodes =
+      reinterpret_cast<const ArtifactNode *>(file.data + nodes_offset);
+  const auto *children =
+      reinterpret_cast<const uint32_t *>(file.data + children_offset);
+
+  // The pool is shared, so its indices are checked once for all trees.
+  if (!check_nodes<L>(nodes, children, h.num_nodes, words, num_threads))
+    return stats;
+
+  stats.valid = true;
+  for (uint32_t t = 0; t < h.num_trees; ++t) {
+    const BundleTree &tree = toc[t];
+    stats.names.emplace_back(tree.name,
+                             strnlen(tree.name, sizeof(tree.name)));
+    if (tree.root_index >= h.num_nodes ||
+        tree.checksum != words.get_checksum()) {
+      std::cerr << "Bundle tree " << stats.names.back()
+                << ": root out of bounds or checksum mismatch" << std::endl;
+      stats.trees.emplace_back();
+    } else {
+      stats.trees.push_back(check_tree<L>(nodes, children, tree.root_index,
+                                          words, num_threads, 6));
+    }
+    stats.valid = stats.valid && stats.trees.back().valid;
+    if (!stats.trees.front().valid)
+      break;
+  }
+  return stats;
+}
+
+bool report_bundle(const std::string &path, const BundleStats &stats) {
+  for (size_t t = 0; t < stats.trees.size(); ++t)
+    std::cout << "  " << stats.names[t] << ": "
+              << (stats.trees[t].valid ? "ok" : "FAILED") << ", max depth "
+              << stats.trees[t].max_depth << ", average "
+              << stats.trees[t].average << std::endl;
+  std::cout << (stats.valid ? "Bundle verified: " : "Bundle verification FAILED: ")
+            << path << " (" << stats.trees.size() << " trees)" << std::endl;
+  return stats.valid;
+}
+
+bool report_artifact(const std::string &path, const ArtifactStats &stats) {
+  if (!stats.valid) {
+    std::cout << "Artifact verification FAILED: " << path << std::endl;
+    return false;
+  }
+  std::cout << "Artifact verified: " << path << " (max depth "
+            << stats.max_depth << ", average " << stats.average << ")"
+            << std::endl;
+  for (size_t d = 1; d < stats.depth_histogram.size(); ++d)
+    if (stats.depth_histogram[d])
+      std::cout << "  " << d << " guesses: " << stats.depth_histogram[d]
+                << std::endl;
+  return true;
+}
+
+#define WORDLE_INSTANTIATE_VERIFY(L)                                          \
+  template ArtifactStats verify_artifact<L>(const std::string &,               \
+                                            const WordList &, unsigned int,    \
+                                            int);                             \
+  template BundleStats verify_bundle<L>(const std::string &,                   \
+                                        const WordList &, unsigned int);
+
+WORDLE_INSTANTIATE_VERIFY(4)
+WORDLE_INSTANTIATE_VERIFY(5)
+WORDLE_INSTANTIATE_VERIFY(6)
+WORDLE_INSTANTIATE_VERIFY(7)
+WORDLE_INSTANTIATE_VERIFY(8)
+
 } // namespace wordle
@@ -1,9 +1,59 @@
 #pragma once
 #include "builder.h"
 #include "libwordle_core/wordlist.h"
+#include <string>
+#include <vector>
 
 namespace wordle {
 
+struct TreeStats {
+  bool valid = false;
+  int max_depth = 0;
+  double average = 0.0;
+};
+
+// Plays every solution through the tree without printing anything.
+TreeStats evaluate_tree(std::shared_ptr<MemoryNode> root,
+                        const WordList &words);
+
 bool verify_tree(std::shared_ptr<MemoryNode> root, const WordList &words);
 
-}
+struct ArtifactStats {
+  bool valid = false;
+  int max_depth = 0;
+  double average = 0.0;
+  std::vector<size_t> depth_histogram; // [d] = solutions found in d guesses
+};
+
+// Checks the bytes of a written solver_data.bin rather than the in-memory
+// tree: header fields against `words`, every section against the file size,
+// every guess and child index against its bounds, embedded word tables
+// against the lists, then plays every solution through the mapped tree.
+// Nodes and solutions are split across `num_threads`.
+template <int L>
+ArtifactStats verify_artifact(const std::string &path, const WordList &words,
+                              unsigned int num_threads,
+                              int max_guesses = 6);
+
+// Prints a verify_artifact() report; returns stats.valid.
+bool report_artifact(const std::string &path, const ArtifactStats &stats);
+
+struct BundleStats {
+  bool valid = false;
+  std::vector<std::string> names;  // TOC order
+  std::vector<ArtifactStats> trees; // Same order
+};
+
+// True if `path` starts with the tree bundle magic.
+bool is_bundle(const std::string &path);
+
+// verify_artifact() for a tree bundle: header and shared pool once, then
+// every TOC entry's tree played from its root.
+template <int L>
+BundleStats verify_bundle(const std::string &path, const WordList &words,
+                          unsigned int num_threads);
+
+// Prints one line per tree; returns stats.valid.
+bool report_bundle(const std::string &path, const BundleStats &stats);
+
+} // namespace wordle
@@ -1,4 +1,8 @@
 #include "writer.h"
+#include "libwordle_core/artifact.h"
+#include "libwordle_core/pattern.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <queue>
@@ -7,21 +11,85 @@
 
 namespace wordle {
 
-struct Header {
-  uint32_t magic = 0x5752444C;
-  uint32_t version = 1;
-  uint64_t checksum = 0;
-  uint32_t num_nodes = 0;
-  uint32_t root_index = 0;
-};
+namespace {
+
+template <typename T> void append(std::vector<uint8_t> &out, const T &value) {
+  const auto *p = reinterpret_cast<const uint8_t *>(&value);
+  out.insert(out.end(), p, p + sizeof(T));
+}
 
-struct DiskNode {
-  uint16_t guess_index;
-  uint16_t flags;
+// Embedded word tables: guess text, then packed guesses and solutions.
+void append_words(std::vector<uint8_t> &out, const WordList &words) {
+  for (std::string_view w : words.get_guesses())
+    out.insert(out.end(), w.begin(), w.end());
+  out.insert(out.end(), words.packed_guesses().begin(),
+             words.packed_guesses().end());
+  out.insert(out.end(), words.packed_solutions().begin(),
+             words.packed_solutions().end());
+}
+
+size_t words_size(const WordList &words) {
+  return words.packed_guesses().size() * 2 + words.packed_solutions().size();
+}
+
+// Numbers the solutions in depth-first leaf order: at each node the word its
+// guess solves, then every child's candidates by pattern. Each node's
+// candidates end up contiguous, in ranges[its flat index].
+class LeafOrder {
+public:
+  LeafOrder(const WordList &words,
+            const std::unordered_map<std::shared_ptr<MemoryNode>, uint32_t>
+                &node_map,
+            std::vector<ArtifactRange> &ranges, std::vector<uint32_t> &order)
+      : words_(words), node_map_(node_map), ranges_(ranges), order_(order) {}
+
+  void walk(const std::shared_ptr<MemoryNode> &node,
+            const std::vector<uint32_t> &set) {
+    const uint16_t solved = solved_pattern(words_.word_length());
+    std::string_view guess = words_.get_guesses()[node->guess_index];
+    std::vector<std::pair<uint16_t, uint32_t>> parts;
+    parts.reserve(set.size());
+    for (uint32_t s : set)
+      parts.emplace_back(calc_pattern(guess, words_.get_solutions()[s]), s);
+    std::sort(parts.begin(), parts.end(),
+              [solved](const auto &a, const auto &b) {
+                return (a.first == solved) != (b.first == solved)
+                           ? a.first == solved
+                           : a < b;
+              });
+
+    ArtifactRange &range = ranges_[node_map_.at(node)];
+    range.begin = static_cast<uint32_t>(order_.size());
+    std::vector<uint32_t> bucket;
+    for (size_t i = 0; i < parts.size();) {
+      const uint16_t p = parts[i].first;
+      bucket.clear();
+      for (; i < parts.size() && parts[i].first == p; ++i)
+        bucket.push_back(parts[i].second);
+      if (p == solved) {
+        order_.insert(order_.end(), bucket.begin(), bucket.end());
+        continue;
+      }
+      auto child = node->child(p);
+      if (child)
+        walk(child, bucket);
+    }
+    range.end = static_cast<uint32_t>(order_.size());
+  }
+
+private:
+  const WordList &words_;
+  const std::unordered_map<std::shared_ptr<MemoryNode>, uint32_t> &node_map_;
+  std::vector<ArtifactRange> &ranges_;
+  std::vector<uint32_t> &order_;
 };
 
-bool write_solution(const std::string &path, std::shared_ptr<MemoryNode> root,
-                    const WordList &words) {
+// Flattens the tree breadth-first into the artifact layout: header, nodes,
+// dense children, then the optional candidate ranges and word tables.
+bool serialize_solution(std::shared_ptr<MemoryNode> root,
+                        const WordList &words, HeuristicType heuristic,
+                        bool embed_words, bool embed_ranges,
+                        std::vector<uint8_t> &out) {
   if (!root)
     return false;
 
@@ -37,56 +105,330 @@ bool write_solution(const std::string &path, std::shared_ptr<MemoryNode> root,
   while (head < flat_nodes.size()) {
     auto node = flat_nodes[head++];
 
-    for (auto child : node->children) {
-      if (child && node_map.find(child) == node_map.end()) {
+    for (const auto &[pattern, child] : node->children) {
+      if (node_map.find(child) == node_map.end()) {
         node_map[child] = (uint32_t)flat_nodes.size();
         flat_nodes.push_back(child);
       }
     }
   }
 
-  std::cout << "Writing " << flat_nodes.size() << " nodes to " << path
-            << std::endl;
+  std::vector<ArtifactRange> ranges;
+  std::vector<uint32_t> order;
+  if (embed_ranges) {
+    std::vector<uint32_t> all(words.get_solutions().size());
+    for (size_t i = 0; i < all.size(); ++i)
+      all[i] = static_cast<uint32_t>(i);
+    ranges.assign(flat_nodes.size(), ArtifactRange{0, 0});
+    order.reserve(all.size());
+    LeafOrder(words, node_map, ranges, order).walk(root, all);
+    if (order.size() != all.size()) {
+      std::cerr << "Tree does not solve every solution; cannot order them"
+                << std::endl;
+      return false;
+    }
+  }
 
-  std::ofstream out(path, std::ios::binary);
-  if (!out)
-    return false;
+  const int patterns = num_patterns(words.word_length());
+  const size_t words_offset = sizeof(ArtifactHeader) +
+                              flat_nodes.size() * sizeof(ArtifactNode) +
+                              flat_nodes.size() * patterns * sizeof(uint32_t) +
+                              ranges.size() * sizeof(ArtifactRange) +
+                              order.size() * sizeof(uint32_t);
 
-  Header header;
+  ArtifactHeader header;
   header.checksum = words.get_checksum();
   header.num_nodes = (uint32_t)flat_nodes.size();
   header.root_index = 0;
+  header.word_length = (uint32_t)words.word_length();
+  header.num_patterns = (uint32_t)patterns;
+  header.build_info = artifact_build_info(heuristic);
+  if (embed_words) {
+    header.flags |= kArtifactHasWords;
+    header.num_guesses = (uint32_t)words.get_guesses().size();
+    header.num_solutions = (uint32_t)words.get_solutions().size();
+    header.words_offset = words_offset;
+  }
+  if (embed_ranges) {
+    header.flags |= kArtifactHasRanges;
+    header.num_solutions = (uint32_t)words.get_solutions().size();
+  }
 
-  out.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+  out.clear();
+  out.reserve(words_offset + (embed_words ? words_size(words) : 0));
+  append(out, header);
 
-  // Write Nodes
+  // Nodes
   for (const auto &node : flat_nodes) {
-    DiskNode dn;
+    ArtifactNode dn;
     dn.guess_index = node->guess_index;
     dn.flags = 0;
     if (node->is_leaf)
       dn.flags |= 1; // IsLeaf
     if (node->is_leaf)
       dn.flags |= 2; // IsSolution (Implicitly yes for leaf)
-
-    out.write(reinterpret_cast<const char *>(&dn), sizeof(DiskNode));
+    append(out, dn);
   }
 
-  // Write Children
+  // Children
+  std::vector<uint32_t> children_indices(patterns);
   for (const auto &node : flat_nodes) {
-    std::vector<uint32_t> children_indices(243, 0xFFFFFFFF);
+    std::fill(children_indices.begin(), children_indices.end(), kNoChild);
+    for (const auto &[pattern, child] : node->children)
+      children_indices[pattern] = node_map[child];
+    const auto *p = reinterpret_cast<const uint8_t *>(children_indices.data());
+    out.insert(out.end(), p, p + patterns * sizeof(uint32_t));
+  }
 
-    for (int i = 0; i < 243; ++i) {
-      if (node->children[i]) {
-        children_indices[i] = node_map[node->children[i]];
-      }
+  for (const ArtifactRange &range : ranges)
+    append(out, range);
+  for (uint32_t s : order)
+    append(out, s);
+
+  if (embed_words)
+    append_words(out, words);
+
+  std::cout << "Serialized " << flat_nodes.size() << " nodes ("
+            << out.size() << " bytes)" << std::endl;
+  return true;
+}
+
+// Interns subtrees by structure, so that equal subtrees of different trees
+// (or of one tree) become one pool entry. A node's key is its guess, leaf
+// flag and (pattern, interned child) list; children are interned first.
+class NodePool {
+public:
+  struct Entry {
+    uint16_t guess_index;
+    bool is_leaf;
+    std::vector<std::pair<uint16_t, uint32_t>> children;
+  };
+
+  uint32_t intern(const std::shared_ptr<MemoryNode> &node) {
+    auto seen = by_pointer_.find(node.get());
+    if (seen != by_pointer_.end())
+      return seen->second;
+
+    Entry entry{node->guess_index, node->is_leaf, {}};
+    for (const auto &[pattern, child] : node->children)
+      entry.children.emplace_back(pattern, intern(child));
+
+    std::string key;
+    key.reserve(3 + entry.children.size() * 6);
+    append_key(key, entry.guess_index);
+    key.push_back(entry.is_leaf ? 1 : 0);
+    for (const auto &[pattern, child] : entry.children) {
+      append_key(key, pattern);
+      append_key(key, child);
     }
-    out.write(reinterpret_cast<const char *>(children_indices.data()),
-              243 * sizeof(uint32_t));
+    auto [it, inserted] =
+        by_structure_.emplace(std::move(key), (uint32_t)entries_.size());
+    if (inserted)
+      entries_.push_back(std::move(entry));
+    by_pointer_.emplace(node.get(), it->second);
+    return it->second;
   }
 
+  const std::vector<Entry> &entries() const { return entries_; }
+
+private:
+  template <typename T> static void append_key(std::string &key, T value) {
+    key.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  std::vector<Entry> entries_;
+  std::unordered_map<std::string, uint32_t> by_structure_;
+  std::unordered_map<const MemoryNode *, uint32_t> by_pointer_;
+};
+
+// Nodes reachable from `root`, each shared pointer counted once: what the
+// tree would cost written on its own.
+size_t count_nodes(const std::shared_ptr<MemoryNode> &root) {
+  std::vector<const MemoryNode *> stack{root.get()};
+  std::unordered_map<const MemoryNode *, bool> seen{{root.get(), true}};
+  while (!stack.empty()) {
+    const MemoryNode *node = stack.back();
+    stack.pop_back();
+    for (const auto &[pattern, child] : node->children)
+      if (seen.emplace(child.get(), true).second)
+        stack.push_back(child.get());
+  }
+  return seen.size();
+}
+
+void copy_name(char *dst, size_t size, const std::string &src) {
+  std::memset(dst, 0, size);
+  std::memcpy(dst, src.data(), std::min(src.size(), size - 1));
+}
+
+} // namespace
+
+bool write_bundle(const std::string &path,
+                  const std::vector<BundleEntry> &trees,
+                  const WordList &words, bool embed_words) {
+  if (trees.empty())
+    return false;
+
+  NodePool pool;
+  std::vector<uint32_t> roots;
+  size_t separate_nodes = 0;
+  for (const auto &tree : trees) {
+    if (!tree.root)
+      return false;
+    roots.push_back(pool.intern(tree.root));
+    separate_nodes += count_nodes(tree.root);
+  }
+
+  // Final order: breadth-first from each root in TOC order, so every tree's
+  // top levels stay together as in a single artifact.
+  const auto &entries = pool.entries();
+  std::vector<uint32_t> order, index(entries.size(), kNoChild);
+  order.reserve(entries.size());
+  for (uint32_t root : roots) {
+    if (index[root] != kNoChild)
+      continue;
+    index[root] = (uint32_t)order.size();
+    order.push_back(root);
+    for (size_t head = order.size() - 1; head < order.size(); ++head)
+      for (const auto &[pattern, child] : entries[order[head]].children)
+        if (index[child] == kNoChild) {
+          index[child] = (uint32_t)order.size();
+          order.push_back(child);
+        }
+  }
+
+  const int patterns = num_patterns(words.word_length());
+  const size_t words_offset =
+      sizeof(BundleHeader) + trees.size() * sizeof(BundleTree) +
+      order.size() * (sizeof(ArtifactNode) + patterns * sizeof(uint32_t));
+
+  BundleHeader header;
+  header.checksum = words.get_checksum();
+  header.num_trees = (uint32_t)trees.size();
+  header.num_nodes = (uint32_t)order.size();
+  header.word_length = (uint32_t)words.word_length();
+  header.num_patterns = (uint32_t)patterns;
+  if (embed_words) {
+    header.flags |= kArtifactHasWords;
+    header.num_guesses = (uint32_t)words.get_guesses().size();
+    header.num_solutions = (uint32_t)words.get_solutions().size();
+    header.words_offset = words_offset;
+  }
+
+  std::vector<uint8_t> out;
+  out.reserve(words_offset + (embed_words ? words_size(words) : 0));
+  append(out, header);
+
+  for (size_t t = 0; t < trees.size(); ++t) {
+    BundleTree toc;
+    copy_name(toc.name, sizeof(toc.name),
+              trees[t].opener + "/" + trees[t].heuristic);
+    copy_name(toc.opener, sizeof(toc.opener), trees[t].opener);
+    copy_name(toc.heuristic, sizeof(toc.heuristic), trees[t].heuristic);
+    toc.root_index = index[roots[t]];
+    toc.checksum = words.get_checksum();
+    append(out, toc);
+  }
+
+  for (uint32_t id : order) {
+    ArtifactNode dn;
+    dn.guess_index = entries[id].guess_index;
+    dn.flags = entries[id].is_leaf ? 1 | 2 : 0; // IsLeaf | IsSolution
+    append(out, dn);
+  }
+
+  std::vector<uint32_t> children_indices(patterns);
+  for (uint32_t id : order) {
+    std::fill(children_indices.begin(), children_indices.end(), kNoChild);
+    for (const auto &[pattern, child] : entries[id].children)
+      children_indices[pattern] = index[child];
+    const auto *p = reinterpret_cast<const uint8_t *>(children_indices.data());
+    out.insert(out.end(), p, p + patterns * sizeof(uint32_t));
+  }
+
+  if (embed_words)
+    append_words(out, words);
+
+  const size_t node_bytes = sizeof(ArtifactNode) + patterns * sizeof(uint32_t);
+  std::cout << "Bundled " << trees.size() << " trees: " << order.size()
+            << " shared nodes for " << separate_nodes << " separate ("
+            << (separate_nodes - order.size()) * node_bytes
+            << " bytes saved, " << out.size() << " bytes total)" << std::endl;
+
+  std::ofstream file(path, std::ios::binary);
+  if (!file)
+    return false;
+  file.write(reinterpret_cast<const char *>(out.data()), out.size());
+  file.close();
+  return static_cast<bool>(file);
+}
+
+bool write_solution(const std::string &path, std::shared_ptr<MemoryNode> root,
+                    const WordList &words, HeuristicType heuristic,
+                    bool embed_words, bool embed_ranges) {
+  std::vector<uint8_t> image;
+  if (!serialize_solution(root, words, heuristic, embed_words, embed_ranges,
+                          image))
+    return false;
+
+  std::ofstream out(path, std::ios::binary);
+  if (!out)
+    return false;
+  out.write(reinterpret_cast<const char *>(image.data()), image.size());
   out.close();
-  return true;
+  return static_cast<bool>(out);
+}
+
+bool write_solution_source(const std::string &path,
+                           std::shared_ptr<MemoryNode> root,
+                           const WordList &words, HeuristicType heuristic) {
+  std::vector<uint8_t> image;
+  if (!serialize_solution(root, words, heuristic, true, true, image))
+    return false;
+
+  std::ofstream out(path);
+  if (!out)
+    return false;
+
+  // Octal escapes in string literals compile an order of magnitude faster
+  // than a brace list of millions of integers. Escapes are always three
+  // digits so a following byte can never be read as part of one.
+  out << "// Generated by wordle_builder --emit-cpp. Do not edit.\n"
+      << "// " << words.get_guesses().size() << " guesses, "
+      << words.get_solutions().size() << " solutions, word length "
+      << words.word_length() << ", checksum " << words.get_checksum()
+      << ".\n"
+      << "#include <cstddef>\n\n"
+      << "namespace wordle {\n\n"
+      << "namespace {\n\n"
+      << "alignas(64) constexpr unsigned char kImage[] =\n";
+  static const char kDigits[] = "01234567";
+  constexpr size_t kBytesPerLine = 64;
+  std::string line;
+  for (size_t i = 0; i < image.size(); i += kBytesPerLine) {
+    line = "    \"";
+    for (size_t j = i; j < std::min(image.size(), i + kBytesPerLine); ++j) {
+      uint8_t b = image[j];
+      line += '\\';
+      line += kDigits[b >> 6];
+      line += kDigits[(b >> 3) & 7];
+      line += kDigits[b & 7];
+    }
+    line += "\"\n";
+    out << line;
+  }
+  out << "    ;\n\n"
+      << "} // namespace\n\n"
+      << "extern const unsigned char *const kStaticArtifact = kImage;\n"
+      << "// The literal's terminating NUL is not part of the artifact.\n"
+      << "extern const std::size_t kStaticArtifactSize = sizeof(kImage) - 1;\n\n"
+      << "} // namespace wordle\n";
+
+  out.close();
+  if (out)
+    std::cout << "Wrote " << image.size() << " bytes of artifact as C++ to "
+              << path << std::endl;
+  return static_cast<bool>(out);
 }
 
 } // namespace wordle
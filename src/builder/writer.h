@@ -1,10 +1,38 @@
 #pragma once
 #include "builder.h"
 #include <string>
+#include <vector>
 
 namespace wordle {
 
+// Writes the tree as solver_data.bin. With `embed_words` the guess and
+// solution tables are appended so the solver can run without the text lists.
+// With `embed_ranges` the solutions are stored in leaf order with every
+// node's [begin, end) range into it (kArtifactHasRanges). The header records
+// `heuristic` and the cost table (artifact_build_info) for --base.
 bool write_solution(const std::string &path, std::shared_ptr<MemoryNode> root,
-                    const WordList &words);
+                    const WordList &words, HeuristicType heuristic,
+                    bool embed_words = false, bool embed_ranges = false);
 
-}
+// Writes the same artifact, word tables and ranges included, as a C++ source
+// defining wordle::kStaticArtifact / kStaticArtifactSize (see
+// solver/static_artifact.h) so it can be compiled into .rodata.
+bool write_solution_source(const std::string &path,
+                           std::shared_ptr<MemoryNode> root,
+                           const WordList &words, HeuristicType heuristic);
+
+// One tree of a bundle; the TOC names it "<opener>/<heuristic>".
+struct BundleEntry {
+  std::string opener;
+  std::string heuristic;
+  std::shared_ptr<MemoryNode> root;
+};
+
+// Writes several trees built from the same lists as one bundle (see
+// BundleHeader in artifact.h). Equal subtrees are stored once across all
+// trees; the TOC keeps the order of `trees`.
+bool write_bundle(const std::string &path,
+                  const std::vector<BundleEntry> &trees,
+                  const WordList &words, bool embed_words = false);
+
+} // namespace wordle
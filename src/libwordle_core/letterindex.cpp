@@ -0,0 +1,86 @@
+#include "libwordle_core/letterindex.h"
+
+namespace wordle {
+
+template <int L>
+void BasicLetterIndex<L>::build(const BasicPackedWord<L> *solutions,
+                                size_t num_solutions) {
+  num_solutions_ = num_solutions;
+  num_words_ = (num_solutions + 63) / 64;
+  bits_.assign(2 * 26 * L * num_words_, 0);
+
+  for (size_t s = 0; s < num_solutions; ++s) {
+    const uint64_t bit = 1ULL << (s % 64);
+    const size_t w = s / 64;
+    uint8_t counts[26] = {0};
+    for (int i = 0; i < L; ++i) {
+      const uint8_t c = solutions[s].chars[i];
+      bits_[position(i, c) + w] |= bit;
+      ++counts[c];
+    }
+    for (int c = 0; c < 26; ++c)
+      for (int k = 1; k <= counts[c]; ++k)
+        bits_[at_least(c, k) + w] |= bit;
+  }
+}
+
+template <int L>
+void BasicLetterIndex<L>::filter(const BasicPackedWord<L> &guess,
+                                 Pattern pattern, uint64_t *bits) const {
+  // Every constraint is "must be in" or "must not be in" one bitset: at most
+  // L positional ones plus two count bounds per distinct letter.
+  const uint64_t *sets[3 * L];
+  uint64_t flips[3 * L]; // 0 to AND, ~0 to AND NOT
+  int n = 0;
+
+  uint8_t colors[L];
+  for (int i = 0; i < L; ++i) {
+    colors[i] = pattern % 3;
+    pattern /= 3;
+  }
+
+  for (int i = 0; i < L; ++i) {
+    const uint8_t c = guess.chars[i];
+    sets[n] = &bits_[position(i, c)];
+    flips[n++] = colors[i] == 2 ? 0 : ~0ULL;
+
+    // Count bounds once per distinct letter, at its first occurrence.
+    bool first = true;
+    for (int j = 0; j < i; ++j)
+      first &= guess.chars[j] != c;
+    if (!first)
+      continue;
+    int marked = 0;
+    bool black = false;
+    for (int j = i; j < L; ++j) {
+      if (guess.chars[j] != c)
+        continue;
+      marked += colors[j] != 0;
+      black |= colors[j] == 0;
+    }
+    if (marked > 0) {
+      sets[n] = &bits_[at_least(c, marked)];
+      flips[n++] = 0;
+    }
+    // A black copy caps the count at the marked ones.
+    if (black && marked < L) {
+      sets[n] = &bits_[at_least(c, marked + 1)];
+      flips[n++] = ~0ULL;
+    }
+  }
+
+  for (size_t w = 0; w < num_words_; ++w) {
+    uint64_t v = bits[w];
+    for (int k = 0; k < n; ++k)
+      v &= sets[k][w] ^ flips[k];
+    bits[w] = v;
+  }
+}
+
+template class BasicLetterIndex<4>;
+template class BasicLetterIndex<5>;
+template class BasicLetterIndex<6>;
+template class BasicLetterIndex<7>;
+template class BasicLetterIndex<8>;
+
+} // namespace wordle
@@ -8,21 +8,15 @@
 
 namespace wordle {
 
-void PatternTable::generate(const std::vector<std::string> &guesses,
-                            const std::vector<std::string> &solutions) {
-  num_guesses_ = guesses.size();
-  num_solutions_ = solutions.size();
+template <int L>
+void BasicPatternTable<L>::generate(const BasicPackedWord<L> *packed_guesses,
+                                    size_t num_guesses,
+                                    const BasicPackedWord<L> *packed_solutions,
+                                    size_t num_solutions) {
+  num_guesses_ = num_guesses;
+  num_solutions_ = num_solutions;
   table_.resize(num_guesses_ * num_solutions_);
 
-  // Pre-pack words
-  std::vector<PackedWord> packed_guesses(num_guesses_);
-  std::vector<PackedWord> packed_solutions(num_solutions_);
-
-  for (size_t i = 0; i < num_guesses_; ++i)
-    packed_guesses[i] = pack_word(guesses[i]);
-  for (size_t i = 0; i < num_solutions_; ++i)
-    packed_solutions[i] = pack_word(solutions[i]);
-
   unsigned int num_threads = std::thread::hardware_concurrency();
   if (num_threads == 0)
     num_threads = 4;
@@ -36,7 +30,7 @@ void PatternTable::generate(const std::vector<std::string> &guesses,
 
     futures.push_back(
         std::async(std::launch::async,
-                   [this, start, end, &packed_guesses, &packed_solutions]() {
+                   [this, start, end, packed_guesses, packed_solutions]() {
                      for (size_t g = start; g < end; ++g) {
                        size_t row_offset = g * num_solutions_;
                        const auto &guess_word = packed_guesses[g];
@@ -54,4 +48,26 @@ void PatternTable::generate(const std::vector<std::string> &guesses,
   }
 }
 
-} // namespace wordle
\ No newline at end of file
+template <int L>
+void BasicPatternTable<L>::extract(const BasicPatternTable &full,
+                                   const std::vector<int> &guesses,
+                                   const std::vector<int> &solutions) {
+  num_guesses_ = guesses.size();
+  num_solutions_ = solutions.size();
+  table_.resize(num_guesses_ * num_solutions_);
+  Pattern *out = table_.data();
+  for (int g : guesses) {
+    const Pattern *row =
+        full.table_.data() + static_cast<size_t>(g) * full.num_solutions_;
+    for (int s : solutions)
+      *out++ = row[s];
+  }
+}
+
+template class BasicPatternTable<4>;
+template class BasicPatternTable<5>;
+template class BasicPatternTable<6>;
+template class BasicPatternTable<7>;
+template class BasicPatternTable<8>;
+
+} // namespace wordle
@@ -0,0 +1,177 @@
+#include "libwordle_core/perfcounters.h"
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace wordle {
+
+namespace {
+
+constexpr const char *kEventNames[kNumPerfEvents] = {
+    "cycles",      "instructions",  "l1d_misses", "llc_misses",
+    "dtlb_misses", "branch_misses", "task_clock_ns", "page_faults"};
+
+#ifdef __linux__
+constexpr uint64_t cache_miss(uint64_t cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+struct EventConfig {
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr EventConfig kEventConfigs[kNumPerfEvents] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL)},
+    {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+#endif
+
+} // namespace
+
+const char *perf_event_name(PerfEvent event) {
+  return kEventNames[static_cast<int>(event)];
+}
+
+PerfCounters::PerfCounters() {
+  for (int &fd : fds_)
+    fd = -1;
+#ifdef __linux__
+  for (int i = 0; i < kNumPerfEvents; ++i) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = kEventConfigs[i].type;
+    attr.config = kEventConfigs[i].config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    fds_[i] = static_cast<int>(
+        syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    if (fds_[i] < 0 && error_.empty())
+      error_ = std::string(kEventNames[i]) + ": " + std::strerror(errno);
+  }
+#else
+  error_ = "perf_event_open is Linux only";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for (int fd : fds_)
+    if (fd >= 0)
+      close(fd);
+#endif
+}
+
+bool PerfCounters::any_available() const {
+  for (int fd : fds_)
+    if (fd >= 0)
+      return true;
+  return false;
+}
+
+PerfReading PerfCounters::read() const {
+  PerfReading reading;
+#ifdef __linux__
+  for (int i = 0; i < kNumPerfEvents; ++i) {
+    uint64_t data[3]; // value, time enabled, time running
+    if (fds_[i] < 0 || ::read(fds_[i], data, sizeof(data)) != sizeof(data))
+      continue;
+    reading.values[i] =
+        data[2] == 0 || data[2] >= data[1]
+            ? data[0]
+            : static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] /
+                                    data[2]);
+  }
+#endif
+  return reading;
+}
+
+PerfPhases::PerfPhases(const PerfCounters &counters) : counters_(counters) {}
+
+int PerfPhases::phase(const std::string &name) {
+  for (size_t i = 0; i < phases_.size(); ++i)
+    if (phases_[i].name == name)
+      return static_cast<int>(i);
+  Phase entry;
+  entry.name = name;
+  phases_.push_back(entry);
+  return static_cast<int>(phases_.size() - 1);
+}
+
+int PerfPhases::enter(int phase) {
+  const int previous = current_;
+  if (phase == current_)
+    return previous;
+  PerfReading now = counters_.read();
+  auto now_time = std::chrono::steady_clock::now();
+  if (current_ >= 0) {
+    Phase &p = phases_[current_];
+    p.seconds += std::chrono::duration<double>(now_time - last_time_).count();
+    for (int i = 0; i < kNumPerfEvents; ++i)
+      p.totals.values[i] += now.values[i] - last_.values[i];
+  }
+  last_ = now;
+  last_time_ = now_time;
+  current_ = phase;
+  return previous;
+}
+
+bool PerfPhases::write_json(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out)
+    return false;
+
+  const auto has = [&](PerfEvent e) { return counters_.available(e); };
+  out << "{\n  \"available\": "
+      << (counters_.any_available() ? "true" : "false")
+      << ",\n  \"error\": \"" << counters_.error() << "\",\n  \"events\": [";
+  for (int i = 0; i < kNumPerfEvents; ++i)
+    out << (i ? ", " : "") << "\"" << kEventNames[i] << "\"";
+  out << "],\n  \"phases\": [\n" << std::fixed;
+
+  for (size_t p = 0; p < phases_.size(); ++p) {
+    const Phase &ph = phases_[p];
+    out << "    {\"name\": \"" << ph.name << "\", \"seconds\": "
+        << std::setprecision(6) << ph.seconds;
+    for (int i = 0; i < kNumPerfEvents; ++i) {
+      out << ", \"" << kEventNames[i] << "\": ";
+      if (has(static_cast<PerfEvent>(i)))
+        out << ph.totals.values[i];
+      else
+        out << "null";
+    }
+    const uint64_t cycles =
+        ph.totals.values[static_cast<int>(PerfEvent::Cycles)];
+    out << ", \"ipc\": ";
+    if (has(PerfEvent::Cycles) && has(PerfEvent::Instructions) && cycles > 0)
+      out << std::setprecision(3)
+          << static_cast<double>(
+                 ph.totals.values[static_cast<int>(PerfEvent::Instructions)]) /
+                 cycles;
+    else
+      out << "null";
+    out << "}" << (p + 1 < phases_.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+  return static_cast<bool>(out);
+}
+
+} // namespace wordle
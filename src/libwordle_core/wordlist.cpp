@@ -1,67 +1,209 @@
 #include "libwordle_core/wordlist.h"
 #include <algorithm>
-#include <fstream>
+#include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <numeric>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
 
 namespace wordle {
 
 namespace {
 
-uint64_t fnv1a_64(const std::vector<std::string> &words) {
-  uint64_t hash = 14695981039346656037ULL;
-  for (const auto &w : words) {
-    for (char c : w) {
-      hash ^= static_cast<uint64_t>(c);
-      hash *= 1099511628211ULL;
-    }
-    // Add separator to ensure boundaries
-    hash ^= static_cast<uint64_t>(0);
-    hash *= 1099511628211ULL;
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+void fnv1a_64(uint64_t &hash, std::string_view w) {
+  for (char c : w) {
+    hash ^= static_cast<uint64_t>(c);
+    hash *= kFnvPrime;
+  }
+  // Add separator to ensure boundaries
+  hash ^= static_cast<uint64_t>(0);
+  hash *= kFnvPrime;
+}
+
+// Checksum of the two sorted lists merged (duplicates kept), without
+// materializing the merged list.
+uint64_t merged_checksum(const std::vector<std::string_view> &a,
+                         const std::vector<std::string_view> &b) {
+  uint64_t hash = kFnvOffset;
+  size_t i = 0, j = 0;
+  while (i < a.size() || j < b.size()) {
+    if (j == b.size() || (i < a.size() && a[i] <= b[j]))
+      fnv1a_64(hash, a[i++]);
+    else
+      fnv1a_64(hash, b[j++]);
   }
   return hash;
 }
 
-bool load_file(const std::string &path, std::vector<std::string> &out) {
-  std::ifstream f(path);
-  if (!f.is_open()) {
+// Validates and packs one word; false if it is not `length` letters a-z.
+bool pack_line(const char *p, size_t length, std::vector<uint8_t> &packed) {
+  uint8_t letters[8];
+  unsigned bad = 0;
+  for (size_t i = 0; i < length; ++i) {
+    letters[i] = static_cast<uint8_t>(p[i] - 'a');
+    bad |= letters[i] >= 26;
+  }
+  if (bad)
+    return false;
+  packed.insert(packed.end(), letters, letters + length);
+  return true;
+}
+
+// Sorts and deduplicates views and packed words together.
+void normalize(std::vector<std::string_view> &views,
+               std::vector<uint8_t> &packed, size_t length) {
+  std::vector<size_t> order(views.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](size_t a, size_t b) { return views[a] < views[b]; });
+
+  std::vector<std::string_view> sorted_views;
+  std::vector<uint8_t> sorted_packed;
+  sorted_views.reserve(views.size());
+  sorted_packed.reserve(packed.size());
+  for (size_t i : order) {
+    if (!sorted_views.empty() && sorted_views.back() == views[i])
+      continue;
+    sorted_views.push_back(views[i]);
+    sorted_packed.insert(sorted_packed.end(), packed.begin() + i * length,
+                         packed.begin() + (i + 1) * length);
+  }
+  views = std::move(sorted_views);
+  packed = std::move(sorted_packed);
+}
+
+// Maps `path` and parses it in one pass: split lines, trim, validate, pack
+// and note whether the file is already sorted and duplicate-free.
+bool load_file(const std::string &path, size_t word_length,
+               const char *&mapped, size_t &mapped_size,
+               std::vector<std::string_view> &views,
+               std::vector<uint8_t> &packed) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
     std::cerr << "Failed to open file: " << path << std::endl;
     return false;
   }
-  std::string line;
-  while (std::getline(f, line)) {
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    std::cerr << "Failed to get file size for: " << path << std::endl;
+    close(fd);
+    return false;
+  }
+  mapped_size = st.st_size;
+  if (mapped_size == 0) {
+    close(fd);
+    return true;
+  }
+  void *data = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    std::cerr << "Failed to mmap file: " << path << std::endl;
+    mapped_size = 0;
+    return false;
+  }
+  mapped = static_cast<const char *>(data);
+  madvise(data, mapped_size, MADV_SEQUENTIAL);
+
+  // Typical lists are one word plus a newline per line.
+  views.reserve(mapped_size / (word_length + 1) + 1);
+  packed.reserve((mapped_size / (word_length + 1) + 1) * word_length);
+
+  bool ordered = true;
+  const char *p = mapped;
+  const char *end = mapped + mapped_size;
+  while (p < end) {
+    const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    const char *line_end = nl ? nl : end;
+    const char *next = nl ? nl + 1 : end;
+
     // Trim whitespace
-    line.erase(line.find_last_not_of(" \n\r\t") + 1);
-    if (line.empty())
+    while (line_end > p && (line_end[-1] == ' ' || line_end[-1] == '\r' ||
+                            line_end[-1] == '\t'))
+      --line_end;
+    const size_t len = line_end - p;
+    if (len == 0) {
+      p = next;
       continue;
-    if (line.size() != 5) {
-      std::cerr << "Warning: Skipping invalid word '" << line << "' in " << path
-                << std::endl;
+    }
+
+    std::string_view word(p, len);
+    if (len != word_length || !pack_line(p, word_length, packed)) {
+      std::cerr << "Warning: Skipping invalid word '" << word << "' in "
+                << path << std::endl;
+      p = next;
       continue;
     }
-    out.push_back(line);
+    if (!views.empty() && !(views.back() < word))
+      ordered = false;
+    views.push_back(word);
+    p = next;
   }
-  std::sort(out.begin(), out.end());
-  out.erase(std::unique(out.begin(), out.end()), out.end());
+
+  if (!ordered)
+    normalize(views, packed, word_length);
   return true;
 }
 
 } // namespace
 
+WordList::~WordList() { unmap(); }
+
+WordList::WordList(WordList &&other) noexcept { *this = std::move(other); }
+
+WordList &WordList::operator=(WordList &&other) noexcept {
+  if (this != &other) {
+    unmap();
+    mappings_ = std::exchange(other.mappings_, {});
+    solutions_ = std::move(other.solutions_);
+    guesses_ = std::move(other.guesses_);
+    packed_solutions_ = std::move(other.packed_solutions_);
+    packed_guesses_ = std::move(other.packed_guesses_);
+    checksum_ = other.checksum_;
+    word_length_ = other.word_length_;
+  }
+  return *this;
+}
+
+void WordList::unmap() {
+  for (const auto &m : mappings_)
+    munmap(const_cast<char *>(m.data), m.size);
+  mappings_.clear();
+}
+
 bool WordList::load(const std::string &solutions_path,
-                    const std::string &guesses_path) {
+                    const std::string &guesses_path, size_t word_length) {
+  unmap();
   solutions_.clear();
   guesses_.clear();
-
-  if (!load_file(solutions_path, solutions_))
-    return false;
-  if (!load_file(guesses_path, guesses_))
+  packed_solutions_.clear();
+  packed_guesses_.clear();
+  word_length_ = word_length;
+  if (word_length < 1 || word_length > 8) {
+    std::cerr << "Unsupported word length: " << word_length << std::endl;
     return false;
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    const std::string &path = i == 0 ? solutions_path : guesses_path;
+    auto &views = i == 0 ? solutions_ : guesses_;
+    auto &packed = i == 0 ? packed_solutions_ : packed_guesses_;
+    Mapping m;
+    bool ok = load_file(path, word_length, m.data, m.size, views, packed);
+    if (m.data)
+      mappings_.push_back(m);
+    if (!ok)
+      return false;
+  }
 
   // Checksum based on guesses (which should be the superset or at least the
-  std::vector<std::string> combined_words = guesses_;
-  combined_words.insert(combined_words.end(), solutions_.begin(), solutions_.end());
-  std::sort(combined_words.begin(), combined_words.end());
-  checksum_ = fnv1a_64(combined_words);
+  // solutions) merged with the solutions, in sorted order.
+  checksum_ = merged_checksum(guesses_, solutions_);
 
   return true;
 }
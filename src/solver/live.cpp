@@ -0,0 +1,230 @@
+#include "live.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace wordle {
+
+template <int L> uint64_t LiveEngine<L>::solution_key(uint32_t s) {
+  // splitmix64
+  uint64_t z = (s + 1) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+template <int L>
+LiveEngine<L>::LiveEngine(const Solver &solver, const WordTables &words,
+                          long budget_us)
+    : solver_(solver), words_(words), budget_us_(budget_us),
+      node_(solver.get_root_index()),
+      counts_(WordTraits<L>::kNumPatterns, 0) {
+  constexpr Pattern kSolved = WordTraits<L>::kSolvedPattern;
+  const auto *guesses = words.packed_guesses<L>();
+  const auto *solutions = words.packed_solutions<L>();
+  const size_t G = words.num_guesses();
+  const size_t S = words.num_solutions();
+  std::vector<int32_t> guess_probe(G, -1);
+
+  // Both lists are sorted, so one merge pairs each solution with its guess.
+  solution_probe_.assign(S, -1);
+  for (size_t s = 0, g = 0; s < S && g < G;) {
+    int c = std::memcmp(solutions[s].chars, guesses[g].chars, L);
+    if (c == 0) {
+      guess_probe[g] = solution_probe_[s] = static_cast<int32_t>(probes_.size());
+      probes_.push_back(static_cast<uint16_t>(g));
+      ++s, ++g;
+    } else if (c < 0) {
+      ++s;
+    } else {
+      ++g;
+    }
+  }
+  num_solution_probes_ = probes_.size();
+
+  // Play every solution through the tree once: a node's candidate set is
+  // exactly the solutions whose game passes through it.
+  std::vector<uint64_t> node_key;
+  candidates_.resize(S);
+  for (uint32_t s = 0; s < S; ++s) {
+    candidates_[s] = static_cast<uint16_t>(s);
+    set_key_ += solution_key(s);
+    int node = solver.get_root_index();
+    for (int step = 0; step < 32 && node >= 0; ++step) {
+      if (static_cast<size_t>(node) >= node_key.size()) {
+        node_key.resize(node + 1, 0);
+        node_size_.resize(node + 1, 0);
+      }
+      node_key[node] += solution_key(s);
+      ++node_size_[node];
+      uint16_t g = solver.get_node(node).guess_index;
+      if (guess_probe[g] < 0) {
+        guess_probe[g] = static_cast<int32_t>(probes_.size());
+        probes_.push_back(g);
+      }
+      Pattern p = calc_pattern<L>(guesses[g], solutions[s]);
+      if (p == kSolved)
+        break;
+      uint32_t next = solver.next_node<L>(node, p);
+      node = next == kNoChild ? -1 : static_cast<int>(next);
+    }
+  }
+  index_.build(solutions, S);
+  candidate_bits_.assign(index_.num_words(), ~0ULL);
+  if (S % 64)
+    candidate_bits_.back() = (1ULL << (S % 64)) - 1;
+
+  for (size_t n = 0; n < node_key.size(); ++n)
+    if (node_key[n])
+      node_by_key_.emplace(node_key[n], static_cast<int>(n));
+
+  table_ready_ = std::async(std::launch::async, [this] { fill_table(); });
+}
+
+template <int L> LiveEngine<L>::~LiveEngine() {
+  if (table_ready_.valid())
+    table_ready_.wait();
+}
+
+template <int L> void LiveEngine<L>::fill_table() {
+  const auto *guesses = words_.packed_guesses<L>();
+  const auto *solutions = words_.packed_solutions<L>();
+  const size_t S = words_.num_solutions();
+  table_.resize(probes_.size() * S);
+  for (size_t r = 0; r < probes_.size(); ++r) {
+    const auto &g = guesses[probes_[r]];
+    Pattern *row = &table_[r * S];
+    for (size_t s = 0; s < S; ++s)
+      row[s] = calc_pattern<L>(g, solutions[s]);
+  }
+}
+
+template <int L> bool LiveEngine<L>::is_node_set(int node) const {
+  constexpr Pattern kSolved = WordTraits<L>::kSolvedPattern;
+  if (node_size_[node] != candidates_.size())
+    return false;
+  const auto *guesses = words_.packed_guesses<L>();
+  const auto *solutions = words_.packed_solutions<L>();
+  for (uint16_t s : candidates_) {
+    int at = solver_.get_root_index();
+    for (int step = 0; step < 32 && at >= 0 && at != node; ++step) {
+      Pattern p =
+          calc_pattern<L>(guesses[solver_.get_node(at).guess_index],
+                          solutions[s]);
+      uint32_t next = p == kSolved ? kNoChild : solver_.next_node<L>(at, p);
+      at = next == kNoChild ? -1 : static_cast<int>(next);
+    }
+    if (at != node)
+      return false;
+  }
+  return true;
+}
+
+template <int L> bool LiveEngine<L>::apply(uint16_t guess, Pattern feedback) {
+  std::vector<uint64_t> next = candidate_bits_;
+  index_.filter(words_.packed_guesses<L>()[guess], feedback, next.data());
+  if (std::all_of(next.begin(), next.end(), [](uint64_t w) { return !w; }))
+    return false;
+  candidate_bits_ = std::move(next);
+
+  candidates_.clear();
+  set_key_ = 0;
+  for (size_t w = 0; w < candidate_bits_.size(); ++w) {
+    for (uint64_t bits = candidate_bits_[w]; bits; bits &= bits - 1) {
+      uint32_t s = static_cast<uint32_t>(w * 64 + __builtin_ctzll(bits));
+      candidates_.push_back(static_cast<uint16_t>(s));
+      set_key_ += solution_key(s);
+    }
+  }
+
+  // Follow the tree if the player took its suggestion, otherwise look for a
+  // node built for exactly this candidate set.
+  if (node_ >= 0 && solver_.get_node(node_).guess_index == guess) {
+    uint32_t child = solver_.next_node<L>(node_, feedback);
+    if (child != kNoChild) {
+      node_ = static_cast<int>(child);
+      return true;
+    }
+  }
+  auto it = node_by_key_.find(set_key_);
+  node_ = it != node_by_key_.end() && is_node_set(it->second) ? it->second
+                                                              : -1;
+  return true;
+}
+
+template <int L> uint16_t LiveEngine<L>::recommend() {
+  if (node_ >= 0)
+    return solver_.get_node(node_).guess_index;
+
+  table_ready_.wait();
+  const auto start = std::chrono::steady_clock::now();
+  const size_t S = words_.num_solutions();
+
+  // Lower is better: sum of squared bucket sizes (k times the expected
+  // candidates left), doubled so a candidate wins ties (it may be the
+  // answer).
+  uint64_t best_score = UINT64_MAX;
+  int best_row = -1; // A candidate that is also a guess, if any
+  for (uint16_t s : candidates_)
+    if (best_row < 0)
+      best_row = solution_probe_[s];
+  size_t scored = 0;
+  auto score = [&](size_t r, bool is_candidate) {
+    const Pattern *row = &table_[r * S];
+    uint64_t sum = 0;
+    for (uint16_t s : candidates_) {
+      uint32_t &c = counts_[row[s]];
+      sum += 2 * c + 1; // (c+1)^2 - c^2
+      ++c;
+    }
+    for (uint16_t s : candidates_)
+      counts_[row[s]] = 0;
+    uint64_t total = 2 * sum + (is_candidate ? 0 : 1);
+    if (total < best_score) {
+      best_score = total;
+      best_row = static_cast<int>(r);
+    }
+    ++scored;
+  };
+
+  // Two candidates: guess either. Otherwise, or if neither can be guessed,
+  // score the probes.
+  if (candidates_.size() > 2 || best_row < 0) {
+    for (uint16_t s : candidates_)
+      if (solution_probe_[s] >= 0)
+        score(solution_probe_[s], true);
+    // Candidates were scored above; non-candidate solutions are still
+    // useful probes, tree guesses more so, so they go first.
+    std::vector<bool> is_candidate(num_solution_probes_, false);
+    for (uint16_t s : candidates_)
+      if (solution_probe_[s] >= 0)
+        is_candidate[solution_probe_[s]] = true;
+    for (size_t i = 0; i < probes_.size(); ++i) {
+      size_t r = (i + num_solution_probes_) % probes_.size();
+      if (r < num_solution_probes_ && is_candidate[r])
+        continue;
+      if ((i & 31) == 0 &&
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start)
+                  .count() >= budget_us_)
+        break;
+      score(r, false);
+    }
+  }
+
+  last_scored_ = scored;
+  last_micros_ = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  return best_row >= 0
+             ? probes_[best_row]
+             : solver_.get_node(solver_.get_root_index()).guess_index;
+}
+
+template class LiveEngine<4>;
+template class LiveEngine<5>;
+template class LiveEngine<6>;
+template class LiveEngine<7>;
+template class LiveEngine<8>;
+
+} // namespace wordle
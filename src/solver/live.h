@@ -0,0 +1,92 @@
+#pragma once
+#include "libwordle_core/letterindex.h"
+#include "libwordle_core/pattern.h"
+#include "solver.h"
+#include <cstdint>
+#include <future>
+#include <unordered_map>
+#include <vector>
+
+namespace wordle {
+
+// Follows the tree while the player plays its suggestions and keeps playing
+// when they do not. The engine tracks the solutions consistent with every
+// (guess, feedback) seen as a bitset narrowed through a letter index; off
+// the tree it scores guesses against that set on
+// the fly, and it rejoins the tree as soon as the set equals the set some
+// node was built for.
+//
+// Scoring reads a compact pattern table: only the guesses the tree plays
+// somewhere (the builder's own shortlist of useful probes) and the solutions
+// themselves, against every solution. That is about a fifth of the full
+// table and is filled on a background thread while the player thinks about
+// the first move. Candidates are always scored; the other probes are scored
+// until the time budget runs out.
+template <int L> class LiveEngine {
+public:
+  using Pattern = typename WordTraits<L>::Pattern;
+
+  LiveEngine(const Solver &solver, const WordTables &words,
+             long budget_us = 800);
+  ~LiveEngine();
+
+  // Applies a played guess and its (non-solved) feedback. Returns false and
+  // keeps the state if no candidate is consistent with it.
+  bool apply(uint16_t guess, Pattern feedback);
+
+  // Next guess: the tree's while on it, otherwise the best live score.
+  uint16_t recommend();
+
+  bool on_tree() const { return node_ >= 0; }
+  int node() const { return node_; } // -1 when off the tree
+  size_t num_candidates() const { return candidates_.size(); }
+
+  // Last live recommendation: guesses scored and time taken.
+  size_t last_scored() const { return last_scored_; }
+  long last_micros() const { return last_micros_; }
+
+private:
+  // Zobrist key of one solution; a set's key is the sum of its members'.
+  static uint64_t solution_key(uint32_t s);
+
+  void fill_table();
+
+  // True if the candidates are exactly the solutions whose games pass
+  // through `node`: as many of them, and each one's game reaches it. Keys
+  // only find the node; this rules out a collision.
+  bool is_node_set(int node) const;
+
+  const Solver &solver_;
+  const WordTables &words_;
+  long budget_us_;
+
+  int node_; // Current tree node, -1 when off the tree
+  BasicLetterIndex<L> index_;
+  std::vector<uint64_t> candidate_bits_;
+  std::vector<uint16_t> candidates_; // The same set as solution indices
+  uint64_t set_key_ = 0;
+
+  // Candidate-set key of every tree node, for rejoining, and the number of
+  // solutions that reach each node.
+  std::unordered_map<uint64_t, int> node_by_key_;
+  std::vector<uint32_t> node_size_;
+
+  // Probe rows: solutions' guesses first, then the remaining tree guesses.
+  std::vector<uint16_t> probes_;
+  size_t num_solution_probes_ = 0;
+  std::vector<int32_t> solution_probe_; // Solution index -> probe row or -1
+  std::vector<Pattern> table_;          // probes_.size() x num_solutions
+  std::future<void> table_ready_;
+
+  std::vector<uint32_t> counts_;
+  size_t last_scored_ = 0;
+  long last_micros_ = 0;
+};
+
+extern template class LiveEngine<4>;
+extern template class LiveEngine<5>;
+extern template class LiveEngine<6>;
+extern template class LiveEngine<7>;
+extern template class LiveEngine<8>;
+
+} // namespace wordle
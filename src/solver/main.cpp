@@ -1,16 +1,122 @@
 #include "libwordle_core/pattern.h"
+#include "libwordle_core/perfcounters.h"
 #include "libwordle_core/wordlist.h"
+#include "live.h"
+#include "multi_solver.h"
 #include "solver.h"
+#ifdef WORDLE_STATIC_TREE
+#include "static_artifact.h"
+#endif
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <numeric>
+#include <random>
+#include <sstream>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
 #include <vector>
 
-uint8_t parse_feedback(const std::string &input) {
-  if (input.size() != 5)
-    return 255;
-  uint8_t res = 0;
+namespace {
+
+// Parses a plain non-negative decimal option value no larger than `max`.
+// Prints a usage error naming `option` instead of letting std::stoul and
+// friends throw or wrap negative input.
+bool parse_count_arg(const std::string &option, const std::string &value,
+                     unsigned long long max, unsigned long long &out) {
+  char *end = nullptr;
+  errno = 0;
+  const unsigned long long n = std::strtoull(value.c_str(), &end, 10);
+  if (value.empty() || !std::isdigit(static_cast<unsigned char>(value[0])) ||
+      *end != '\0' || errno == ERANGE || n > max) {
+    std::cerr << "Invalid " << option << ": " << value << " (expected 0 to "
+              << max << ")" << std::endl;
+    return false;
+  }
+  out = n;
+  return true;
+}
+
+// Largest --throughput thread count; more only measures oversubscription.
+constexpr unsigned long long kMaxThroughputThreads = 1024;
+
+// Time from entering main() to the first suggestion being available.
+struct Startup {
+  std::chrono::steady_clock::time_point begin;
+  const char *source;              // Where the word tables came from
+  const char *load_mode = nullptr; // Load policy when read from a file
+  long long load_us = 0;
+
+  // `engine_us`: setting up the interactive live engine, if it ran.
+  void report(std::string_view first_guess, long long engine_us = -1) const {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - begin)
+                  .count();
+    std::cout << "Cold start: " << us << " µs to first suggestion ("
+              << first_guess << ", " << source;
+    if (load_mode)
+      std::cout << "; load " << load_us << " µs, " << load_mode;
+    if (engine_us >= 0)
+      std::cout << "; live engine " << engine_us << " µs";
+    std::cout << ")" << std::endl;
+  }
+};
+
+// --perf-json: counters opened before any thread starts, split into the
+// load phase and the mode that runs, written when the mode returns.
+struct PerfReport {
+  std::string path;
+  std::unique_ptr<wordle::PerfCounters> counters;
+  std::unique_ptr<wordle::PerfPhases> phases;
+
+  void open() {
+    if (path.empty())
+      return;
+    counters = std::make_unique<wordle::PerfCounters>();
+    if (!counters->any_available())
+      std::cerr << "Warning: No performance counters (" << counters->error()
+                << "); reporting wall time only." << std::endl;
+    phases = std::make_unique<wordle::PerfPhases>(*counters);
+    enter("load");
+  }
+
+  void enter(const char *name) {
+    if (phases)
+      phases->enter(phases->phase(name));
+  }
+
+  int finish(int rc) {
+    if (!phases)
+      return rc;
+    phases->stop();
+    if (!phases->write_json(path)) {
+      std::cerr << "Failed to write " << path << std::endl;
+      return 1;
+    }
+    std::cout << "Wrote performance counters to " << path << std::endl;
+    return rc;
+  }
+};
+
+// Returns kNumPatterns (one past the last valid pattern) on bad input.
+template <int L>
+typename wordle::WordTraits<L>::Pattern
+parse_feedback(const std::string &input) {
+  using Pattern = typename wordle::WordTraits<L>::Pattern;
+  constexpr Pattern kInvalid = wordle::WordTraits<L>::kNumPatterns;
+  if (input.size() != L)
+    return kInvalid;
+  Pattern res = 0;
   int mult = 1;
   for (char c : input) {
     int val = 0;
@@ -21,7 +127,7 @@ uint8_t parse_feedback(const std::string &input) {
     else if (c == 'G' || c == 'g')
       val = 2;
     else
-      return 255;
+      return kInvalid;
 
     res += val * mult;
     mult *= 3;
@@ -29,9 +135,9 @@ uint8_t parse_feedback(const std::string &input) {
   return res;
 }
 
-std::string pattern_to_string(uint8_t p) {
-  std::string res = "     ";
-  for (int i = 0; i < 5; ++i) {
+template <int L> std::string pattern_to_string(int p) {
+  std::string res(L, ' ');
+  for (int i = 0; i < L; ++i) {
     int val = p % 3;
     p /= 3;
     if (val == 0)
@@ -44,125 +150,256 @@ std::string pattern_to_string(uint8_t p) {
   return res;
 }
 
-int main(int argc, char **argv) {
-  std::string bin_path;
-  std::string s_path = "data/solutions.txt";
-  std::string g_path = "data/guesses.txt";
-  std::string target_word;
-  std::string single_list_path;
-  bool benchmark_mode = false;
-
-  std::vector<std::string> positional_args;
-  for (int i = 1; i < argc; ++i) {
-    std::string arg = argv[i];
-    if (arg == "--solve" && i + 1 < argc) {
-      target_word = argv[++i];
-    } else if (arg == "--single-list" && i + 1 < argc) {
-      single_list_path = argv[++i];
-    } else if (arg == "--benchmark") {
-      benchmark_mode = true;
-    } else {
-      positional_args.push_back(arg);
+// Remaining candidates at a tree node, read from the artifact's ranges:
+// " (<n> candidates: w1 w2 ...)", listed when there are only a few.
+template <int L>
+std::string describe_candidates(const wordle::Solver &solver,
+                                const wordle::WordTables &words, int node) {
+  constexpr size_t kMaxListed = 8;
+  const size_t count = solver.candidate_count(node);
+  std::string res = " (" + std::to_string(count) +
+                    (count == 1 ? " candidate" : " candidates");
+  if (count <= kMaxListed) {
+    const uint32_t *candidates = solver.candidates(node);
+    const auto *packed = words.packed_solutions<L>();
+    for (size_t i = 0; i < count; ++i) {
+      res += i ? " " : ": ";
+      for (int c = 0; c < L; ++c)
+        res += static_cast<char>('a' + packed[candidates[i]].chars[c]);
     }
   }
+  return res + ")";
+}
 
-  if (positional_args.empty()) {
-    std::cerr << "Usage: " << argv[0]
-              << " <solver_data.bin> [--solve <word> | --benchmark] "
-                 "[--single-list <path>] [solutions.txt] [guesses.txt]"
-              << std::endl;
-    return 1;
-  }
+// Concurrent throughput benchmark (--throughput). The same target list is
+// played `passes` times by each thread count in turn, split evenly across
+// the threads, all sharing one Solver.
+struct ThroughputOptions {
+  std::vector<unsigned int> thread_counts; // Empty: mode off
+  size_t games = 0;                        // 0: every solution once
+  int passes = 1;
+  bool random = false; // Uniform random targets instead of every solution
+  uint64_t seed = 42;
+};
 
-  bin_path = positional_args[0];
-  if (positional_args.size() > 1)
-    s_path = positional_args[1];
-  if (positional_args.size() > 2)
-    g_path = positional_args[2];
+// Only every kLatencyStride-th game is timed for the percentiles, so the
+// clock reads stay out of almost every game.
+constexpr size_t kLatencyStride = 16;
 
-  if (!single_list_path.empty()) {
-    s_path = single_list_path;
-    g_path = single_list_path;
-  }
+template <int L>
+int run_throughput(const wordle::Solver &solver,
+                   const wordle::WordTables &words,
+                   const ThroughputOptions &opts) {
+  using Pattern = typename wordle::WordTraits<L>::Pattern;
+  constexpr Pattern kSolved = wordle::WordTraits<L>::kSolvedPattern;
+  const auto *packed_guesses = words.packed_guesses<L>();
+  const auto *packed_solutions = words.packed_solutions<L>();
+  const size_t S = words.num_solutions();
+  const size_t games = opts.games ? opts.games : S;
 
-  wordle::WordList words;
-  if (!words.load(s_path, g_path)) {
-    std::cerr << "Failed to load word lists" << std::endl;
-    return 1;
-  }
+  std::vector<uint16_t> targets(games);
+  std::mt19937_64 rng(opts.seed);
+  std::uniform_int_distribution<size_t> pick(0, S - 1);
+  for (size_t g = 0; g < games; ++g)
+    targets[g] = static_cast<uint16_t>(opts.random ? pick(rng) : g % S);
 
-  wordle::Solver solver;
-  if (!solver.load(bin_path)) {
-    std::cerr << "Failed to load solver data" << std::endl;
-    return 1;
-  }
+  const size_t total = games * opts.passes;
+  std::cout << "Throughput: " << games << " games x " << opts.passes
+            << " passes (" << (opts.random ? "random" : "sequential")
+            << " targets";
+  if (opts.random)
+    std::cout << ", seed " << opts.seed;
+  std::cout << ") on " << std::thread::hardware_concurrency()
+            << " hardware threads" << std::endl;
+  std::cout << std::left << std::setw(9) << "Threads" << std::setw(14)
+            << "Games/s" << std::setw(9) << "p50 ns" << std::setw(9)
+            << "p90 ns" << std::setw(9) << "p99 ns" << std::setw(10)
+            << "max ns"
+            << "Efficiency" << std::endl;
 
-  if (solver.get_checksum() != words.get_checksum()) {
-    std::cerr << "Warning: Checksum mismatch! Word lists might be different."
+  double base_rate = 0;
+  long long checksum = 0; // Keeps the games from being optimized away
+  size_t failures = 0;
+  for (unsigned int n : opts.thread_counts) {
+    // Thread t plays games [total*t/n, total*(t+1)/n) of the repeated list
+    // and times a sample of them.
+    std::vector<std::vector<uint32_t>> latencies(n);
+    std::vector<long long> guesses(n, 0);
+    std::vector<size_t> failed(n, 0);
+    std::atomic<unsigned int> ready{0};
+    std::atomic<bool> go{false};
+    auto worker = [&](unsigned int t) {
+      const size_t begin = total * t / n, end = total * (t + 1) / n;
+      auto &lat = latencies[t];
+      lat.reserve((end - begin) / kLatencyStride + 1);
+      ready.fetch_add(1);
+      while (!go.load(std::memory_order_acquire))
+        std::this_thread::yield();
+      long long steps = 0;
+      size_t failures = 0;
+      for (size_t i = begin; i < end; ++i) {
+        const bool timed = i % kLatencyStride == 0;
+        std::chrono::steady_clock::time_point t0;
+        if (timed)
+          t0 = std::chrono::steady_clock::now();
+        const auto &target = packed_solutions[targets[i % games]];
+        int node = solver.get_root_index();
+        while (true) {
+          ++steps;
+          uint16_t g = solver.get_node(node).guess_index;
+          Pattern p = wordle::calc_pattern<L>(packed_guesses[g], target);
+          if (p == kSolved)
+            break;
+          node = solver.next_node<L>(node, p);
+          if (node == static_cast<int>(wordle::kNoChild)) {
+            ++failures; // Not in the tree (e.g. a partial artifact)
+            break;
+          }
+        }
+        if (timed)
+          lat.push_back(static_cast<uint32_t>(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - t0)
+                  .count()));
+      }
+      guesses[t] = steps;
+      failed[t] = failures;
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < n; ++t)
+      threads.emplace_back(worker, t);
+    while (ready.load() < n)
+      std::this_thread::yield();
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto &th : threads)
+      th.join();
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    std::vector<uint32_t> all;
+    all.reserve(total / kLatencyStride + 1);
+    for (unsigned int t = 0; t < n; ++t) {
+      all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+      checksum += guesses[t];
+      failures += failed[t];
+    }
+    auto percentile = [&](double q) {
+      size_t k = std::min(all.size() - 1,
+                          static_cast<size_t>(q * (all.size() - 1) + 0.5));
+      std::nth_element(all.begin(), all.begin() + k, all.end());
+      return all[k];
+    };
+    uint32_t p50 = percentile(0.50), p90 = percentile(0.90),
+             p99 = percentile(0.99);
+    uint32_t max = *std::max_element(all.begin(), all.end());
+
+    double rate = total / seconds;
+    if (base_rate == 0)
+      base_rate = rate / n; // Per-thread rate of the first count
+    std::ostringstream eff;
+    eff << std::fixed << std::setprecision(1)
+        << 100.0 * rate / (base_rate * n) << "%";
+    std::ostringstream gps;
+    gps << std::fixed << std::setprecision(0) << rate;
+    std::cout << std::left << std::setw(9) << n << std::setw(14) << gps.str()
+              << std::setw(9) << p50 << std::setw(9) << p90 << std::setw(9)
+              << p99 << std::setw(10) << max << eff.str() << std::endl;
+  }
+  std::cout << "Average guesses: "
+            << static_cast<double>(checksum) /
+                   (total * opts.thread_counts.size())
+            << std::endl;
+  if (failures) {
+    std::cerr << "Failed " << failures << " games (solution not in the tree)."
               << std::endl;
+    return 1;
   }
+  return 0;
+}
+
+// Plays every solution through the tree; returns the total guesses.
+template <int L>
+long long play_all(const wordle::Solver &solver,
+                   const wordle::WordTables &words) {
+  using Pattern = typename wordle::WordTraits<L>::Pattern;
+  constexpr Pattern kSolved = wordle::WordTraits<L>::kSolvedPattern;
+  const auto *packed_guesses = words.packed_guesses<L>();
+  const auto *packed_solutions = words.packed_solutions<L>();
 
-  // Pre-pack all guesses for fast simulation
-  std::vector<wordle::PackedWord> packed_guesses(words.get_guesses().size());
-  for (size_t i = 0; i < words.get_guesses().size(); ++i) {
-    packed_guesses[i] = wordle::pack_word(words.get_guesses()[i]);
+  long long total_guesses = 0;
+  for (size_t s = 0; s < words.num_solutions(); ++s) {
+    const wordle::BasicPackedWord<L> &target = packed_solutions[s];
+    int current_node = solver.get_root_index();
+    int steps = 0;
+    while (true) {
+      steps++;
+      const auto &node = solver.get_node(current_node);
+      Pattern pattern =
+          wordle::calc_pattern<L>(packed_guesses[node.guess_index], target);
+      if (pattern == kSolved)
+        break;
+      current_node = solver.next_node<L>(current_node, pattern);
+    }
+    total_guesses += steps;
   }
+  return total_guesses;
+}
+
+// Runs the requested mode with patterns specialized on the word length the
+// artifact was built for.
+template <int L>
+int run(const wordle::Solver &solver, const wordle::WordTables &words,
+        const std::string &target_word, bool benchmark_mode,
+        const ThroughputOptions &throughput, const Startup &startup) {
+  using Pattern = typename wordle::WordTraits<L>::Pattern;
+  constexpr Pattern kSolved = wordle::WordTraits<L>::kSolvedPattern;
+
+  // Words arrive packed from the loader, ready for fast simulation.
+  const wordle::BasicPackedWord<L> *packed_guesses = words.packed_guesses<L>();
 
   int root_node = solver.get_root_index();
+  // Interactive mode reports once its live engine is set up, which is on
+  // the way to its first suggestion.
+  const bool interactive = target_word.empty() && !benchmark_mode &&
+                           throughput.thread_counts.empty();
+  if (target_word.empty() && !interactive)
+    startup.report(words.guess(solver.get_node(root_node).guess_index));
+
+  if (!throughput.thread_counts.empty())
+    return run_throughput<L>(solver, words, throughput);
 
   if (benchmark_mode) {
-    std::cout << "Benchmarking against all " << words.get_solutions().size()
+    std::cout << "Benchmarking against all " << words.num_solutions()
               << " solutions..." << std::endl;
     auto start_total = std::chrono::high_resolution_clock::now();
-
-    long long total_guesses = 0;
-
-    for (const auto &sol_str : words.get_solutions()) {
-      wordle::PackedWord target = wordle::pack_word(sol_str);
-      int current_node = root_node;
-      int steps = 0;
-      while (true) {
-        steps++;
-        const auto &node = solver.get_node(current_node);
-        // Use packed guess directly? Node has guess_index.
-        // We need the guess word to calc pattern.
-        const auto &guess_packed = packed_guesses[node.guess_index];
-
-        uint8_t pattern = wordle::calc_pattern(guess_packed, target);
-
-        if (pattern == 242) {
-          break;
-        }
-
-        int next = solver.get_next_node(current_node, pattern);
-        current_node = next;
-      }
-      total_guesses += steps;
-    }
-
+    long long total_guesses = play_all<L>(solver, words);
     auto end_total = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
                         end_total - start_total)
                         .count();
 
-    std::cout << "Solved " << words.get_solutions().size() << " games in "
+    std::cout << "Solved " << words.num_solutions() << " games in "
               << duration / 1000.0 << " ms." << std::endl;
     std::cout << "Average time per game: "
-              << duration / (double)words.get_solutions().size() << " µs."
+              << duration / (double)words.num_solutions() << " µs."
               << std::endl;
     std::cout << "Average guesses: "
-              << (double)total_guesses / words.get_solutions().size()
+              << (double)total_guesses / words.num_solutions()
               << std::endl;
 
   } else if (!target_word.empty()) {
     // Non-interactive mode
-    if (target_word.size() != 5) {
-      std::cerr << "Error: Target word must be 5 characters." << std::endl;
+    if (target_word.size() != L) {
+      std::cerr << "Error: Target word must be " << L << " characters."
+                << std::endl;
       return 1;
     }
     std::cout << "Solving for target: " << target_word << std::endl;
 
-    wordle::PackedWord target = wordle::pack_word(target_word);
+    wordle::BasicPackedWord<L> target = wordle::pack_word<L>(target_word);
 
     auto start_time = std::chrono::high_resolution_clock::now();
     int current_node = root_node;
@@ -172,16 +409,16 @@ int main(int argc, char **argv) {
       steps++;
       const auto &node = solver.get_node(current_node);
       // Get string for display
-      std::string guess_str = words.get_guesses()[node.guess_index];
+      std::string_view guess_str = words.guess(node.guess_index);
       const auto &guess_packed = packed_guesses[node.guess_index];
 
-      uint8_t pattern = wordle::calc_pattern(guess_packed, target);
-      std::string pat_str = pattern_to_string(pattern);
+      Pattern pattern = wordle::calc_pattern<L>(guess_packed, target);
+      std::string pat_str = pattern_to_string<L>(pattern);
 
       std::cout << "Guess " << steps << ": " << guess_str << " (" << pat_str
                 << ")" << std::endl;
 
-      if (pattern == 242) {
+      if (pattern == kSolved) {
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
                             end_time - start_time)
@@ -191,7 +428,7 @@ int main(int argc, char **argv) {
         break;
       }
 
-      int next = solver.get_next_node(current_node, pattern);
+      int next = solver.next_node<L>(current_node, pattern);
       if (next == -1 || next == (int)0xFFFFFFFF) {
         std::cout << "Error: Impossible state reached or word not in tree."
                   << std::endl;
@@ -206,42 +443,606 @@ int main(int argc, char **argv) {
     }
 
   } else {
-    // Interactive mode (unchanged)
+    // Interactive mode. Players may play a word other than the suggestion
+    // by typing "<guess> <feedback>"; the live engine then recommends from
+    // the remaining candidates until they match a tree node again.
+    const auto engine_start = std::chrono::steady_clock::now();
+    wordle::LiveEngine<L> live(solver, words);
+    startup.report(words.guess(live.recommend()),
+                   std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - engine_start)
+                       .count());
     std::cout << "Wordle Solver Ready." << std::endl;
-    int current_node = root_node;
     while (true) {
-      const auto &node = solver.get_node(current_node);
-      std::string guess = words.get_guesses()[node.guess_index];
-      std::cout << "Suggestion: " << guess << std::endl;
+      const bool on_tree = live.on_tree();
+      uint16_t suggestion = live.recommend();
+      std::cout << "Suggestion: " << words.guess(suggestion);
+      // Ranges index the artifact's solution count; text lists must agree.
+      if (on_tree && solver.has_ranges() &&
+          solver.num_solutions() == words.num_solutions())
+        std::cout << describe_candidates<L>(solver, words, live.node());
+      if (!on_tree)
+        std::cout << " (off-tree: " << live.num_candidates()
+                  << " candidates, " << live.last_scored() << " guesses scored in "
+                  << live.last_micros() << " µs)";
+      std::cout << std::endl;
 
       std::string input;
-      std::cout << "Enter Feedback (GYB): ";
-      std::cin >> input;
+      std::cout << "Enter Feedback (GYB), or <guess> <feedback>: ";
+      if (!(std::cin >> input) || input == "exit" || input == "quit")
+        break;
 
-      if (input == "exit" || input == "quit")
+      uint16_t played = suggestion;
+      Pattern pattern = parse_feedback<L>(input);
+      if (pattern == wordle::WordTraits<L>::kNumPatterns) {
+        int g = words.find_guess(input);
+        std::string feedback;
+        if (g < 0 || !(std::cin >> feedback) ||
+            (pattern = parse_feedback<L>(feedback)) ==
+                wordle::WordTraits<L>::kNumPatterns) {
+          std::cout << "Invalid input. Use " << L
+                    << " chars G/Y/B, optionally after the word you played. "
+                       "Example: "
+                    << std::string(L, 'G') << std::endl;
+          continue;
+        }
+        played = static_cast<uint16_t>(g);
+      }
+
+      if (pattern == kSolved) { // GGGGG
+        std::cout << "Solved! The word was " << words.guess(played) << "."
+                  << std::endl;
         break;
+      }
 
-      uint8_t pattern = parse_feedback(input);
-      if (pattern == 255) {
-        std::cout << "Invalid input. Use 5 chars G/Y/B. Example: GYBBG"
+      if (!live.apply(played, pattern)) {
+        std::cout << "Impossible pattern: no solution fits every feedback."
                   << std::endl;
         continue;
       }
+    }
+  }
 
-      if (pattern == 242) { // GGGGG
-        std::cout << "Solved! The word was " << guess << "." << std::endl;
-        break;
+  return 0;
+}
+
+// Splits "w1,w2" (or "w1 w2") into words.
+std::vector<std::string> split_words(const std::string &s) {
+  std::string spaced = s;
+  std::replace(spaced.begin(), spaced.end(), ',', ' ');
+  std::istringstream in(spaced);
+  std::vector<std::string> out;
+  for (std::string w; in >> w;)
+    out.push_back(w);
+  return out;
+}
+
+// True if guess `g` is in the solution list.
+template <int L>
+bool is_solution(const wordle::WordTables &words, uint16_t g) {
+  const auto &guess = words.packed_guesses<L>()[g];
+  const auto *solutions = words.packed_solutions<L>();
+  for (size_t s = 0; s < words.num_solutions(); ++s)
+    if (std::equal(guess.chars, guess.chars + L, solutions[s].chars))
+      return true;
+  return false;
+}
+
+// Multi-board counterpart of run(): one guess per turn for every board.
+template <int L>
+int run_multi(const wordle::MultiSolver &solver,
+              const wordle::WordTables &words, const std::string &target_word,
+              bool benchmark_mode, const Startup &startup) {
+  using Pattern = typename wordle::WordTraits<L>::Pattern;
+  constexpr Pattern kSolved = wordle::WordTraits<L>::kSolvedPattern;
+  const int n = solver.num_boards();
+  if (target_word.empty())
+    startup.report(words.guess(solver.guess(solver.root())));
+
+  const wordle::BasicPackedWord<L> *packed_guesses = words.packed_guesses<L>();
+
+  // Plays one tuple of targets; returns guesses used or -1 on failure.
+  auto play = [&](const wordle::BasicPackedWord<L> *targets, bool verbose) {
+    auto cursor = solver.root();
+    bool done[wordle::kMaxBoards] = {};
+    for (int step = 1; step <= solver.max_guesses(); ++step) {
+      uint16_t g = solver.guess(cursor);
+      uint16_t feedback[wordle::kMaxBoards];
+      bool all_done = true;
+      for (int b = 0; b < n; ++b) {
+        feedback[b] = done[b] ? kSolved
+                              : wordle::calc_pattern<L>(packed_guesses[g],
+                                                        targets[b]);
+        done[b] = feedback[b] == kSolved;
+        all_done &= done[b];
+      }
+      if (verbose) {
+        std::cout << "Guess " << step << ": " << words.guess(g)
+                  << " (";
+        for (int b = 0; b < n; ++b)
+          std::cout << (b ? " " : "") << pattern_to_string<L>(feedback[b]);
+        std::cout << ")" << std::endl;
       }
+      if (all_done)
+        return step;
+      if (!solver.advance(cursor, feedback))
+        return -1;
+    }
+    return -1;
+  };
 
-      int next = solver.get_next_node(current_node, pattern);
-      if (next == -1 || next == (int)0xFFFFFFFF) {
+  if (benchmark_mode) {
+    // Every ordered tuple when there are at most a million, otherwise a
+    // fixed-seed sample of that size.
+    const size_t S = words.num_solutions();
+    double tuples = std::pow(static_cast<double>(S), n);
+    const size_t games = tuples <= 1e6 ? static_cast<size_t>(tuples) : 1000000;
+    const wordle::BasicPackedWord<L> *packed_solutions =
+        words.packed_solutions<L>();
+
+    std::cout << "Benchmarking " << games << " " << n << "-board games"
+              << (games < tuples ? " (sampled)" : "") << "..." << std::endl;
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, S - 1);
+    std::vector<wordle::BasicPackedWord<L>> targets(games * n);
+    for (size_t g = 0; g < games; ++g) {
+      size_t rest = g;
+      for (int b = 0; b < n; ++b) {
+        size_t idx = games < tuples ? pick(rng) : rest % S;
+        rest /= S;
+        targets[g * n + b] = packed_solutions[idx];
+      }
+    }
+
+    auto start_total = std::chrono::high_resolution_clock::now();
+    long long total_guesses = 0;
+    size_t failures = 0;
+    for (size_t g = 0; g < games; ++g) {
+      int steps = play(&targets[g * n], false);
+      if (steps < 0)
+        ++failures;
+      else
+        total_guesses += steps;
+    }
+    auto end_total = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                        end_total - start_total)
+                        .count();
+
+    std::cout << "Solved " << games - failures << " games in "
+              << duration / 1000.0 << " ms." << std::endl;
+    std::cout << "Average time per game: " << duration / (double)games
+              << " µs." << std::endl;
+    std::cout << "Average guesses: "
+              << (double)total_guesses / (games - failures) << std::endl;
+    if (failures) {
+      std::cerr << "Failed " << failures << " games." << std::endl;
+      return 1;
+    }
+
+  } else if (!target_word.empty()) {
+    auto targets_str = split_words(target_word);
+    if (static_cast<int>(targets_str.size()) != n) {
+      std::cerr << "Error: Expected " << n << " comma-separated targets."
+                << std::endl;
+      return 1;
+    }
+    std::vector<wordle::BasicPackedWord<L>> targets;
+    for (const auto &t : targets_str) {
+      if (t.size() != L) {
+        std::cerr << "Error: Target word must be " << L << " characters."
+                  << std::endl;
+        return 1;
+      }
+      targets.push_back(wordle::pack_word<L>(t));
+    }
+    int steps = play(targets.data(), true);
+    if (steps < 0) {
+      std::cout << "Error: Impossible state reached or word not in tree."
+                << std::endl;
+      return 1;
+    }
+    std::cout << "Solved in " << steps << " guesses!" << std::endl;
+
+  } else {
+    std::cout << "Wordle Solver Ready (" << n << " boards)." << std::endl;
+    auto cursor = solver.root();
+    bool done[wordle::kMaxBoards] = {};
+    while (true) {
+      std::string_view guess = words.guess(solver.guess(cursor));
+      std::cout << "Suggestion: " << guess << std::endl;
+      std::cout << "Enter Feedback per board (GYB,GYB...; solved boards "
+                   "are skipped): ";
+      std::string line;
+      if (!std::getline(std::cin >> std::ws, line))
+        break;
+      if (line == "exit" || line == "quit")
+        break;
+
+      auto parts = split_words(line);
+      uint16_t feedback[wordle::kMaxBoards];
+      size_t next_part = 0;
+      bool valid = true, all_done = true;
+      for (int b = 0; b < n && valid; ++b) {
+        if (done[b]) {
+          feedback[b] = kSolved;
+          continue;
+        }
+        if (next_part >= parts.size()) {
+          valid = false;
+          break;
+        }
+        Pattern p = parse_feedback<L>(parts[next_part++]);
+        valid = p != wordle::WordTraits<L>::kNumPatterns;
+        feedback[b] = p;
+      }
+      if (!valid || next_part != parts.size()) {
+        std::cout << "Invalid input. Give one " << L
+                  << "-letter G/Y/B string per unsolved board." << std::endl;
+        continue;
+      }
+      // Boards only count as solved once the tree accepts the feedback.
+      bool now_done[wordle::kMaxBoards] = {};
+      for (int b = 0; b < n; ++b) {
+        now_done[b] = feedback[b] == kSolved;
+        all_done &= now_done[b];
+      }
+      auto next = cursor;
+      // The tree has no edge for the final all-solved feedback, but it only
+      // happens when the guess is itself a solution.
+      const bool accepted =
+          all_done ? is_solution<L>(words, solver.guess(cursor))
+                   : solver.advance(next, feedback);
+      if (!accepted) {
         std::cout << "Impossible pattern (or not found in tree)." << std::endl;
         continue;
       }
-
-      current_node = next;
+      if (all_done) {
+        std::cout << "Solved every board!" << std::endl;
+        break;
+      }
+      std::copy(now_done, now_done + n, done);
+      cursor = next;
     }
   }
+  return 0;
+}
+
+#ifndef WORDLE_STATIC_TREE
+long long play_all_lengths(const wordle::Solver &solver,
+                           const wordle::WordTables &words) {
+  switch (solver.word_length()) {
+  case 4:
+    return play_all<4>(solver, words);
+  case 6:
+    return play_all<6>(solver, words);
+  case 7:
+    return play_all<7>(solver, words);
+  case 8:
+    return play_all<8>(solver, words);
+  default:
+    return play_all<5>(solver, words);
+  }
+}
+
+long page_faults() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_minflt + usage.ru_majflt;
+}
+
+// --compare-load-modes: loads the artifact once per policy, each time after
+// asking the kernel to drop it from the page cache (best effort), and times
+// the load, the first suggestion, a first pass over every solution (cold
+// pages for the lazy policies) and a second, warm pass. Page faults are
+// counted from the load to the end of the first pass. Word tables come from
+// the artifact when embedded, otherwise from `list`.
+int compare_load_modes(const std::string &path, const std::string &tree,
+                       const std::string &s_path, const std::string &g_path,
+                       bool lists_given) {
+  using Clock = std::chrono::steady_clock;
+  auto us = [](Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(b - a)
+        .count();
+  };
+  wordle::WordList list;
+
+  std::cout << std::left << std::setw(10) << "Mode" << std::setw(10)
+            << "Load µs" << std::setw(16) << "First move µs" << std::setw(15)
+            << "Cold pass µs" << std::setw(15) << "Warm pass µs"
+            << "Faults" << std::endl;
+  std::string first_move;
+  double average = 0;
+  for (int m = 0; m < 5; ++m) {
+    const auto mode = static_cast<wordle::LoadMode>(m);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd != -1) {
+      posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+      close(fd);
+    }
+
+    wordle::Solver solver;
+    const long faults_before = page_faults();
+    auto t0 = Clock::now();
+    if (!solver.load(path, mode, tree)) {
+      std::cerr << "Failed to load solver data" << std::endl;
+      return 1;
+    }
+    auto t1 = Clock::now();
 
+    wordle::WordTables words;
+    if (lists_given || !words.from_artifact(solver)) {
+      if (list.get_guesses().empty() &&
+          !list.load(s_path, g_path, solver.word_length()))
+        return 1;
+      if (solver.get_checksum() != list.get_checksum()) {
+        std::cerr << "Error: Checksum mismatch! The artifact was built from "
+                     "different word lists."
+                  << std::endl;
+        return 1;
+      }
+      words.from_list(list);
+    }
+    first_move =
+        words.guess(solver.get_node(solver.get_root_index()).guess_index);
+    auto t2 = Clock::now();
+    long long guesses = play_all_lengths(solver, words);
+    auto t3 = Clock::now();
+    const long faults = page_faults() - faults_before;
+    guesses += play_all_lengths(solver, words);
+    auto t4 = Clock::now();
+    average = static_cast<double>(guesses) / (2 * words.num_solutions());
+
+    std::cout << std::setw(10) << wordle::load_mode_name(mode)
+              << std::setw(10) << us(t0, t1) << std::setw(16) << us(t0, t2)
+              << std::setw(15) << us(t2, t3) << std::setw(15) << us(t3, t4)
+              << faults << std::endl;
+  }
+  std::cout << "First move: " << first_move
+            << ", average guesses: " << average << std::endl;
   return 0;
-}
\ No newline at end of file
+}
+#endif
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Startup startup{std::chrono::steady_clock::now(), "text lists"};
+  std::string bin_path;
+  std::string s_path = "data/solutions.txt";
+  std::string g_path = "data/guesses.txt";
+  std::string target_word;
+  std::string single_list_path;
+  bool benchmark_mode = false;
+  ThroughputOptions throughput;
+  PerfReport perf;
+#ifndef WORDLE_STATIC_TREE
+  wordle::LoadMode load_mode = wordle::LoadMode::Lazy;
+  bool compare_loads = false;
+  std::string tree;
+  bool list_trees = false;
+#endif
+
+  std::vector<std::string> positional_args;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--solve" && i + 1 < argc) {
+      target_word = argv[++i];
+    } else if (arg == "--single-list" && i + 1 < argc) {
+      single_list_path = argv[++i];
+    } else if (arg == "--benchmark") {
+      benchmark_mode = true;
+    } else if (arg == "--throughput" && i + 1 < argc) {
+      // Comma-separated thread counts, e.g. 1,2,4,8
+      for (const auto &n : split_words(argv[++i])) {
+        unsigned long long count;
+        if (!parse_count_arg(arg, n, kMaxThroughputThreads, count))
+          return 1;
+        if (count == 0) {
+          std::cerr << "Thread counts must be positive." << std::endl;
+          return 1;
+        }
+        throughput.thread_counts.push_back(static_cast<unsigned int>(count));
+      }
+    } else if (arg == "--games" && i + 1 < argc) {
+      unsigned long long games;
+      if (!parse_count_arg(arg, argv[++i],
+                           std::numeric_limits<size_t>::max(), games))
+        return 1;
+      throughput.games = games;
+    } else if (arg == "--passes" && i + 1 < argc) {
+      unsigned long long passes;
+      if (!parse_count_arg(arg, argv[++i], std::numeric_limits<int>::max(),
+                           passes))
+        return 1;
+      throughput.passes = std::max(1, static_cast<int>(passes));
+#ifdef WORDLE_STATIC_TREE
+    } else if (arg == "--load-mode" || arg == "--compare-load-modes" ||
+               arg == "--tree" || arg == "--list-trees") {
+      std::cerr << arg << " needs an artifact file; this solver has its tree "
+                          "compiled in."
+                << std::endl;
+      return 1;
+#else
+    } else if (arg == "--load-mode" && i + 1 < argc) {
+      if (!wordle::parse_load_mode(argv[++i], load_mode)) {
+        std::cerr << "Unknown load mode: " << argv[i]
+                  << " (use lazy, populate, willneed, hugepage or mlock)"
+                  << std::endl;
+        return 1;
+      }
+    } else if (arg == "--compare-load-modes") {
+      compare_loads = true;
+    } else if (arg == "--tree" && i + 1 < argc) {
+      tree = argv[++i];
+    } else if (arg == "--list-trees") {
+      list_trees = true;
+#endif
+    } else if (arg == "--perf-json" && i + 1 < argc) {
+      perf.path = argv[++i];
+    } else if (arg == "--random") {
+      throughput.random = true;
+    } else if (arg == "--seed" && i + 1 < argc) {
+      unsigned long long seed;
+      if (!parse_count_arg(arg, argv[++i],
+                           std::numeric_limits<uint64_t>::max(), seed))
+        return 1;
+      throughput.seed = seed;
+    } else {
+      positional_args.push_back(arg);
+    }
+  }
+
+  perf.open();
+  const char *mode = !throughput.thread_counts.empty() ? "throughput"
+                     : benchmark_mode                  ? "benchmark"
+                     : !target_word.empty()            ? "solve"
+                                                       : "interactive";
+
+#ifdef WORDLE_STATIC_TREE
+  // The tree is compiled in; positional arguments are only word lists.
+  const size_t first_list = 0;
+#else
+  const size_t first_list = 1;
+  if (positional_args.empty()) {
+    std::cerr << "Usage: " << argv[0]
+              << " <solver_data.bin> [--solve <word>[,<word>...] | --benchmark "
+                 "| --throughput <n,n,...> [--games <n>] [--passes <n>] "
+                 "[--random [--seed <n>]] | --compare-load-modes] "
+                 "[--load-mode lazy|populate|willneed|hugepage|mlock] "
+                 "[--tree <opener/heuristic> | --list-trees] "
+                 "[--perf-json <path>] "
+                 "[--single-list <path>] "
+                 "[solutions.txt] [guesses.txt]"
+              << std::endl;
+    return 1;
+  }
+  bin_path = positional_args[0];
+#endif
+
+  // Explicit lists override tables embedded in the artifact.
+  const bool lists_given =
+      positional_args.size() > first_list || !single_list_path.empty();
+  if (positional_args.size() > first_list)
+    s_path = positional_args[first_list];
+  if (positional_args.size() > first_list + 1)
+    g_path = positional_args[first_list + 1];
+
+  if (!single_list_path.empty()) {
+    s_path = single_list_path;
+    g_path = single_list_path;
+  }
+
+#ifndef WORDLE_STATIC_TREE
+  if (compare_loads)
+    return compare_load_modes(bin_path, tree, s_path, g_path, lists_given);
+
+  if (wordle::is_multi_artifact(bin_path)) {
+    wordle::MultiSolver multi;
+    if (!multi.load(bin_path)) {
+      std::cerr << "Failed to load solver data" << std::endl;
+      return 1;
+    }
+    wordle::WordList list;
+    if (!list.load(s_path, g_path, multi.word_length())) {
+      std::cerr << "Failed to load word lists" << std::endl;
+      return 1;
+    }
+    if (multi.get_checksum() != list.get_checksum()) {
+      std::cerr << "Error: Checksum mismatch! The artifact was built from "
+                   "different word lists."
+                << std::endl;
+      return 1;
+    }
+    wordle::WordTables words;
+    words.from_list(list);
+    perf.enter(mode);
+    switch (multi.word_length()) {
+    case 4:
+      return perf.finish(run_multi<4>(multi, words, target_word,
+                                      benchmark_mode, startup));
+    case 6:
+      return perf.finish(run_multi<6>(multi, words, target_word,
+                                      benchmark_mode, startup));
+    case 7:
+      return perf.finish(run_multi<7>(multi, words, target_word,
+                                      benchmark_mode, startup));
+    case 8:
+      return perf.finish(run_multi<8>(multi, words, target_word,
+                                      benchmark_mode, startup));
+    default:
+      return perf.finish(run_multi<5>(multi, words, target_word,
+                                      benchmark_mode, startup));
+    }
+  }
+#endif
+
+  wordle::Solver solver;
+#ifdef WORDLE_STATIC_TREE
+  if (!solver.load_image(wordle::kStaticArtifact,
+                         wordle::kStaticArtifactSize)) {
+#else
+  auto load_start = std::chrono::steady_clock::now();
+  if (!solver.load(bin_path, load_mode, tree)) {
+#endif
+    std::cerr << "Failed to load solver data" << std::endl;
+    return 1;
+  }
+#ifndef WORDLE_STATIC_TREE
+  startup.load_mode = wordle::load_mode_name(load_mode);
+  startup.load_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - load_start)
+                        .count();
+  if (list_trees) {
+    if (solver.tree_names().empty())
+      std::cout << bin_path << " is a single tree, not a bundle." << std::endl;
+    for (const auto &name : solver.tree_names())
+      std::cout << name << std::endl;
+    return 0;
+  }
+#endif
+
+  // Prefer the tables embedded in the artifact: no text parsing at all.
+  wordle::WordList list;
+  wordle::WordTables words;
+  if (!lists_given && words.from_artifact(solver)) {
+#ifdef WORDLE_STATIC_TREE
+    startup.source = "compiled-in tree";
+#else
+    startup.source = "embedded word tables";
+#endif
+  } else {
+    if (!list.load(s_path, g_path, solver.word_length())) {
+      std::cerr << "Failed to load word lists" << std::endl;
+      return 1;
+    }
+    // Guess indices in the tree are only meaningful for the lists it was
+    // built from.
+    if (solver.get_checksum() != list.get_checksum()) {
+      std::cerr << "Error: Checksum mismatch! The artifact was built from "
+                   "different word lists."
+                << std::endl;
+      return 1;
+    }
+    words.from_list(list);
+  }
+
+  perf.enter(mode);
+  switch (solver.word_length()) {
+  case 4:
+    return perf.finish(run<4>(solver, words, target_word, benchmark_mode,
+                              throughput, startup));
+  case 6:
+    return perf.finish(run<6>(solver, words, target_word, benchmark_mode,
+                              throughput, startup));
+  case 7:
+    return perf.finish(run<7>(solver, words, target_word, benchmark_mode,
+                              throughput, startup));
+  case 8:
+    return perf.finish(run<8>(solver, words, target_word, benchmark_mode,
+                              throughput, startup));
+  default:
+    return perf.finish(run<5>(solver, words, target_word, benchmark_mode,
+                              throughput, startup));
+  }
+}
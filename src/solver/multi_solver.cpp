@@ -0,0 +1,135 @@
+#include "multi_solver.h"
+#include "libwordle_core/pattern.h"
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wordle {
+
+bool is_multi_artifact(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+  uint32_t magic = 0;
+  bool multi = read(fd, &magic, sizeof(magic)) == sizeof(magic) &&
+               magic == kMultiArtifactMagic;
+  close(fd);
+  return multi;
+}
+
+bool MultiSolver::load(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    std::cerr << "Failed to open file: " << path << std::endl;
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    std::cerr << "Failed to get file size for: " << path << std::endl;
+    close(fd);
+    return false;
+  }
+  mapped_size_ = st.st_size;
+  if (mapped_size_ < sizeof(MultiArtifactHeader)) {
+    std::cerr << "File too small for header: " << path << std::endl;
+    close(fd);
+    return false;
+  }
+
+  void *mapped = mmap(nullptr, mapped_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    std::cerr << "Failed to mmap file: " << path << std::endl;
+    mapped_size_ = 0;
+    return false;
+  }
+  mapped_data_ = static_cast<const uint8_t *>(mapped);
+
+  std::memcpy(&header_, mapped_data_, sizeof(header_));
+  if (header_.magic != kMultiArtifactMagic ||
+      header_.version != kMultiArtifactVersion) {
+    std::cerr << "Invalid multi-board artifact (magic/version)" << std::endl;
+    return false;
+  }
+  if (header_.num_boards < 1 || header_.num_boards > kMaxBoards ||
+      header_.word_length < 4 || header_.word_length > 8 ||
+      header_.num_patterns !=
+          static_cast<uint32_t>(wordle::num_patterns(header_.word_length)) ||
+      (header_.edge_capacity & (header_.edge_capacity - 1)) != 0 ||
+      header_.edge_capacity == 0 || header_.root_index >= header_.num_nodes) {
+    std::cerr << "Invalid multi-board header" << std::endl;
+    return false;
+  }
+
+  size_t nodes_offset = sizeof(MultiArtifactHeader);
+  size_t edges_offset =
+      nodes_offset + static_cast<size_t>(header_.num_nodes) * sizeof(ArtifactNode);
+  if (edges_offset + static_cast<size_t>(header_.edge_capacity) *
+                         sizeof(MultiArtifactEdge) >
+      mapped_size_) {
+    std::cerr << "File too small for nodes and edges" << std::endl;
+    return false;
+  }
+  nodes_ = reinterpret_cast<const ArtifactNode *>(mapped_data_ + nodes_offset);
+  edges_ =
+      reinterpret_cast<const MultiArtifactEdge *>(mapped_data_ + edges_offset);
+
+  // advance() follows edges without further checks.
+  for (uint32_t i = 0; i < header_.edge_capacity; ++i) {
+    const MultiArtifactEdge &e = edges_[i];
+    if (e.parent != kNoChild &&
+        (e.parent >= header_.num_nodes || e.child >= header_.num_nodes)) {
+      std::cerr << "Edge " << i << " points outside the " << header_.num_nodes
+                << " nodes" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+MultiSolver::Cursor MultiSolver::root() const {
+  Cursor c;
+  c.node = header_.root_index;
+  return c;
+}
+
+bool MultiSolver::advance(Cursor &cursor, const uint16_t *feedback) const {
+  const int n = header_.num_boards;
+  uint16_t canon[kMaxBoards];
+  for (int b = 0; b < n; ++b)
+    canon[cursor.slot[b]] = feedback[b];
+
+  uint64_t key = 0, scale = 1;
+  for (int i = 0; i < n; ++i, scale *= header_.num_patterns)
+    key += canon[i] * scale;
+
+  // At most one pass over the table: a file without an empty slot must not
+  // loop forever on a missing key.
+  const uint64_t mask = header_.edge_capacity - 1;
+  const uint32_t parent = static_cast<uint32_t>(cursor.node);
+  uint64_t slot = multi_edge_slot(parent, key, header_.edge_capacity);
+  for (uint32_t probe = 0; probe < header_.edge_capacity;
+       ++probe, slot = (slot + 1) & mask) {
+    const MultiArtifactEdge &e = edges_[slot];
+    if (e.parent == kNoChild)
+      return false;
+    if (e.parent == parent && e.feedback == key) {
+      for (int b = 0; b < n; ++b)
+        cursor.slot[b] = (e.perm >> (2 * cursor.slot[b])) & 3;
+      cursor.node = static_cast<int>(e.child);
+      return true;
+    }
+  }
+  return false;
+}
+
+MultiSolver::~MultiSolver() {
+  if (mapped_data_)
+    munmap(const_cast<uint8_t *>(mapped_data_), mapped_size_);
+}
+
+} // namespace wordle
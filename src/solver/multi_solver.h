@@ -0,0 +1,55 @@
+#pragma once
+#include "libwordle_core/artifact.h"
+#include <cstdint>
+#include <string>
+
+namespace wordle {
+
+// True if `path` holds a multi-board artifact (checked by magic only).
+bool is_multi_artifact(const std::string &path);
+
+// Runtime for multi-board artifacts. Every step is one hash-table probe:
+// the caller's per-board feedback is permuted into the node's canonical
+// board order, packed into a single key and looked up with its parent.
+class MultiSolver {
+public:
+  // Position in the tree plus the canonical slot of every real board.
+  struct Cursor {
+    int node = 0;
+    uint8_t slot[kMaxBoards] = {0, 1, 2, 3};
+  };
+
+  MultiSolver() = default;
+  bool load(const std::string &path);
+
+  Cursor root() const;
+  uint16_t guess(const Cursor &cursor) const {
+    return nodes_[cursor.node].guess_index;
+  }
+
+  // Follows the edge for `feedback` (one pattern per board, in board order;
+  // boards already solved report the solved pattern). Returns false if the
+  // tuple is impossible or finishes every board.
+  bool advance(Cursor &cursor, const uint16_t *feedback) const;
+
+  uint64_t get_checksum() const { return header_.checksum; }
+  int word_length() const { return header_.word_length; }
+  int num_patterns() const { return header_.num_patterns; }
+  int num_boards() const { return header_.num_boards; }
+  int max_guesses() const { return header_.max_guesses; }
+
+  MultiSolver(const MultiSolver &) = delete;
+  MultiSolver &operator=(const MultiSolver &) = delete;
+
+  ~MultiSolver();
+
+private:
+  const uint8_t *mapped_data_ = nullptr;
+  size_t mapped_size_ = 0;
+
+  MultiArtifactHeader header_;
+  const ArtifactNode *nodes_ = nullptr;
+  const MultiArtifactEdge *edges_ = nullptr;
+};
+
+} // namespace wordle
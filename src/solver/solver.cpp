@@ -1,4 +1,7 @@
 #include "solver.h"
+#include "libwordle_core/artifact.h"
+#include <cerrno>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <fcntl.h>
@@ -6,15 +9,30 @@
 
 namespace wordle {
 
-struct Header {
-  uint32_t magic;
-  uint32_t version;
-  uint64_t checksum;
-  uint32_t num_nodes;
-  uint32_t root_index;
-};
+namespace {
 
-bool Solver::load(const std::string &path) {
+constexpr const char *kLoadModeNames[] = {"lazy", "populate", "willneed",
+                                          "hugepage", "mlock"};
+constexpr size_t kHugePageSize = 2u << 20;
+
+} // namespace
+
+const char *load_mode_name(LoadMode mode) {
+  return kLoadModeNames[static_cast<int>(mode)];
+}
+
+bool parse_load_mode(std::string_view name, LoadMode &mode) {
+  for (int i = 0; i < 5; ++i) {
+    if (name == kLoadModeNames[i]) {
+      mode = static_cast<LoadMode>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Solver::load(const std::string &path, LoadMode mode,
+                  const std::string &tree) {
   fd_ = open(path.c_str(), O_RDONLY);
   if (fd_ == -1) {
     std::cerr << "Failed to open file: " << path << std::endl;
@@ -28,28 +46,178 @@ bool Solver::load(const std::string &path) {
     fd_ = -1;
     return false;
   }
-  mapped_size_ = st.st_size;
+  const size_t size = st.st_size;
 
-  if (mapped_size_ < sizeof(Header)) {
+  if (size < sizeof(ArtifactHeaderV1)) {
     std::cerr << "File too small for header: " << path << std::endl;
     close(fd_);
     fd_ = -1;
     return false;
   }
 
-  mapped_data_ = (const uint8_t *)mmap(nullptr, mapped_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
-  if (mapped_data_ == MAP_FAILED) {
-    std::cerr << "Failed to mmap file: " << path << std::endl;
-    close(fd_);
-    fd_ = -1;
-    mapped_data_ = nullptr;
+  if (mode == LoadMode::HugePage) {
+    if (!copy_to_huge_pages(path, size)) {
+      cleanup_mmap_resources();
+      return false;
+    }
+  } else {
+    const int flags =
+        MAP_PRIVATE | (mode == LoadMode::Populate ? MAP_POPULATE : 0);
+    void *data = mmap(nullptr, size, PROT_READ, flags, fd_, 0);
+    if (data == MAP_FAILED) {
+      std::cerr << "Failed to mmap file: " << path << std::endl;
+      close(fd_);
+      fd_ = -1;
+      return false;
+    }
+    mapped_data_ = static_cast<const uint8_t *>(data);
+    mapped_size_ = size;
+
+    if (mode == LoadMode::WillNeed) {
+      madvise(data, size, MADV_SEQUENTIAL);
+      madvise(data, size, MADV_WILLNEED);
+    }
+    // Not fatal: the tree still works unpinned.
+    if (mode == LoadMode::Lock && mlock(data, size) != 0)
+      std::cerr << "Warning: mlock failed (" << std::strerror(errno)
+                << "); continuing unlocked." << std::endl;
+  }
+
+  if (!parse(mapped_data_, size, tree)) {
+    cleanup_mmap_resources();
+    return false;
+  }
+  return true;
+}
+
+// Reads the file into anonymous memory aligned and rounded to 2 MB so that
+// transparent huge pages can back all of it, then makes it read-only.
+bool Solver::copy_to_huge_pages(const std::string &path, size_t size) {
+  const size_t rounded = (size + kHugePageSize - 1) / kHugePageSize *
+                         kHugePageSize;
+  void *raw = mmap(nullptr, rounded + kHugePageSize, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) {
+    std::cerr << "Failed to allocate " << rounded << " bytes for: " << path
+              << std::endl;
     return false;
   }
+  // Trim the slack on both sides so the region starts on a 2 MB boundary.
+  auto *base = static_cast<uint8_t *>(raw);
+  auto *aligned = reinterpret_cast<uint8_t *>(
+      (reinterpret_cast<uintptr_t>(base) + kHugePageSize - 1) &
+      ~(uintptr_t)(kHugePageSize - 1));
+  if (aligned > base)
+    munmap(base, aligned - base);
+  if (size_t tail = kHugePageSize - (aligned - base))
+    munmap(aligned + rounded, tail);
+  mapped_data_ = aligned;
+  mapped_size_ = rounded;
 
-  const Header *h = reinterpret_cast<const Header *>(mapped_data_);
-  if (h->magic != 0x5752444C) {
+#ifdef MADV_HUGEPAGE
+  madvise(aligned, rounded, MADV_HUGEPAGE);
+#endif
+  for (size_t done = 0; done < size;) {
+    ssize_t n = pread(fd_, aligned + done, size - done, done);
+    if (n <= 0) {
+      std::cerr << "Failed to read file: " << path << std::endl;
+      return false;
+    }
+    done += n;
+  }
+  mprotect(aligned, rounded, PROT_READ);
+  close(fd_);
+  fd_ = -1;
+  return true;
+}
+
+bool Solver::load_image(const uint8_t *data, size_t size,
+                        const std::string &tree) {
+  if (size < sizeof(ArtifactHeaderV1)) {
+    std::cerr << "Image too small for header" << std::endl;
+    return false;
+  }
+  if (reinterpret_cast<uintptr_t>(data) % alignof(uint32_t) != 0) {
+    std::cerr << "Misaligned artifact image" << std::endl;
+    return false;
+  }
+  return parse(data, size, tree);
+}
+
+// Reads the TOC and selects `tree` (a full name or an opener; empty is the
+// first tree). The pool then parses like a version 3 artifact.
+bool Solver::parse_bundle(const uint8_t *data, size_t size,
+                          const std::string &tree) {
+  BundleHeader h;
+  if (size < sizeof(BundleHeader)) {
+    std::cerr << "File too small for bundle header" << std::endl;
+    return false;
+  }
+  std::memcpy(&h, data, sizeof(BundleHeader));
+  if (h.version != kBundleVersion) {
+    std::cerr << "Unsupported bundle version: " << h.version << std::endl;
+    return false;
+  }
+  if (h.num_trees == 0 ||
+      sizeof(BundleHeader) + static_cast<size_t>(h.num_trees) *
+                                 sizeof(BundleTree) >
+          size) {
+    std::cerr << "File too small for bundle TOC" << std::endl;
+    return false;
+  }
+  word_length_ = h.word_length;
+  num_patterns_ = h.num_patterns;
+  if (word_length_ < 4 || word_length_ > 8 ||
+      num_patterns_ != wordle::num_patterns(word_length_)) {
+    std::cerr << "Unsupported word length: " << word_length_ << std::endl;
+    return false;
+  }
+
+  tree_names_.clear();
+  const auto *toc =
+      reinterpret_cast<const BundleTree *>(data + sizeof(BundleHeader));
+  int selected = tree.empty() ? 0 : -1;
+  for (uint32_t t = 0; t < h.num_trees; ++t) {
+    tree_names_.emplace_back(toc[t].name,
+                             strnlen(toc[t].name, sizeof(toc[t].name)));
+    if (selected < 0 && tree_names_.back() == tree)
+      selected = static_cast<int>(t);
+  }
+  for (uint32_t t = 0; selected < 0 && t < h.num_trees; ++t)
+    if (tree == std::string_view(toc[t].opener,
+                                 strnlen(toc[t].opener, sizeof(toc[t].opener))))
+      selected = static_cast<int>(t);
+  if (selected < 0) {
+    std::cerr << "No tree " << tree << " in bundle" << std::endl;
+    return false;
+  }
+
+  tree_name_ = tree_names_[selected];
+  checksum_ = toc[selected].checksum;
+  num_nodes_ = h.num_nodes;
+  root_index_ = toc[selected].root_index;
+  header_v3_.flags = h.flags & kArtifactHasWords; // No ranges in bundles
+  header_v3_.num_guesses = h.num_guesses;
+  header_v3_.num_solutions = h.num_solutions;
+  header_v3_.words_offset = h.words_offset;
+  return parse_sections(data, size,
+                        sizeof(BundleHeader) +
+                            h.num_trees * sizeof(BundleTree));
+}
+
+// Validates the header and section bounds, then points the lookups into
+// `data`.
+bool Solver::parse(const uint8_t *data, size_t size,
+                   const std::string &tree) {
+  const auto *h = reinterpret_cast<const ArtifactHeaderV1 *>(data);
+  if (h->magic == kBundleMagic)
+    return parse_bundle(data, size, tree);
+  if (!tree.empty()) {
+    std::cerr << "Not a tree bundle; cannot select " << tree << std::endl;
+    return false;
+  }
+  if (h->magic != kArtifactMagic) {
     std::cerr << "Invalid Magic" << std::endl;
-    cleanup_mmap_resources();
     return false;
   }
 
@@ -57,29 +225,107 @@ bool Solver::load(const std::string &path) {
   num_nodes_ = h->num_nodes;
   root_index_ = h->root_index;
 
-  size_t nodes_offset = sizeof(Header);
+  size_t nodes_offset = sizeof(ArtifactHeaderV1);
+  if (h->version == 1) {
+    word_length_ = 5;
+    num_patterns_ = 243;
+  } else if ((h->version == 2 && size >= sizeof(ArtifactHeaderV2)) ||
+             (h->version == 3 && size >= sizeof(ArtifactHeader))) {
+    const auto *h2 = reinterpret_cast<const ArtifactHeaderV2 *>(data);
+    word_length_ = h2->word_length;
+    num_patterns_ = h2->num_patterns;
+    nodes_offset = sizeof(ArtifactHeaderV2);
+    if (h->version == 3) {
+      std::memcpy(&header_v3_, data, sizeof(ArtifactHeader));
+      nodes_offset = sizeof(ArtifactHeader);
+    }
+    if (word_length_ < 4 || word_length_ > 8 ||
+        num_patterns_ != wordle::num_patterns(word_length_)) {
+      std::cerr << "Unsupported word length: " << word_length_ << std::endl;
+      return false;
+    }
+  } else {
+    std::cerr << "Unsupported version: " << h->version << std::endl;
+    return false;
+  }
+  return parse_sections(data, size, nodes_offset);
+}
+
+bool Solver::parse_sections(const uint8_t *data, size_t size,
+                            size_t nodes_offset) {
   // Check if nodes_ array fits
-  if (nodes_offset + num_nodes_ * sizeof(SolverNode) > mapped_size_) {
+  if (nodes_offset + num_nodes_ * sizeof(SolverNode) > size) {
     std::cerr << "File too small for nodes" << std::endl;
-    cleanup_mmap_resources();
     return false;
   }
-  nodes_ = reinterpret_cast<const SolverNode *>(mapped_data_ + nodes_offset);
+  nodes_ = reinterpret_cast<const SolverNode *>(data + nodes_offset);
 
   size_t children_offset = nodes_offset + num_nodes_ * sizeof(SolverNode);
   // Check if children_ array fits
-  if (children_offset + num_nodes_ * 243 * sizeof(uint32_t) > mapped_size_) {
+  if (children_offset + static_cast<size_t>(num_nodes_) * num_patterns_ *
+                            sizeof(uint32_t) >
+      size) {
     std::cerr << "File too small for children" << std::endl;
-    cleanup_mmap_resources();
     return false;
   }
-  children_ =
-      reinterpret_cast<const uint32_t *>(mapped_data_ + children_offset);
+  children_ = reinterpret_cast<const uint32_t *>(data + children_offset);
+
+  // Candidate ranges, right after the children
+  const size_t children_end =
+      children_offset +
+      static_cast<size_t>(num_nodes_) * num_patterns_ * sizeof(uint32_t);
+  size_t tree_end = children_end; // End of the last tree section
+  if (header_v3_.flags & kArtifactHasRanges) {
+    const size_t range_bytes =
+        static_cast<size_t>(num_nodes_) * sizeof(ArtifactRange);
+    const size_t order_bytes =
+        static_cast<size_t>(header_v3_.num_solutions) * sizeof(uint32_t);
+    if (range_bytes + order_bytes > size - children_end) {
+      std::cerr << "File too small for candidate ranges" << std::endl;
+      return false;
+    }
+    tree_end += range_bytes + order_bytes;
+    ranges_ = reinterpret_cast<const ArtifactRange *>(data + children_end);
+    order_ =
+        reinterpret_cast<const uint32_t *>(data + children_end + range_bytes);
+    for (int n = 0; n < num_nodes_; ++n) {
+      if (ranges_[n].begin > ranges_[n].end ||
+          ranges_[n].end > header_v3_.num_solutions) {
+        std::cerr << "Candidate range out of bounds at node " << n
+                  << std::endl;
+        return false;
+      }
+    }
+    // Entries index the solution tables.
+    for (uint32_t i = 0; i < header_v3_.num_solutions; ++i) {
+      if (order_[i] >= header_v3_.num_solutions) {
+        std::cerr << "Candidate order entry " << i << " out of bounds"
+                  << std::endl;
+        return false;
+      }
+    }
+  }
+
+  // Embedded word tables (version 3)
+  if (header_v3_.flags & kArtifactHasWords) {
+    const size_t L = word_length_;
+    const size_t guess_bytes = static_cast<size_t>(header_v3_.num_guesses) * L;
+    const size_t solution_bytes =
+        static_cast<size_t>(header_v3_.num_solutions) * L;
+    const size_t offset = header_v3_.words_offset;
+    if (offset < tree_end || offset > size ||
+        2 * guess_bytes + solution_bytes > size - offset) {
+      std::cerr << "Word tables overlap the tree or do not fit" << std::endl;
+      return false;
+    }
+    guess_text_ = reinterpret_cast<const char *>(data + offset);
+    guess_packed_ = data + offset + guess_bytes;
+    solution_packed_ = guess_packed_ + guess_bytes;
+  }
 
   // Check if root_index_ is in range
   if (root_index_ >= num_nodes_) {
     std::cerr << "Root index out of bounds" << std::endl;
-    cleanup_mmap_resources();
     return false;
   }
 
@@ -90,8 +336,8 @@ int Solver::get_root_index() const { return root_index_; }
 
 const SolverNode &Solver::get_node(int index) const { return nodes_[index]; }
 
-int Solver::get_next_node(int node_index, uint8_t pattern) const {
-  return children_[node_index * 243 + pattern];
+int Solver::get_next_node(int node_index, uint16_t pattern) const {
+  return children_[static_cast<size_t>(node_index) * num_patterns_ + pattern];
 }
 
 } // namespace wordle
@@ -111,3 +357,40 @@ void wordle::Solver::cleanup_mmap_resources() {
 wordle::Solver::~Solver() {
   cleanup_mmap_resources();
 }
+
+bool wordle::WordTables::from_artifact(const Solver &solver) {
+  if (!solver.has_words())
+    return false;
+  word_length_ = solver.word_length();
+  num_guesses_ = solver.num_guesses();
+  num_solutions_ = solver.num_solutions();
+  guess_text_ = solver.guess_text();
+  guess_packed_ = solver.guess_packed();
+  solution_packed_ = solver.solution_packed();
+  return true;
+}
+
+void wordle::WordTables::from_list(const WordList &words) {
+  word_length_ = static_cast<int>(words.word_length());
+  num_guesses_ = words.get_guesses().size();
+  num_solutions_ = words.get_solutions().size();
+  owned_text_.clear();
+  owned_text_.reserve(num_guesses_ * word_length_);
+  for (std::string_view w : words.get_guesses())
+    owned_text_.insert(owned_text_.end(), w.begin(), w.end());
+  guess_text_ = owned_text_.data();
+  guess_packed_ = words.packed_guesses().data();
+  solution_packed_ = words.packed_solutions().data();
+}
+
+int wordle::WordTables::find_guess(std::string_view word) const {
+  size_t lo = 0, hi = num_guesses_;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (guess(mid) < word)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo < num_guesses_ && guess(lo) == word ? static_cast<int>(lo) : -1;
+}
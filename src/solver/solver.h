@@ -1,8 +1,12 @@
 #pragma once
+#include "libwordle_core/artifact.h"
+#include "libwordle_core/pattern.h"
+#include "libwordle_core/wordlist.h"
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace wordle {
@@ -12,18 +16,77 @@ struct SolverNode {
   uint16_t flags;
 };
 
+// How Solver::load() brings the artifact into memory. Lazy mapping is the
+// cheapest load but pays a page fault the first time each page is touched,
+// i.e. during the first games; the other modes move that cost into load().
+enum class LoadMode {
+  Lazy,     // mmap only; pages fault in on first use
+  Populate, // mmap(MAP_POPULATE): every page mapped before load() returns
+  WillNeed, // mmap + madvise(SEQUENTIAL, WILLNEED): readahead in the
+            // background, pages still map on first touch
+  HugePage, // Copied into 2 MB-aligned anonymous memory with MADV_HUGEPAGE
+  Lock,     // mmap + mlock: resident and never paged out
+};
+
+// "lazy", "populate", "willneed", "hugepage", "mlock".
+const char *load_mode_name(LoadMode mode);
+bool parse_load_mode(std::string_view name, LoadMode &mode);
+
 class Solver {
 public:
   Solver() = default;
-  bool load(const std::string &path);
+  // `tree` selects a tree of a bundle by name ("salet/entropy") or opener
+  // ("salet"); empty means the first. Plain artifacts take no tree.
+  bool load(const std::string &path, LoadMode mode = LoadMode::Lazy,
+            const std::string &tree = "");
+
+  // Uses an artifact image already in memory, such as kStaticArtifact
+  // compiled into .rodata. Nothing is copied; `data` must outlive the solver
+  // and be 4-byte aligned.
+  bool load_image(const uint8_t *data, size_t size,
+                  const std::string &tree = "");
+
+  // Bundles only: every tree in TOC order, and the one loaded.
+  const std::vector<std::string> &tree_names() const { return tree_names_; }
+  const std::string &tree_name() const { return tree_name_; }
 
   int get_root_index() const;
   const SolverNode &get_node(int index) const;
-  int get_next_node(int node_index, uint8_t pattern) const;
+  int get_next_node(int node_index, uint16_t pattern) const;
+
+  // Same lookup with the child stride fixed at compile time; only valid when
+  // word_length() == L.
+  template <int L>
+  int next_node(int node_index, typename WordTraits<L>::Pattern pattern) const {
+    return children_[static_cast<size_t>(node_index) *
+                         WordTraits<L>::kNumPatterns +
+                     pattern];
+  }
 
   uint64_t get_checksum() const { return checksum_; }
+  int word_length() const { return word_length_; }
+  int num_patterns() const { return num_patterns_; }
 
-    // Delete copy constructor and copy assignment operator
+  // Word tables embedded by `wordle_builder --embed-words` (version 3).
+  bool has_words() const { return guess_text_ != nullptr; }
+  size_t num_guesses() const { return header_v3_.num_guesses; }
+  size_t num_solutions() const { return header_v3_.num_solutions; }
+  const char *guess_text() const { return guess_text_; }
+  const uint8_t *guess_packed() const { return guess_packed_; }
+  const uint8_t *solution_packed() const { return solution_packed_; }
+
+  // Solutions still possible at a node, stored with `wordle_builder
+  // --embed-ranges`: indices into the solution list, listed or counted
+  // without filtering.
+  bool has_ranges() const { return ranges_ != nullptr; }
+  size_t candidate_count(int node) const {
+    return ranges_[node].end - ranges_[node].begin;
+  }
+  const uint32_t *candidates(int node) const {
+    return order_ + ranges_[node].begin;
+  }
+
+  // Delete copy constructor and copy assignment operator
   Solver(const Solver &) = delete;
   Solver &operator=(const Solver &) = delete;
 
@@ -31,15 +94,69 @@ public:
 
 private:
   const uint8_t *mapped_data_ = nullptr;
-  size_t mapped_size_ = 0;
+  size_t mapped_size_ = 0; // Bytes to unmap (rounded up for HugePage)
   int fd_ = -1;
 
+  bool copy_to_huge_pages(const std::string &path, size_t size);
+
   void cleanup_mmap_resources();
+  bool parse(const uint8_t *data, size_t size, const std::string &tree);
+  bool parse_bundle(const uint8_t *data, size_t size, const std::string &tree);
+  bool parse_sections(const uint8_t *data, size_t size, size_t nodes_offset);
+
   const SolverNode *nodes_ = nullptr;
   const uint32_t *children_ = nullptr;
   int num_nodes_ = 0;
   int root_index_ = 0;
+  int word_length_ = 5;
+  int num_patterns_ = 243;
   uint64_t checksum_ = 0;
+
+  ArtifactHeader header_v3_{};
+  const char *guess_text_ = nullptr;
+  const uint8_t *guess_packed_ = nullptr;
+  const uint8_t *solution_packed_ = nullptr;
+  const ArtifactRange *ranges_ = nullptr;
+  const uint32_t *order_ = nullptr;
+
+  std::vector<std::string> tree_names_;
+  std::string tree_name_;
+};
+
+// The guess and solution tables the solver plays with: mapped straight from
+// an artifact with embedded words, or flattened from text lists. Either way a
+// word is found by pointer arithmetic.
+class WordTables {
+public:
+  bool from_artifact(const Solver &solver);
+  void from_list(const WordList &words);
+
+  int word_length() const { return word_length_; }
+  size_t num_guesses() const { return num_guesses_; }
+  size_t num_solutions() const { return num_solutions_; }
+
+  std::string_view guess(size_t i) const {
+    return {guess_text_ + i * word_length_, static_cast<size_t>(word_length_)};
+  }
+
+  // Index of `word` in the sorted guess list, or -1.
+  int find_guess(std::string_view word) const;
+
+  template <int L> const BasicPackedWord<L> *packed_guesses() const {
+    return reinterpret_cast<const BasicPackedWord<L> *>(guess_packed_);
+  }
+  template <int L> const BasicPackedWord<L> *packed_solutions() const {
+    return reinterpret_cast<const BasicPackedWord<L> *>(solution_packed_);
+  }
+
+private:
+  int word_length_ = 5;
+  size_t num_guesses_ = 0;
+  size_t num_solutions_ = 0;
+  const char *guess_text_ = nullptr;
+  const uint8_t *guess_packed_ = nullptr;
+  const uint8_t *solution_packed_ = nullptr;
+  std::vector<char> owned_text_; // Text lists only
 };
 
 } // namespace wordle
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+
+namespace wordle {
+
+// Artifact image compiled into the binary, defined by the source that
+// `wordle_builder --emit-cpp` generates. Only wordle_solver_static links one.
+// It lives in .rodata, so loading is free and every process running the
+// executable shares the same pages.
+extern const unsigned char *const kStaticArtifact;
+extern const std::size_t kStaticArtifactSize;
+
+} // namespace wordle
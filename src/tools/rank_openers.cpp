@@ -1,30 +1,314 @@
 #include "builder/entropy.h"
 #include "builder/state.h"
+#include "builder/threadpool.h"
 #include "libwordle_core/patterntable.h"
 #include "libwordle_core/wordlist.h"
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <thread>
 #include <vector>
 
 struct ScoredWord {
-  std::string word;
+  std::string_view word;
   double score;
 };
 
+enum class PairMetric { ENTROPY, EXPECTED };
+
+struct ScoredPair {
+  int first;
+  int second;
+  double score; // joint entropy (higher better) or expected remaining (lower)
+};
+
+namespace {
+
+unsigned int num_workers() {
+  unsigned int n = std::thread::hardware_concurrency();
+  return n == 0 ? 4 : n;
+}
+
+// Scores every guess against the full solution set, split across the thread
+// pool in guess-block aligned chunks.
+std::vector<wordle::GuessStats>
+score_all_guesses(const std::vector<int> &active, size_t num_guesses,
+                  const wordle::PatternTable &table) {
+  std::vector<int> guess_indices(num_guesses);
+  for (size_t i = 0; i < num_guesses; ++i)
+    guess_indices[i] = static_cast<int>(i);
+
+  std::vector<wordle::GuessStats> stats(num_guesses);
+  // Rounded up to a guess-block multiple (never below one block), as in the
+  // builder; the last threads may get no work.
+  unsigned int num_threads = num_workers();
+  size_t chunk_size = (num_guesses + num_threads - 1) / num_threads;
+  chunk_size = (chunk_size + wordle::kGuessBlock - 1) / wordle::kGuessBlock *
+               wordle::kGuessBlock;
+
+  std::vector<std::future<void>> futures;
+  for (size_t start = 0; start < num_guesses; start += chunk_size) {
+    size_t end = std::min(num_guesses, start + chunk_size);
+    futures.push_back(wordle::get_thread_pool().enqueue([&, start, end]() {
+      wordle::score_guesses(active, guess_indices.data() + start, end - start,
+                            table, stats.data() + start);
+    }));
+  }
+  for (auto &f : futures)
+    f.get();
+  return stats;
+}
+
+// Best-first order for pairs; ties broken by indices for stable output.
+struct PairOrder {
+  PairMetric metric;
+  bool operator()(const ScoredPair &a, const ScoredPair &b) const {
+    if (a.score != b.score)
+      return metric == PairMetric::ENTROPY ? a.score > b.score
+                                           : a.score < b.score;
+    if (a.first != b.first)
+      return a.first < b.first;
+    return a.second < b.second;
+  }
+};
+
+// Ranks (first, second) opener pairs by the partition the two guesses induce
+// together. Exhaustive over all pairs in principle, but two bounds keep the
+// search far from 12972^2 full evaluations:
+//
+// 1. Guesses are visited in descending single-guess entropy. Joint entropy
+//    satisfies H(A,B) <= H(A) + H(B), and expected remaining candidates
+//    N * Sum(p^2) >= N * 2^-H(A,B), so once H(a) + H(b) cannot beat the
+//    current K-th best pair, no later partner of `a` (nor any later `a`)
+//    can either.
+// 2. For a fixed first guess the solutions are grouped into its buckets,
+//    largest first. H(A,B) = H(A) + Sum_k p_k * H(B | bucket k), and an
+//    unscored bucket contributes at most p_k * log2(n_k) (at least n_k to
+//    the expected-remaining sum), so a partner is abandoned as soon as the
+//    buckets scored so far prove it cannot make the top K.
+//
+// Outer guesses are striped across the thread pool, each worker keeping its
+// own top K; a worker's K-th best never exceeds the global one, so pruning
+// against it is safe.
+std::vector<ScoredPair>
+rank_pairs(const std::vector<int> &active,
+           const std::vector<wordle::GuessStats> &single,
+           const wordle::PatternTable &table, PairMetric metric, size_t top_k) {
+  const size_t num_guesses = single.size();
+  const double total = static_cast<double>(active.size());
+  const double log_total = std::log2(total);
+  const PairOrder order{metric};
+
+  std::vector<double> log_n(active.size() + 1, 0.0);
+  for (size_t i = 1; i < log_n.size(); ++i)
+    log_n[i] = std::log2(static_cast<double>(i));
+
+  std::vector<int> by_entropy(num_guesses);
+  for (size_t i = 0; i < num_guesses; ++i)
+    by_entropy[i] = static_cast<int>(i);
+  std::sort(by_entropy.begin(), by_entropy.end(), [&](int a, int b) {
+    if (single[a].entropy != single[b].entropy)
+      return single[a].entropy > single[b].entropy;
+    return a < b;
+  });
+
+  // Whether a pair whose entropies sum to `h_sum` could still make the cut.
+  auto may_beat = [&](double h_sum, double threshold) {
+    if (metric == PairMetric::ENTROPY)
+      return std::min(h_sum, log_total) > threshold;
+    return std::max(1.0, total * std::exp2(-h_sum)) < threshold;
+  };
+
+  auto worker = [&](unsigned int stripe, unsigned int num_stripes) {
+    std::vector<ScoredPair> heap; // worst of the local top K on front
+    auto full = [&]() { return heap.size() >= top_k; };
+    auto offer = [&](const ScoredPair &p) {
+      if (!full()) {
+        heap.push_back(p);
+        std::push_heap(heap.begin(), heap.end(), order);
+      } else if (order(p, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), order);
+        heap.back() = p;
+        std::push_heap(heap.begin(), heap.end(), order);
+      }
+    };
+
+    std::vector<uint32_t> counts(243, 0);
+    std::vector<uint32_t> start(243); // Each bucket's next slot in grouped
+    std::vector<int> grouped(active.size());
+    std::vector<std::pair<size_t, size_t>> buckets; // [begin, end)
+
+    for (size_t i = stripe; i + 1 < num_guesses; i += num_stripes) {
+      const int a = by_entropy[i];
+      const double h_a = single[a].entropy;
+      if (full() &&
+          !may_beat(h_a + single[by_entropy[i + 1]].entropy,
+                    heap.front().score))
+        break;
+
+      // Group the solutions by the first guess's pattern, largest bucket
+      // first so the conditional bound tightens as early as possible.
+      const uint8_t *row_a = table.get_raw_table().data() +
+                             static_cast<size_t>(a) * table.num_solutions();
+      for (int s : active)
+        counts[row_a[s]]++;
+      buckets.clear();
+      size_t offset = 0;
+      for (int p = 0; p < 243; ++p) {
+        start[p] = offset;
+        if (counts[p]) {
+          buckets.emplace_back(offset, offset + counts[p]);
+          offset += counts[p];
+        }
+      }
+      for (int s : active)
+        grouped[start[row_a[s]]++] = s;
+      std::fill(counts.begin(), counts.end(), 0);
+      std::sort(buckets.begin(), buckets.end(), [](auto &x, auto &y) {
+        return x.second - x.first > y.second - y.first;
+      });
+
+      // Slack from buckets not scored yet: log2(n_k) each for entropy,
+      // n_k each (all singletons) for expected remaining.
+      double open_slack = 0.0;
+      for (auto &[b, e] : buckets)
+        open_slack += metric == PairMetric::ENTROPY
+                          ? (e - b) * log_n[e - b]
+                          : static_cast<double>(e - b);
+
+      for (size_t j = i + 1; j < num_guesses; ++j) {
+        const int b = by_entropy[j];
+        if (full() && !may_beat(h_a + single[b].entropy, heap.front().score))
+          break;
+
+        const uint8_t *row_b = table.get_raw_table().data() +
+                               static_cast<size_t>(b) * table.num_solutions();
+        // entropy: Sum over buckets of n_k * H(B | k); expected: Sum c^2.
+        double done = 0.0;
+        double slack = open_slack;
+        bool abandoned = false;
+
+        for (auto &[begin, end] : buckets) {
+          const size_t n = end - begin;
+          if (n == 1) // Singletons are fully resolved either way.
+            break;
+
+          for (size_t k = begin; k < end; ++k)
+            counts[row_b[grouped[k]]]++;
+          double sum = 0.0;
+          for (size_t k = begin; k < end; ++k) {
+            uint32_t &c = counts[row_b[grouped[k]]];
+            if (c == 0)
+              continue;
+            sum += metric == PairMetric::ENTROPY
+                       ? c * log_n[c]
+                       : static_cast<double>(c) * c;
+            c = 0;
+          }
+
+          if (metric == PairMetric::ENTROPY) {
+            done += n * log_n[n] - sum;
+            slack -= n * log_n[n];
+          } else {
+            done += sum;
+            slack -= static_cast<double>(n);
+          }
+
+          if (full()) {
+            double bound = metric == PairMetric::ENTROPY
+                               ? h_a + (done + slack) / total
+                               : (done + slack) / total;
+            if (!(metric == PairMetric::ENTROPY ? bound > heap.front().score
+                                                : bound < heap.front().score)) {
+              abandoned = true;
+              break;
+            }
+          }
+        }
+        if (abandoned)
+          continue;
+
+        // Remaining slack belongs to singleton buckets: exact as-is for the
+        // expected sum, zero for conditional entropy.
+        double score = metric == PairMetric::ENTROPY
+                           ? h_a + done / total
+                           : (done + slack) / total;
+        offer({a, b, score});
+      }
+    }
+    return heap;
+  };
+
+  unsigned int num_stripes = num_workers();
+  std::vector<std::future<std::vector<ScoredPair>>> futures;
+  for (unsigned int t = 0; t < num_stripes; ++t)
+    futures.push_back(
+        wordle::get_thread_pool().enqueue(worker, t, num_stripes));
+
+  std::vector<ScoredPair> merged;
+  for (auto &f : futures) {
+    auto res = f.get();
+    merged.insert(merged.end(), res.begin(), res.end());
+  }
+  size_t limit = std::min(merged.size(), top_k);
+  std::partial_sort(merged.begin(), merged.begin() + limit, merged.end(),
+                    order);
+  merged.resize(limit);
+  return merged;
+}
+
+} // namespace
+
 int main(int argc, char **argv) {
-  if (argc < 3) {
+  std::vector<std::string> positional;
+  bool pairs = false;
+  PairMetric metric = PairMetric::ENTROPY;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--pairs") {
+      pairs = true;
+    } else if (arg == "--metric" && i + 1 < argc) {
+      std::string m = argv[++i];
+      if (m == "entropy")
+        metric = PairMetric::ENTROPY;
+      else if (m == "expected")
+        metric = PairMetric::EXPECTED;
+      else {
+        std::cerr << "Unknown metric: " << m << " (use 'entropy' or 'expected')"
+                  << std::endl;
+        return 1;
+      }
+    } else {
+      positional.push_back(arg);
+    }
+  }
+
+  if (positional.size() < 2) {
     std::cerr << "Usage: " << argv[0]
-              << " <solutions.txt> <guesses.txt> [top_n]" << std::endl;
+              << " <solutions.txt> <guesses.txt> [top_n] [--pairs [--metric "
+                 "entropy|expected]]"
+              << std::endl;
     return 1;
   }
 
-  std::string s_path = argv[1];
-  std::string g_path = argv[2];
+  std::string s_path = positional[0];
+  std::string g_path = positional[1];
   int top_n = 100;
-  if (argc > 3)
-    top_n = std::stoi(argv[3]);
+  if (positional.size() > 2) {
+    char *end = nullptr;
+    const long n = std::strtol(positional[2].c_str(), &end, 10);
+    if (*end != '\0' || n < 1 || n > std::numeric_limits<int>::max()) {
+      std::cerr << "Invalid top_n: " << positional[2] << " (use 1 or more)"
+                << std::endl;
+      return 1;
+    }
+    top_n = static_cast<int>(n);
+  }
 
   wordle::WordList words;
   if (!words.load(s_path, g_path))
@@ -32,10 +316,7 @@ int main(int argc, char **argv) {
 
   std::cout << "Generating Pattern Table..." << std::endl;
   wordle::PatternTable table;
-  table.generate(words.get_guesses(), words.get_solutions());
-
-  std::cout << "Ranking " << words.get_guesses().size()
-            << " openers by entropy..." << std::endl;
+  table.generate(words);
 
   // Initial state: All solutions active
   wordle::SolverState all_solutions(words.get_solutions().size());
@@ -43,20 +324,15 @@ int main(int argc, char **argv) {
     all_solutions.set(i);
   }
 
-  std::vector<ScoredWord> results;
-  results.reserve(words.get_guesses().size());
-
-  auto start = std::chrono::high_resolution_clock::now();
-
-  // We can use the existing compute_heuristic function
-  // It's already optimized.
   const auto &guesses = words.get_guesses();
-  for (size_t i = 0; i < guesses.size(); ++i) {
-    auto h = wordle::compute_heuristic(all_solutions, i, table,
-                                       wordle::HeuristicType::ENTROPY);
-    results.push_back({guesses[i], h.score});
-  }
+  std::vector<int> active = all_solutions.get_active_indices();
 
+  std::cout << "Ranking " << guesses.size() << " openers by entropy..."
+            << std::endl;
+  auto start = std::chrono::high_resolution_clock::now();
+  // Decode the candidate set once and score every guess with the batched
+  // kernel, in parallel.
+  auto stats = score_all_guesses(active, guesses.size(), table);
   auto end = std::chrono::high_resolution_clock::now();
   std::cout << "Ranking calculated in "
             << std::chrono::duration_cast<std::chrono::milliseconds>(end -
@@ -64,6 +340,34 @@ int main(int argc, char **argv) {
                    .count()
             << "ms" << std::endl;
 
+  if (pairs) {
+    const char *name = metric == PairMetric::ENTROPY
+                           ? "Joint Entropy"
+                           : "Expected Remaining Candidates";
+    std::cout << "Ranking opener pairs by " << name << "..." << std::endl;
+    start = std::chrono::high_resolution_clock::now();
+    auto ranked = rank_pairs(active, stats, table, metric, top_n);
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "Pairs ranked in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end -
+                                                                       start)
+                     .count()
+              << "ms" << std::endl;
+
+    std::cout << "\nTop " << top_n << " Opener Pairs by " << name << ":\n";
+    std::cout << "--------------------------------\n";
+    for (const auto &p : ranked) {
+      std::cout << std::fixed << std::setprecision(5) << guesses[p.first]
+                << " " << guesses[p.second] << " " << p.score << std::endl;
+    }
+    return 0;
+  }
+
+  std::vector<ScoredWord> results;
+  results.reserve(guesses.size());
+  for (size_t i = 0; i < guesses.size(); ++i)
+    results.push_back({guesses[i], stats[i].entropy});
+
   // Sort descending by entropy (score)
   std::sort(results.begin(), results.end(),
             [](const auto &a, const auto &b) { return a.score > b.score; });
@@ -0,0 +1,134 @@
+// Release builds define NDEBUG; these checks must run regardless.
+#undef NDEBUG
+#include "builder.h"
+#include "libwordle_core/artifact.h"
+#include "verify.h"
+#include "writer.h"
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+using namespace wordle;
+
+namespace {
+
+std::vector<uint8_t> read_file(const char *path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in),
+          std::istreambuf_iterator<char>()};
+}
+
+void write_file(const char *path, const std::vector<uint8_t> &bytes) {
+  std::ofstream(path, std::ios::binary)
+      .write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+}
+
+} // namespace
+
+void test_corrupt_children(const WordList &words,
+                           const std::shared_ptr<MemoryNode> &root) {
+  const char *path = "test_artifact_corrupt.bin";
+  assert(write_solution(path, root, words, HeuristicType::ENTROPY));
+  assert(verify_artifact<5>(path, words, 4).valid);
+
+  // Every child of the upper half of the nodes points far out of bounds.
+  // Solutions played by any thread reach them, so no walk may start before
+  // all indices are checked.
+  auto bytes = read_file(path);
+  ArtifactHeader h;
+  std::memcpy(&h, bytes.data(), sizeof(h));
+  auto *children = reinterpret_cast<uint32_t *>(
+      bytes.data() + sizeof(ArtifactHeader) +
+      h.num_nodes * sizeof(ArtifactNode));
+  for (size_t i = h.num_nodes / 2 * size_t(h.num_patterns);
+       i < h.num_nodes * size_t(h.num_patterns); ++i)
+    if (children[i] != kNoChild)
+      children[i] = 0x7FFFFFF0;
+  write_file(path, bytes);
+
+  for (unsigned int threads : {1u, 2u, 4u})
+    assert(!verify_artifact<5>(path, words, threads).valid);
+  std::remove(path);
+}
+
+void test_ranges_round_trip(const WordList &words,
+                            const std::shared_ptr<MemoryNode> &root) {
+  const char *path = "test_artifact_ranges.bin";
+  assert(write_solution(path, root, words, HeuristicType::ENTROPY, true,
+                        true));
+  auto stats = verify_artifact<5>(path, words, 2);
+  assert(stats.valid);
+  assert(stats.average == evaluate_tree(root, words).average);
+
+  // The root's range is every solution, in leaf order.
+  auto bytes = read_file(path);
+  ArtifactHeader h;
+  std::memcpy(&h, bytes.data(), sizeof(h));
+  assert((h.flags & kArtifactHasRanges) && (h.flags & kArtifactHasWords));
+  const size_t S = words.get_solutions().size();
+  assert(h.num_solutions == S);
+  auto *ranges = reinterpret_cast<ArtifactRange *>(
+      bytes.data() + sizeof(ArtifactHeader) +
+      h.num_nodes *
+          (sizeof(ArtifactNode) + h.num_patterns * sizeof(uint32_t)));
+  auto *order = reinterpret_cast<uint32_t *>(ranges + h.num_nodes);
+  assert(ranges[h.root_index].begin == 0 && ranges[h.root_index].end == S);
+
+  // Swapping the first and last solution puts both outside their leaves'
+  // ranges.
+  std::swap(order[0], order[S - 1]);
+  write_file(path, bytes);
+  assert(!verify_artifact<5>(path, words, 2).valid);
+  std::remove(path);
+}
+
+void test_bundle_round_trip(const WordList &words, const PatternTable &table,
+                            const std::shared_ptr<MemoryNode> &root) {
+  const char *path = "test_artifact_bundle.bin";
+  auto other = Builder(words, table, "salet", HeuristicType::MINIMAX).build();
+  assert(other);
+  std::vector<BundleEntry> trees{{"trace", "entropy", root},
+                                 {"salet", "minimax", other}};
+  assert(write_bundle(path, trees, words, true));
+  assert(is_bundle(path));
+
+  auto stats = verify_bundle<5>(path, words, 2);
+  assert(stats.valid && stats.trees.size() == 2);
+  assert(stats.names[0] == "trace/entropy" &&
+         stats.names[1] == "salet/minimax");
+  for (size_t t = 0; t < trees.size(); ++t) {
+    assert(stats.trees[t].valid);
+    assert(stats.trees[t].average ==
+           evaluate_tree(trees[t].root, words).average);
+  }
+
+  // A root outside the shared pool fails that tree and the bundle.
+  auto bytes = read_file(path);
+  BundleHeader h;
+  std::memcpy(&h, bytes.data(), sizeof(h));
+  auto *toc = reinterpret_cast<BundleTree *>(bytes.data() + sizeof(h));
+  toc[1].root_index = h.num_nodes;
+  write_file(path, bytes);
+  stats = verify_bundle<5>(path, words, 2);
+  assert(!stats.valid && stats.trees[0].valid && !stats.trees[1].valid);
+  std::remove(path);
+}
+
+int main() {
+  WordList words;
+  assert(words.load(WORDLE_DATA_DIR "/solutions.txt",
+                    WORDLE_DATA_DIR "/guesses.txt"));
+  PatternTable table;
+  table.generate(words);
+  auto root = Builder(words, table, "trace").build();
+  assert(root);
+
+  test_corrupt_children(words, root);
+  test_ranges_round_trip(words, root);
+  test_bundle_round_trip(words, table, root);
+  std::cout << "All artifact tests passed." << std::endl;
+  return 0;
+}
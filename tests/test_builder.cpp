@@ -0,0 +1,64 @@
+// Release builds define NDEBUG; these checks must run regardless.
+#undef NDEBUG
+#include "builder.h"
+#include "verify.h"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+using namespace wordle;
+
+namespace {
+
+bool same_tree(const MemoryNode &a, const MemoryNode &b) {
+  if (a.guess_index != b.guess_index || a.is_leaf != b.is_leaf ||
+      a.children.size() != b.children.size())
+    return false;
+  for (size_t i = 0; i < a.children.size(); ++i)
+    if (a.children[i].first != b.children[i].first ||
+        !same_tree(*a.children[i].second, *b.children[i].second))
+      return false;
+  return true;
+}
+
+} // namespace
+
+// solve_small() must pick exactly what the general path picks. Every
+// `stride`-th solution keeps the lists small enough that most states below
+// the root go through it.
+void test_small_states_match(size_t stride) {
+  const char *path = "test_builder_solutions.txt";
+  {
+    std::ifstream in(WORDLE_DATA_DIR "/solutions.txt");
+    std::ofstream out(path);
+    std::string word;
+    for (size_t i = 0; in >> word; ++i)
+      if (i % stride == 0)
+        out << word << "\n";
+  }
+  WordList words;
+  assert(words.load(path, WORDLE_DATA_DIR "/guesses.txt"));
+  PatternTable table;
+  table.generate(words);
+
+  for (HeuristicType h : {HeuristicType::ENTROPY, HeuristicType::MIN_EXPECTED,
+                          HeuristicType::MINIMAX}) {
+    Builder small(words, table, "", h);
+    Builder general(words, table, "", h);
+    general.set_small_states(false);
+    auto a = small.build();
+    auto b = general.build();
+    assert(a && b);
+    assert(evaluate_tree(a, words).valid);
+    assert(same_tree(*a, *b));
+  }
+  std::remove(path);
+}
+
+int main() {
+  test_small_states_match(20);
+  test_small_states_match(7);
+  std::cout << "All builder tests passed." << std::endl;
+  return 0;
+}
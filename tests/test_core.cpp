@@ -1,5 +1,12 @@
+#include "libwordle_core/letterindex.h"
 #include "libwordle_core/pattern.h"
+#include "libwordle_core/perfcounters.h"
+#include "libwordle_core/wordlist.h"
 #include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
 #include <iostream>
 
 using namespace wordle;
@@ -16,7 +23,7 @@ void test_pattern() {
   // Green: ..GG.
   // Yellow: YY... (First B matches second B in ABBEY, A matches A)
   // Result: 11220 (base 3) -> 1 + 3 + 18 + 54 = 76
-  int p = calc_pattern("babes", "abbey");
+  [[maybe_unused]] int p = calc_pattern("babes", "abbey");
   // std::cout << "babes vs abbey: " << p << std::endl;
   assert(p == 76);
 
@@ -27,8 +34,102 @@ void test_pattern() {
   assert(calc_pattern("night", "sight") == 240);
 }
 
+void test_word_lengths() {
+  static_assert(WordTraits<5>::kNumPatterns == 243);
+  static_assert(WordTraits<5>::kSolvedPattern == 242);
+  static_assert(std::is_same_v<WordTraits<5>::Pattern, uint8_t>);
+  static_assert(std::is_same_v<WordTraits<6>::Pattern, uint16_t>);
+
+  // Packed and string paths agree at every supported length.
+  assert(calc_pattern<5>(pack_word<5>("babes"), pack_word<5>("abbey")) == 76);
+  assert(calc_pattern("tree", "tree") == WordTraits<4>::kSolvedPattern);
+  // Secret: EAST, Guess: SEAT -> YYYG -> 1 + 3 + 9 + 54 = 67
+  assert(calc_pattern("seat", "east") == 67);
+  assert(calc_pattern<4>(pack_word<4>("seat"), pack_word<4>("east")) == 67);
+  assert(calc_pattern<8>(pack_word<8>("absolute"), pack_word<8>("absolute")) ==
+         WordTraits<8>::kSolvedPattern);
+  assert(calc_pattern<6>(pack_word<6>("banana"), pack_word<6>("bandit")) ==
+         calc_pattern("banana", "bandit"));
+}
+
+void test_letter_index() {
+  // Duplicate letters are where count bounds matter.
+  const char *list[] = {"abbey", "babes", "eerie", "geese", "sheep", "speed",
+                        "crane", "trace", "react", "llama", "hello", "level",
+                        "essay", "asses", "sassy", "mamma"};
+  const size_t n = sizeof(list) / sizeof(list[0]);
+  std::vector<PackedWord> words;
+  for (const char *w : list)
+    words.push_back(pack_word<5>(w));
+  LetterIndex index;
+  index.build(words.data(), n);
+  assert(index.num_words() == 1);
+
+  // For every feedback a game can produce, the filter keeps exactly the
+  // solutions that would produce it.
+  for (size_t g = 0; g < n; ++g) {
+    for (size_t s = 0; s < n; ++s) {
+      uint8_t p = calc_pattern<5>(words[g], words[s]);
+      uint64_t bits = (1ULL << n) - 1;
+      index.filter(words[g], p, &bits);
+      for (size_t t = 0; t < n; ++t)
+        assert(((bits >> t) & 1) == (calc_pattern<5>(words[g], words[t]) == p));
+    }
+  }
+}
+
+void test_wordlist() {
+  const char *sorted_path = "test_words_sorted.txt";
+  const char *messy_path = "test_words_messy.txt";
+  std::ofstream(sorted_path) << "abbey\ncrane\ntrace\n";
+  // Unsorted, duplicated, CRLF and invalid lines.
+  std::ofstream(messy_path) << "trace\r\nCRANE\nabbey\n\ncrane\nab\ntrace";
+
+  WordList a, b;
+  assert(a.load(sorted_path, sorted_path));
+  assert(b.load(messy_path, messy_path));
+  assert(b.get_guesses().size() == 3);
+  assert(b.get_guesses()[1] == "crane");
+  assert(a.get_checksum() == b.get_checksum());
+
+  // Packed letters follow the sorted order.
+  [[maybe_unused]] const auto &packed = b.packed_guesses();
+  assert(packed.size() == 15);
+  assert(packed[5] == 'c' - 'a' && packed[9] == 'e' - 'a');
+  assert(b.guesses_as<5>()[2].chars[0] == 't' - 'a');
+
+  std::remove(sorted_path);
+  std::remove(messy_path);
+}
+
+void test_perf_phases() {
+  // Works with or without counters; unavailable events are reported null.
+  PerfCounters counters;
+  PerfPhases phases(counters);
+  [[maybe_unused]] const int a = phases.phase("a");
+  assert(phases.phase("b") == a + 1 && phases.phase("a") == a);
+  assert(phases.enter(a) == -1);
+  {
+    PerfScope scope(&phases, phases.phase("b"));
+  }
+  assert(phases.enter(-1) == a);
+
+  const char *path = "test_perf.json";
+  assert(phases.write_json(path));
+  std::stringstream json;
+  json << std::ifstream(path).rdbuf();
+  assert(json.str().find("{\"name\": \"b\"") != std::string::npos);
+  if (!counters.available(PerfEvent::Cycles))
+    assert(json.str().find("\"cycles\": null") != std::string::npos);
+  std::remove(path);
+}
+
 int main() {
   test_pattern();
+  test_word_lengths();
+  test_letter_index();
+  test_wordlist();
+  test_perf_phases();
   std::cout << "All core tests passed." << std::endl;
   return 0;
 }
@@ -0,0 +1,167 @@
+// Release builds define NDEBUG; these checks must run regardless.
+#undef NDEBUG
+#include "builder.h"
+#include "distributed.h"
+#include "memo_store.h"
+#include <arpa/inet.h>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace wordle;
+
+namespace {
+
+// The worker side of the wire format in distributed.cpp, version 2.
+struct MessageHeader {
+  uint32_t magic = 0x54534457; // "WDST"
+  uint32_t type;
+  uint32_t size;
+  uint32_t reserved = 0;
+};
+enum : uint32_t { kHello = 1, kWelcome, kTask, kResult, kDone };
+struct Hello {
+  uint32_t version = 2;
+  uint32_t word_length;
+  uint64_t list_checksum;
+  uint32_t num_solutions;
+  uint32_t num_guesses;
+  uint64_t cost_table;
+};
+struct TaskHeader {
+  uint32_t task;
+  uint32_t depth;
+  uint32_t count;
+  uint32_t reserved;
+};
+struct ResultHeader {
+  uint32_t task;
+  uint32_t num_nodes;
+};
+
+void send_message(int fd, uint32_t type, const void *payload, size_t size) {
+  MessageHeader h;
+  h.type = type;
+  h.size = static_cast<uint32_t>(size);
+  std::vector<uint8_t> out(sizeof(h) + size);
+  std::memcpy(out.data(), &h, sizeof(h));
+  std::memcpy(out.data() + sizeof(h), payload, size);
+  assert(send(fd, out.data(), out.size(), MSG_NOSIGNAL) ==
+         static_cast<ssize_t>(out.size()));
+}
+
+std::vector<uint8_t> recv_message(int fd, uint32_t type) {
+  MessageHeader h;
+  assert(recv(fd, &h, sizeof(h), MSG_WAITALL) == sizeof(h));
+  assert(h.type == type);
+  std::vector<uint8_t> payload(h.size);
+  if (h.size)
+    assert(recv(fd, payload.data(), h.size, MSG_WAITALL) ==
+           static_cast<ssize_t>(h.size));
+  return payload;
+}
+
+int free_port() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  assert(bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+  assert(getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) == 0);
+  close(fd);
+  return ntohs(addr.sin_port);
+}
+
+int connect_retrying(int port) {
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  for (int attempt = 0; attempt < 100; ++attempt) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0)
+      return fd;
+    close(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  return -1;
+}
+
+} // namespace
+
+// A worker that answers its bucket with a tree that does not solve it gets
+// nothing into the memo; build() then solves that bucket itself.
+void test_rejects_wrong_result() {
+  const char *list = "test_distributed_words.txt";
+  {
+    std::ifstream in(WORDLE_DATA_DIR "/solutions.txt");
+    std::ofstream out(list);
+    std::string word;
+    for (int i = 0; i < 60 && in >> word; ++i)
+      out << word << "\n";
+  }
+  WordList words;
+  assert(words.load(list, list));
+  PatternTable table;
+  table.generate(words);
+
+  Memo memo;
+  const int port = free_port();
+  auto coordinator = std::async(std::launch::async, [&] {
+    return distribute_root<5>(words, table, 0, HeuristicType::ENTROPY, port,
+                              0, {}, memo);
+  });
+
+  const int fd = connect_retrying(port);
+  assert(fd >= 0);
+  Hello hello;
+  hello.word_length = 5;
+  hello.list_checksum = words.get_checksum();
+  hello.num_solutions = static_cast<uint32_t>(words.get_solutions().size());
+  hello.num_guesses = static_cast<uint32_t>(words.get_guesses().size());
+  hello.cost_table = expected_costs_hash();
+  send_message(fd, kHello, &hello, sizeof(hello));
+  recv_message(fd, kWelcome);
+
+  auto task = recv_message(fd, kTask);
+  TaskHeader th;
+  std::memcpy(&th, task.data(), sizeof(th));
+  assert(th.depth == 1 && th.count > 1);
+  SolverState state(words.get_solutions().size());
+  const auto *solutions =
+      reinterpret_cast<const uint32_t *>(task.data() + sizeof(th));
+  for (uint32_t i = 0; i < th.count; ++i)
+    state.set(solutions[i]);
+
+  // One leaf guessing the first word leaves the others unsolved.
+  struct {
+    ResultHeader rh;
+    StoredNode node;
+  } result{};
+  result.rh = {th.task, 1};
+  result.node.guess_index = static_cast<uint16_t>(solutions[0]);
+  result.node.flags = 1;
+  send_message(fd, kResult, &result, sizeof(result));
+  close(fd);
+
+  auto stats = coordinator.get();
+  assert(stats.workers == 1);
+  assert(stats.failed == 1 && stats.solved == 0);
+  assert(!memo.find(MemoKey{state, kMaxGuesses - 1}));
+  std::remove(list);
+}
+
+int main() {
+  test_rejects_wrong_result();
+  std::cout << "All distributed build tests passed." << std::endl;
+  return 0;
+}
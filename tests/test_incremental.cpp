@@ -0,0 +1,96 @@
+// Release builds define NDEBUG; these checks must run regardless.
+#undef NDEBUG
+#include "builder.h"
+#include "incremental.h"
+#include "writer.h"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+
+using namespace wordle;
+
+namespace {
+
+std::vector<uint8_t> read_file(const char *path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in),
+          std::istreambuf_iterator<char>()};
+}
+
+void write_list(const char *path, const std::set<std::string> &list) {
+  std::ofstream out(path);
+  for (const auto &w : list)
+    out << w << "\n";
+}
+
+} // namespace
+
+void test_base_matches_full_build() {
+  const char *guesses = WORDLE_DATA_DIR "/guesses.txt";
+  WordList full;
+  assert(full.load(WORDLE_DATA_DIR "/solutions.txt", guesses));
+
+  // Since the old list, five solutions were added and three removed (two of
+  // them never solutions in the shipped list); the guess list is the same.
+  std::set<std::string> new_list(full.get_solutions().begin(),
+                                 full.get_solutions().end());
+  std::set<std::string> old_list = new_list;
+  for (const char *w : {"crane", "pound", "shard", "vivid", "zesty"})
+    assert(old_list.erase(w) == 1);
+  old_list.insert({"aahed", "zymic"});
+  assert(new_list.erase("kiosk") == 1);
+  write_list("test_incremental_old.txt", old_list);
+  write_list("test_incremental_new.txt", new_list);
+
+  WordList old_words, new_words;
+  assert(old_words.load("test_incremental_old.txt", guesses));
+  assert(new_words.load("test_incremental_new.txt", guesses));
+  PatternTable old_table, new_table;
+  old_table.generate(old_words);
+  new_table.generate(new_words);
+
+  auto old_root = Builder(old_words, old_table, "trace").build();
+  assert(old_root);
+  assert(write_solution("test_incremental_base.bin", old_root, old_words,
+                        HeuristicType::ENTROPY, true));
+
+  auto full_root = Builder(new_words, new_table, "trace").build();
+  assert(full_root);
+  assert(write_solution("test_incremental_full.bin", full_root, new_words,
+                        HeuristicType::ENTROPY, true));
+
+  auto memo = std::make_shared<Memo>();
+  auto stats = seed_from_base("test_incremental_base.bin", new_words,
+                              HeuristicType::ENTROPY, *memo);
+  assert(stats.valid);
+  assert(stats.removed == 3 && stats.added == 5 && stats.seeded > 0);
+  auto seeded_root =
+      Builder(new_words, new_table, "trace", HeuristicType::ENTROPY, memo)
+          .build();
+  assert(seeded_root);
+  assert(write_solution("test_incremental_seeded.bin", seeded_root, new_words,
+                        HeuristicType::ENTROPY, true));
+  assert(read_file("test_incremental_seeded.bin") ==
+         read_file("test_incremental_full.bin"));
+
+  // A base built with another heuristic is refused.
+  Memo other;
+  assert(!seed_from_base("test_incremental_base.bin", new_words,
+                         HeuristicType::MINIMAX, other)
+              .valid);
+
+  for (const char *path :
+       {"test_incremental_old.txt", "test_incremental_new.txt",
+        "test_incremental_base.bin", "test_incremental_full.bin",
+        "test_incremental_seeded.bin"})
+    std::remove(path);
+}
+
+int main() {
+  test_base_matches_full_build();
+  std::cout << "All incremental rebuild tests passed." << std::endl;
+  return 0;
+}
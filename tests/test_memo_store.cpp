@@ -0,0 +1,76 @@
+// Release builds define NDEBUG; these checks must run regardless.
+#undef NDEBUG
+#include "builder.h"
+#include "memo_store.h"
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <unistd.h>
+
+using namespace wordle;
+
+namespace {
+
+MemoKey make_key(size_t solution) {
+  SolverState state(100);
+  state.set(solution);
+  return MemoKey{state, 3};
+}
+
+void store_leaf(Memo &memo, size_t solution, uint16_t guess) {
+  auto node = std::make_shared<MemoryNode>();
+  node->guess_index = guess;
+  node->is_leaf = true;
+  memo.insert(make_key(solution), node);
+}
+
+long file_size(const char *path) {
+  FILE *f = std::fopen(path, "rb");
+  std::fseek(f, 0, SEEK_END);
+  long size = std::ftell(f);
+  std::fclose(f);
+  return size;
+}
+
+} // namespace
+
+void test_torn_tail() {
+  const char *path = "test_memo_store.bin";
+  std::remove(path);
+  {
+    MemoStore store;
+    assert(store.open(path, 42, HeuristicType::ENTROPY));
+    Memo memo;
+    store_leaf(memo, 1, 11);
+    store_leaf(memo, 2, 22);
+    assert(store.append(memo) == 2);
+  }
+
+  // A kill mid-append leaves part of the last record behind.
+  const long full = file_size(path);
+  assert(truncate(path, full - 3) == 0);
+  {
+    MemoStore store;
+    assert(store.open(path, 42, HeuristicType::ENTROPY));
+    assert(store.size() == 1);
+    Memo memo;
+    store_leaf(memo, 3, 33);
+    assert(store.append(memo) >= 1);
+  }
+
+  // The torn bytes are gone, so every record after them parses.
+  MemoStore store;
+  assert(store.open(path, 42, HeuristicType::ENTROPY));
+  auto third = store.find(make_key(3));
+  assert(third && third->guess_index == 33 && third->is_leaf);
+  const bool first = store.find(make_key(1)) != nullptr;
+  const bool second = store.find(make_key(2)) != nullptr;
+  assert(first != second); // The record that survived the cut
+  std::remove(path);
+}
+
+int main() {
+  test_torn_tail();
+  std::cout << "All memo store tests passed." << std::endl;
+  return 0;
+}
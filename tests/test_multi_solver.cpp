@@ -0,0 +1,138 @@
+// Release builds define NDEBUG; these checks must run regardless.
+#undef NDEBUG
+#include "multi_solver.h"
+#include "multiboard.h"
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+using namespace wordle;
+
+namespace {
+
+constexpr int kBoards = 2;
+constexpr int kMaxGuesses = 7;
+
+// Plays one pair of targets through the loaded tree the way the solver
+// does; returns the guesses used or -1.
+int play(const MultiSolver &solver, const WordList &words, size_t a,
+         size_t b) {
+  constexpr uint16_t kSolved = WordTraits<5>::kSolvedPattern;
+  const auto *guesses = words.guesses_as<5>();
+  const auto *solutions = words.solutions_as<5>();
+  const size_t targets[kBoards] = {a, b};
+  auto cursor = solver.root();
+  bool done[kBoards] = {};
+  for (int step = 1; step <= solver.max_guesses(); ++step) {
+    const uint16_t g = solver.guess(cursor);
+    uint16_t feedback[kBoards];
+    bool all_done = true;
+    for (int i = 0; i < kBoards; ++i) {
+      feedback[i] = done[i] ? kSolved
+                            : calc_pattern<5>(guesses[g],
+                                              solutions[targets[i]]);
+      done[i] = feedback[i] == kSolved;
+      all_done &= done[i];
+    }
+    if (all_done)
+      return step;
+    if (!solver.advance(cursor, feedback))
+      return -1;
+  }
+  return -1;
+}
+
+} // namespace
+
+void test_advance_walks_tree() {
+  const char *list = "test_multi_solver_words.txt";
+  const char *path = "test_multi_solver.bin";
+  {
+    std::ifstream in(WORDLE_DATA_DIR "/solutions.txt");
+    std::ofstream out(list);
+    std::string word;
+    for (int i = 0; i < 40 && in >> word; ++i)
+      out << word << "\n";
+  }
+  WordList words;
+  assert(words.load(list, list));
+  BasicPatternTable<5> table;
+  table.generate(words);
+  MultiBuilder<5> builder(words, table, kBoards, kMaxGuesses, "");
+  auto root = builder.build();
+  assert(root);
+  auto expected = evaluate_multi_tree(root, words, kBoards, kMaxGuesses);
+  assert(expected.valid && expected.exhaustive);
+  assert(write_multi_solution(path, root, words, kBoards, kMaxGuesses));
+
+  {
+    MultiSolver solver;
+    assert(solver.load(path));
+    assert(solver.num_boards() == kBoards &&
+           solver.get_checksum() == words.get_checksum());
+
+    // Every ordered pair, boards finishing in either order.
+    const size_t S = words.get_solutions().size();
+    long long total = 0;
+    for (size_t a = 0; a < S; ++a)
+      for (size_t b = 0; b < S; ++b) {
+        int steps = play(solver, words, a, b);
+        assert(steps > 0);
+        total += steps;
+      }
+    assert(static_cast<double>(total) / (S * S) == expected.average);
+
+    // Finishing every board has no edge.
+    constexpr uint16_t kSolved = WordTraits<5>::kSolvedPattern;
+    const uint16_t finished[kBoards] = {kSolved, kSolved};
+    auto cursor = solver.root();
+    assert(!solver.advance(cursor, finished));
+  }
+
+  // A table with no empty slot still ends the probe for a missing key.
+  std::ifstream in(path, std::ios::binary);
+  std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(in),
+                             std::istreambuf_iterator<char>()};
+  in.close();
+  MultiArtifactHeader h;
+  std::memcpy(&h, bytes.data(), sizeof(h));
+  auto *edges = reinterpret_cast<MultiArtifactEdge *>(
+      bytes.data() + sizeof(h) + h.num_nodes * sizeof(ArtifactNode));
+  for (uint32_t i = 0; i < h.edge_capacity; ++i)
+    if (edges[i].parent == kNoChild) {
+      edges[i].parent = h.root_index;
+      edges[i].child = h.root_index;
+      edges[i].feedback = UINT64_MAX; // Never a real tuple
+    }
+  std::ofstream(path, std::ios::binary)
+      .write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+  {
+    MultiSolver solver;
+    assert(solver.load(path));
+    constexpr uint16_t kSolved = WordTraits<5>::kSolvedPattern;
+    const uint16_t finished[kBoards] = {kSolved, kSolved};
+    auto cursor = solver.root();
+    assert(!solver.advance(cursor, finished));
+  }
+
+  // An edge to a node outside the pool is rejected at load.
+  edges[0].parent = h.root_index;
+  edges[0].child = h.num_nodes;
+  std::ofstream(path, std::ios::binary)
+      .write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+  {
+    MultiSolver solver;
+    assert(!solver.load(path));
+  }
+  std::remove(list);
+  std::remove(path);
+}
+
+int main() {
+  test_advance_walks_tree();
+  std::cout << "All multi-board solver tests passed." << std::endl;
+  return 0;
+}